@@ -0,0 +1,213 @@
+/** @file
+ * Implementacja zbioru graczy, którzy mogą wykonać ruch
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "active_gamma.h"
+#include "golden_gamma.h"
+#include "arena_gamma.h"
+
+/** @brief Unieważnia zapamiętaną możliwość złotego ruchu gracza.
+ * @param[in,out] active – zbiór graczy,
+ * @param[in] player     – numer gracza, liczba dodatnia.
+ */
+static inline void Forget(active_players *active, uint32_t player) {
+    if(active->checked[player - 1] == active->epoch) {
+        active->checked[player - 1] = 0;
+        active->valid--;
+    }
+}
+
+void UpdateActive(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                  int areas) {
+    active_players *active = g->active;
+    // bez zapamiętanych wyników nie ma czego unieważniać
+    if(active->valid == 0) {
+        return;
+    }
+
+    uint32_t neighbours[4];
+    int count = Neighbours(g, x, y, neighbours);
+    int own = 0;
+    for(int k = 0; k < count; k++) {
+        own += Owner(g, neighbours[k]) == player;
+    }
+    // nowy obszar, połączenie obszarów lub cykl mogą zmienić możliwe złote
+    // ruchy na polach daleko od (x,y)
+    if(areas != 1 || own != 1) {
+        active->epoch++;
+        active->valid = 0;
+        return;
+    }
+
+    // nowe pole jest liściem obszaru, więc zmieniają się tylko sąsiedzi
+    // tego pola i jego jedynego sąsiada należącego do gracza
+    Forget(active, player);
+    for(int k = 0; k < count; k++) {
+        uint32_t owner = Owner(g, neighbours[k]);
+        if(owner == 0) {
+            continue;
+        }
+        Forget(active, owner);
+        if(owner == player) {
+            uint32_t around[4];
+            int near = Neighbours(g, neighbours[k] % g->width,
+                                  neighbours[k] / g->width, around);
+            for(int z = 0; z < near; z++) {
+                if(Owner(g, around[z]) != 0) {
+                    Forget(active, Owner(g, around[z]));
+                }
+            }
+        }
+    }
+}
+
+bool CachedGoldenTarget(gamma_t *g, uint32_t player) {
+    active_players *active = g->active;
+    if(active == NULL) {
+        return GoldenTargetExists(g, player);
+    }
+
+    uint32_t k = player - 1;
+    if(active->checked[k] == active->epoch) {
+        return active->golden[k];
+    }
+    bool result = GoldenTargetExists(g, player);
+    active->checked[k] = active->epoch;
+    active->valid++;
+    active->golden[k] = result;
+    return result;
+}
+
+void DropActive(gamma_t *g) {
+    active_players *active = g->active;
+    if(active != NULL) {
+        GammaFree(g->arena, active->next);
+        GammaFree(g->arena, active->previous);
+        GammaFree(g->arena, active->checked);
+        GammaFree(g->arena, active->golden);
+        GammaFree(g->arena, active);
+    }
+    g->active = NULL;
+}
+
+/** @brief Tworzy zbiór graczy gry z listą do zbudowania.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool BuildActive(gamma_t *g) {
+    uint64_t players = g->number_of_players;
+    active_players *active = GammaCalloc(g->arena, 1, sizeof(active_players));
+    if(active == NULL) {
+        return false;
+    }
+    g->active = active;
+    active->next = GammaAlloc(g->arena, sizeof(uint32_t) * (players + 1));
+    active->previous = GammaAlloc(g->arena, sizeof(uint32_t) * (players + 1));
+    active->checked = GammaCalloc(g->arena, players, sizeof(uint64_t));
+    active->golden = GammaAlloc(g->arena, sizeof(bool) * players);
+    if(active->next == NULL || active->previous == NULL
+       || active->checked == NULL || active->golden == NULL) {
+        DropActive(g);
+        return false;
+    }
+    active->epoch = 1;
+    active->rebuild = true;
+    return true;
+}
+
+/** @brief Zapewnia, że gra ma zbiór graczy.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli gra ma zbiór.
+ */
+static bool EnsureActive(gamma_t *g) {
+    return g->active != NULL || BuildActive(g);
+}
+
+/** @brief Umieszcza na liście wszystkich graczy w kolejności numerów.
+ * @param[in,out] active – zbiór graczy,
+ * @param[in] players    – liczba graczy.
+ */
+static void LinkAll(active_players *active, uint32_t players) {
+    for(uint64_t p = 0; p <= players; p++) {
+        active->next[p] = p == players ? 0 : p + 1;
+        active->previous[p] = p == 0 ? players : p - 1;
+    }
+    active->listed = players;
+    active->rebuild = false;
+}
+
+/** @brief Usuwa gracza z listy, zostawiając mu wskaźnik na następnika.
+ * @param[in,out] active – zbiór graczy,
+ * @param[in] player     – numer gracza leżącego na liście.
+ */
+static void Unlink(active_players *active, uint32_t player) {
+    active->next[active->previous[player]] = active->next[player];
+    active->previous[active->next[player]] = active->previous[player];
+    active->listed--;
+}
+
+/** @brief Sprawdza, czy gracz może wykonać zwykły lub złoty ruch.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli gracz może wykonać ruch.
+ */
+static bool CanMove(gamma_t *g, uint32_t player) {
+    return gamma_free_fields(g, player) > 0
+           || (g->players[player - 1].gold_possible
+               && CachedGoldenTarget(g, player));
+}
+
+uint32_t gamma_next_active_player(gamma_t *g, uint32_t player) {
+    if(g == NULL || player > g->number_of_players) {
+        return 0;
+    }
+    if(!EnsureActive(g)) {
+        // bez pamięci na zbiór sprawdzamy kolejnych graczy
+        for(uint64_t k = 1; k <= g->number_of_players; k++) {
+            uint32_t next = (player + k - 1) % g->number_of_players + 1;
+            if(CanMove(g, next)) {
+                return next;
+            }
+        }
+        return 0;
+    }
+
+    active_players *active = g->active;
+    if(active->rebuild) {
+        LinkAll(active, g->number_of_players);
+    }
+    // każdy gracz pozostający na liście jest sprawdzany co najwyżej raz
+    uint32_t examined = 0;
+    while(examined < active->listed) {
+        player = active->next[player];
+        // przejście od usuniętego gracza może prowadzić przez innych
+        // usuniętych graczy, którzy już nie są następnikami swoich
+        // poprzedników
+        if(player == 0 || active->next[active->previous[player]] != player) {
+            continue;
+        }
+        if(gamma_free_fields(g, player) > 0) {
+            return player;
+        }
+        if(!g->players[player - 1].gold_possible) {
+            Unlink(active, player);
+            continue;
+        }
+        if(CachedGoldenTarget(g, player)) {
+            return player;
+        }
+        examined++;
+    }
+    return 0;
+}
+
+bool gamma_game_over(gamma_t *g) {
+    return gamma_next_active_player(g, 0) == 0;
+}
@@ -0,0 +1,106 @@
+/** @file
+ * Interfejs zbioru graczy, którzy mogą wykonać ruch
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef ACTIVEGAMMA_H
+#define ACTIVEGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma_structures.h"
+
+/**
+ * @brief Zbiór graczy, którzy mogą jeszcze wykonać ruch, z zapamiętaną
+ * możliwością złotego ruchu.
+ * Gracze leżą na cyklicznej liście dwukierunkowej z wartownikiem 0.
+ * Gracz, który nie może wykonać zwykłego ruchu i wykonał już złoty ruch,
+ * nie odzyska ruchu przez zwykłe ruchy innych graczy, więc jest usuwany
+ * z listy; usunięty gracz pamięta swojego następnika, aby można było
+ * przejść od niego do kolejnego gracza. Złoty ruch i cofnięcie ruchu
+ * mogą przywrócić graczom ruchy, więc wtedy lista jest budowana od nowa
+ * przy następnym zapytaniu.
+ * Wynik przeglądania planszy przez @ref GoldenTargetExists jest ważny,
+ * dopóki nie zmieni się @p epoch albo nie zostanie unieważniony dla
+ * jednego gracza. Zwykły ruch, który przedłuża obszar o pole z jednym
+ * sąsiadem tego samego gracza, zmienia tylko zbiór kandydatów sąsiadów
+ * nowego pola i tego sąsiada; nowy obszar, połączenie obszarów, domknięcie
+ * cyklu, złoty ruch i cofnięcie ruchu zmieniają @p epoch. Gracz mający mniej
+ * obszarów niż maksymalnie może zająć liść dowolnego obszaru innego gracza,
+ * więc jego wynik zmienia się tylko z pojawieniem się pierwszego obszaru
+ * innego gracza, czyli razem z @p epoch.
+ */
+typedef struct active_players {
+    uint32_t *next;         /**< następnicy graczy na liście, indeks 0 to
+                              *  wartownik */
+    uint32_t *previous;     /**< poprzednicy graczy na liście */
+    uint32_t listed;        /**< liczba graczy na liście */
+    bool rebuild;           /**< czy listę trzeba zbudować od nowa */
+    uint64_t epoch;         /**< numer stanu planszy dla złotych ruchów,
+                              *  liczba dodatnia */
+    uint64_t *checked;      /**< @p epoch, w którym sprawdzono złoty ruch
+                              *  gracza, lub 0, gdy wynik jest nieważny;
+                              *  gracz @p i ma indeks @p i - 1 */
+    bool *golden;           /**< zapamiętana możliwość złotego ruchu */
+    uint32_t valid;         /**< liczba graczy z ważnym wynikiem */
+} active_players;
+
+/** @brief Aktualizuje zbiór po postawieniu pionka gracza @p player na
+ * wolnym polu (@p x,@p y).
+ * @param[in,out] g      – wskiaźnik na strukturę przechowującą stan gry
+ *                         ze zbiorem, z już postawionym pionkiem,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny pola,
+ * @param[in] y          – numer wiersza pola,
+ * @param[in] areas      – liczba różnych obszarów gracza sąsiadujących
+ *                         z polem przed ruchem.
+ */
+void UpdateActive(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                  int areas);
+
+/** @brief Aktualizuje zbiór po postawieniu pionka, jeśli gra ma zbiór.
+ * @param[in,out] g      – wskiaźnik na strukturę przechowującą stan gry,
+ *                         z już postawionym pionkiem,
+ * @param[in] player     – numer gracza,
+ * @param[in] x          – numer kolumny pola,
+ * @param[in] y          – numer wiersza pola,
+ * @param[in] areas      – liczba różnych obszarów gracza sąsiadujących
+ *                         z polem przed ruchem.
+ */
+static inline void ActivePlaced(gamma_t *g, uint32_t player, uint32_t x,
+                                uint32_t y, int areas) {
+    if(g->active != NULL) {
+        UpdateActive(g, player, x, y, areas);
+    }
+}
+
+/** @brief Unieważnia cały zbiór po złotym ruchu lub cofnięciu ruchu,
+ * jeśli gra ma zbiór.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+static inline void ActiveChanged(gamma_t *g) {
+    if(g->active != NULL) {
+        g->active->epoch++;
+        g->active->valid = 0;
+        g->active->rebuild = true;
+    }
+}
+
+/** @brief Sprawdza, czy gracz może wykonać złoty ruch, korzystając
+ * z zapamiętanego wyniku, jeśli gra ma zbiór.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new, który nie
+ *                      wykonał jeszcze złotego ruchu.
+ * @return Wynik @ref GoldenTargetExists.
+ */
+bool CachedGoldenTarget(gamma_t *g, uint32_t player);
+
+/** @brief Usuwa zbiór gry. Zostanie zbudowany od nowa przy następnym
+ * zapytaniu.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+void DropActive(gamma_t *g);
+
+#endif /* ACTIVEGAMMA_H */
@@ -0,0 +1,220 @@
+/** @file
+ * Implementacja aren, z których gry biorą pamięć
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "arena_gamma.h"
+
+/** @brief Rozmiar najmniejszego bloku areny w bajtach, razem z nagłówkiem. */
+#define ARENA_MIN_BLOCK 32
+/** @brief Liczba klas rozmiarów bloków areny. Bloki klasy @p k mają
+ * @ref ARENA_MIN_BLOCK * 2^k bajtów, największe 1 MiB. */
+#define ARENA_CLASSES 16
+/** @brief Klasa bloków większych od największej klasy, które nie są
+ * ponownie używane. */
+#define ARENA_LARGE ARENA_CLASSES
+/** @brief Bloki do tego rozmiaru wycinane są z większych kawałków pamięci. */
+#define ARENA_SMALL 4096
+/** @brief Rozmiar kawałka pamięci, z którego wycinane są małe bloki. */
+#define ARENA_CHUNK 65536
+
+/**
+ * @brief Nagłówek bloku pamięci areny, leżący tuż przed pamięcią gry.
+ * Wyrównany tak jak pamięć zwracana przez malloc.
+ */
+typedef union arena_header {
+    struct {
+        uint32_t size_class;  /**< klasa rozmiaru bloku */
+        size_t capacity;      /**< liczba bajtów pamięci gry w bloku */
+    } block;                  /**< opis bloku */
+    max_align_t alignment;    /**< wyrównanie nagłówka */
+} arena_header;
+
+/**
+ * @brief Wolny blok areny czekający na ponowne użycie.
+ */
+typedef struct arena_block {
+    struct arena_block *next; /**< następny wolny blok tej samej klasy */
+} arena_block;
+
+/**
+ * @brief Kawałek pamięci, z którego wycinane są małe bloki.
+ */
+typedef union arena_chunk {
+    union arena_chunk *next;  /**< następny kawałek areny */
+    max_align_t alignment;    /**< wyrównanie bloków za nagłówkiem */
+} arena_chunk;
+
+/**
+ * @brief Struktura przechowująca stan areny.
+ */
+struct gamma_arena {
+    arena_block *free[ARENA_CLASSES]; /**< wolne bloki kolejnych klas */
+    arena_chunk *chunks;              /**< kawałki pamięci areny */
+    char *next;                       /**< początek niewyciętej części
+                                        *  ostatniego kawałka */
+    size_t left;                      /**< liczba niewyciętych bajtów
+                                        *  ostatniego kawałka */
+};
+
+/** @brief Podaje rozmiar bloku klasy @p size_class.
+ * @param[in] size_class – klasa bloku mniejsza od @ref ARENA_CLASSES.
+ * @return Rozmiar bloku w bajtach, razem z nagłówkiem.
+ */
+static inline size_t ClassSize(uint32_t size_class) {
+    return (size_t)ARENA_MIN_BLOCK << size_class;
+}
+
+/** @brief Wyznacza najmniejszą klasę bloku mieszczącego @p size bajtów
+ * pamięci gry.
+ * @param[in] size    – liczba bajtów pamięci gry.
+ * @return Klasa bloku lub @ref ARENA_LARGE.
+ */
+static uint32_t SizeClass(size_t size) {
+    uint32_t size_class = 0;
+    while(size_class < ARENA_CLASSES
+          && ClassSize(size_class) - sizeof(arena_header) < size) {
+        size_class++;
+    }
+    return size_class;
+}
+
+/** @brief Wycina blok o @p size bajtach z ostatniego kawałka areny,
+ * a gdy się nie mieści, z nowego kawałka.
+ * @param[in,out] arena – wskaźnik na arenę,
+ * @param[in] size      – rozmiar bloku niewiększy od @ref ARENA_SMALL.
+ * @return Wskaźnik na blok lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static void *CutBlock(gamma_arena *arena, size_t size) {
+    if(arena->left < size) {
+        arena_chunk *chunk = malloc(ARENA_CHUNK);
+        if(chunk == NULL) {
+            return NULL;
+        }
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+        arena->next = (char *)(chunk + 1);
+        arena->left = ARENA_CHUNK - sizeof(arena_chunk);
+    }
+    void *block = arena->next;
+    arena->next += size;
+    arena->left -= size;
+    return block;
+}
+
+gamma_arena* gamma_arena_new(void) {
+    return calloc(1, sizeof(gamma_arena));
+}
+
+void gamma_arena_delete(gamma_arena *arena) {
+    if(arena == NULL) {
+        return;
+    }
+    for(uint32_t k = 0; ClassSize(k) <= ARENA_SMALL; k++) {
+        arena->free[k] = NULL;
+    }
+    // duże bloki mają własną pamięć, małe leżą w kawałkach
+    for(uint32_t k = 0; k < ARENA_CLASSES; k++) {
+        while(arena->free[k] != NULL) {
+            arena_block *block = arena->free[k];
+            arena->free[k] = block->next;
+            free(block);
+        }
+    }
+    while(arena->chunks != NULL) {
+        arena_chunk *chunk = arena->chunks;
+        arena->chunks = chunk->next;
+        free(chunk);
+    }
+    free(arena);
+}
+
+void *GammaAlloc(gamma_arena *arena, size_t size) {
+    if(arena == NULL) {
+        return malloc(size);
+    }
+
+    uint32_t size_class = SizeClass(size);
+    arena_header *header;
+    if(size_class == ARENA_LARGE) {
+        if(size > SIZE_MAX - sizeof(arena_header)) {
+            return NULL;
+        }
+        header = malloc(sizeof(arena_header) + size);
+    } else if(arena->free[size_class] != NULL) {
+        header = (arena_header *)arena->free[size_class];
+        arena->free[size_class] = arena->free[size_class]->next;
+    } else if(ClassSize(size_class) <= ARENA_SMALL) {
+        header = CutBlock(arena, ClassSize(size_class));
+    } else {
+        header = malloc(ClassSize(size_class));
+    }
+    if(header == NULL) {
+        return NULL;
+    }
+
+    header->block.size_class = size_class;
+    header->block.capacity = size_class == ARENA_LARGE
+                             ? size
+                             : ClassSize(size_class) - sizeof(arena_header);
+    return header + 1;
+}
+
+void *GammaCalloc(gamma_arena *arena, size_t count, size_t size) {
+    if(arena == NULL) {
+        return calloc(count, size);
+    }
+    if(size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void *pointer = GammaAlloc(arena, count * size);
+    if(pointer != NULL) {
+        memset(pointer, 0, count * size);
+    }
+    return pointer;
+}
+
+void *GammaRealloc(gamma_arena *arena, void *pointer, size_t size) {
+    if(arena == NULL) {
+        return realloc(pointer, size);
+    }
+    if(pointer == NULL) {
+        return GammaAlloc(arena, size);
+    }
+
+    size_t capacity = ((arena_header *)pointer - 1)->block.capacity;
+    if(size <= capacity) {
+        return pointer;
+    }
+    void *new_pointer = GammaAlloc(arena, size);
+    if(new_pointer == NULL) {
+        return NULL;
+    }
+    memcpy(new_pointer, pointer, capacity);
+    GammaFree(arena, pointer);
+    return new_pointer;
+}
+
+void GammaFree(gamma_arena *arena, void *pointer) {
+    if(arena == NULL) {
+        free(pointer);
+        return;
+    }
+    if(pointer == NULL) {
+        return;
+    }
+
+    arena_header *header = (arena_header *)pointer - 1;
+    uint32_t size_class = header->block.size_class;
+    if(size_class == ARENA_LARGE) {
+        free(header);
+        return;
+    }
+    arena_block *block = (arena_block *)header;
+    block->next = arena->free[size_class];
+    arena->free[size_class] = block;
+}
@@ -0,0 +1,45 @@
+/** @file
+ * Interfejs alokacji pamięci gier z aren
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef ARENAGAMMA_H
+#define ARENAGAMMA_H
+
+#include <stddef.h>
+#include "gamma.h"
+
+/** @brief Alokuje @p size bajtów pamięci gry.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry, lub NULL,
+ *                        gdy gra używa funkcji malloc,
+ * @param[in] size      – liczba bajtów.
+ * @return Wskaźnik na pamięć lub NULL, gdy nie udało się jej zaalokować.
+ */
+void *GammaAlloc(gamma_arena *arena, size_t size);
+
+/** @brief Alokuje wyzerowaną pamięć gry na @p count elementów.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry, lub NULL,
+ * @param[in] count     – liczba elementów,
+ * @param[in] size      – rozmiar jednego elementu.
+ * @return Wskaźnik na pamięć lub NULL, gdy nie udało się jej zaalokować.
+ */
+void *GammaCalloc(gamma_arena *arena, size_t count, size_t size);
+
+/** @brief Zmienia rozmiar pamięci gry, zachowując jej zawartość.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry, lub NULL,
+ * @param[in] pointer   – pamięć zaalokowana z tej samej areny lub NULL,
+ * @param[in] size      – nowa liczba bajtów.
+ * @return Wskaźnik na pamięć lub NULL, gdy nie udało się jej zaalokować;
+ * wtedy pamięć @p pointer pozostaje nienaruszona.
+ */
+void *GammaRealloc(gamma_arena *arena, void *pointer, size_t size);
+
+/** @brief Zwraca pamięć gry do areny, z której pochodzi.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry, lub NULL,
+ * @param[in] pointer   – zwalniana pamięć.
+ */
+void GammaFree(gamma_arena *arena, void *pointer);
+
+#endif /* ARENAGAMMA_H */
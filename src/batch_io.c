@@ -0,0 +1,363 @@
+/** @file
+ * Implementacja buforowanego wejścia i wyjścia trybów wsadowych
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "utilities.h"
+#include "batch_io.h"
+
+/** @brief Rodzaje znaków wejścia. */
+enum char_class {
+    CHAR_INVALID = 0, /**< znak, który nie może wystąpić w komendzie */
+    CHAR_WHITE,       /**< biały znak oddzielający słowa */
+    CHAR_VALID,       /**< cyfra lub litera */
+    CHAR_PATH,        /**< znak nazwy pliku, dozwolony tylko w argumencie
+                        *  komend 's' i 'l' */
+    CHAR_NEWLINE      /**< znak końca linii */
+};
+
+/** @brief Rodzaje znaków wejścia, wypełniane przez @ref InitCharClasses. */
+static unsigned char CHAR_CLASS[256];
+
+void InitCharClasses(void) {
+    for(int c = 0; c < 256; c++) {
+        if(c == '\n') {
+            CHAR_CLASS[c] = CHAR_NEWLINE;
+        } else if(isWhiteChar(c)) {
+            CHAR_CLASS[c] = CHAR_WHITE;
+        } else if(isNumber(c) || isAcceptable(c)) {
+            CHAR_CLASS[c] = CHAR_VALID;
+        } else if(isPathChar(c)) {
+            CHAR_CLASS[c] = CHAR_PATH;
+        } else {
+            CHAR_CLASS[c] = CHAR_INVALID;
+        }
+    }
+}
+
+bool Refill(batch_input *input) {
+    if(input->position < input->size) {
+        return true;
+    }
+    input->position = 0;
+    // read zwraca to, co jest już dostępne, więc odpowiedź na komendę
+    // nie czeka na zapełnienie całego bloku wejścia
+    ssize_t size;
+    do {
+        size = read(input->descriptor, input->block, INPUT_BLOCK);
+    } while(size < 0 && errno == EINTR);
+    input->size = size > 0 ? size : 0;
+    return input->size > 0;
+}
+
+/** @brief Wypisuje @p length znaków do deskryptora @p descriptor.
+ * Błędy zapisu są pomijane, tak jak przy funkcji printf.
+ * @param[in] descriptor  – deskryptor pliku,
+ * @param[in] data        – wypisywane znaki,
+ * @param[in] length      – liczba znaków.
+ */
+
+static void WriteAll(int descriptor, const char *data, size_t length) {
+    while(length > 0) {
+        ssize_t size = write(descriptor, data, length);
+        if(size < 0 && errno == EINTR) {
+            continue;
+        }
+        if(size <= 0) {
+            return;
+        }
+        data += size;
+        length -= size;
+    }
+}
+
+/** @brief Wypisuje @p length znaków do deskryptora bufora @p output,
+ * trzymając jego blokadę, jeśli ją ma.
+ * @param[in] output      – wskaźnik na bufor odpowiedzi,
+ * @param[in] data        – wypisywane znaki,
+ * @param[in] length      – liczba znaków.
+ */
+
+static void WriteLocked(const batch_output *output, const char *data,
+                        size_t length) {
+    if(output->lock != NULL) {
+        pthread_mutex_lock(output->lock);
+    }
+    WriteAll(output->descriptor, data, length);
+    if(output->lock != NULL) {
+        pthread_mutex_unlock(output->lock);
+    }
+}
+
+void Flush(batch_output *output) {
+    if(output->size == 0) {
+        return;
+    }
+    WriteLocked(output, output->block, output->size);
+    output->size = 0;
+}
+
+void AppendNumber(batch_output *output, uint64_t x) {
+    char *place = Reserve(output, MAX_ANSWER);
+    int length = FormatNumber(x, place);
+    place[length] = '\n';
+    output->size += length + 1;
+}
+
+bool AppendChunk(const char *chunk, size_t length, void *output) {
+    batch_output *o = output;
+    if(length > OUTPUT_BLOCK) {
+        Flush(o);
+        WriteLocked(o, chunk, length);
+        return true;
+    }
+    memcpy(Reserve(o, length), chunk, length);
+    o->size += length;
+    return true;
+}
+
+void AppendWhole(batch_output *output, const char *head, size_t head_length,
+                 const char *body, size_t body_length) {
+    if(head_length + body_length <= OUTPUT_BLOCK) {
+        char *place = Reserve(output, head_length + body_length);
+        memcpy(place, head, head_length);
+        memcpy(place + head_length, body, body_length);
+        output->size += head_length + body_length;
+        return;
+    }
+
+    Flush(output);
+    if(output->lock != NULL) {
+        pthread_mutex_lock(output->lock);
+    }
+    WriteAll(output->descriptor, head, head_length);
+    WriteAll(output->descriptor, body, body_length);
+    if(output->lock != NULL) {
+        pthread_mutex_unlock(output->lock);
+    }
+}
+
+void ReportError(batch_session *session, int line_number) {
+    if(session->same_file) {
+        Flush(&session->output);
+    }
+    char *place = Reserve(&session->errors, MAX_ANSWER);
+    memcpy(place, "ERROR ", 6);
+    int length = 6 + FormatNumber(line_number, place + 6);
+    place[length] = '\n';
+    session->errors.size += length + 1;
+    // błędy są rzadkie, więc wypisujemy je od razu, a nie dopiero przy
+    // wypisywaniu odpowiedzi
+    Flush(&session->errors);
+}
+
+/** @brief Sprawdza czy dwa deskryptory wskazują ten sam plik.
+ * @param[in] first   – pierwszy deskryptor,
+ * @param[in] second  – drugi deskryptor.
+ * @return Wartość @p true, jeśli to ten sam plik.
+ */
+
+static bool SameFile(int first, int second) {
+    struct stat a;
+    struct stat b;
+    if(fstat(first, &a) != 0 || fstat(second, &b) != 0) {
+        return true;
+    }
+    return a.st_dev == b.st_dev && a.st_ino == b.st_ino;
+}
+
+/** @brief Pomija wejście do końca linii włącznie.
+ * @param[in,out] input   – wskaźnik na bufor wejścia.
+ */
+
+static void SkipLine(batch_input *input) {
+    while(Refill(input)) {
+        const char *begin = input->block + input->position;
+        const char *end = memchr(begin, '\n', input->size - input->position);
+        if(end != NULL) {
+            input->position += end - begin + 1;
+            return;
+        }
+        input->position = input->size;
+    }
+}
+
+/** @brief Dzieli komendę na słowa oddzielone pojedynczymi białymi znakami.
+ * @param[in,out] command – komenda wczytana przez @ref ReadLine, długości
+ *                          @p length.
+ * @param[in] length      – długość komendy.
+ */
+
+static void SplitWords(batch_command *command, int length) {
+    command->count = 0;
+    int begin = 0;
+    for(int k = 0; k <= length; k++) {
+        if(k < length && CHAR_CLASS[(unsigned char)command->text[k]]
+                         != CHAR_WHITE) {
+            continue;
+        }
+        if(command->count == MAX_WORDS) {
+            command->count++;
+            return;
+        }
+        command->text[k] = '\0';
+        command->words[command->count] = command->text + begin;
+        command->lengths[command->count] = k - begin;
+        command->count++;
+        begin = k + 1;
+    }
+}
+
+enum line_kind ReadLine(batch_input *input, batch_command *command,
+                        int max_length) {
+    if(!Refill(input)) {
+        return LINE_END;
+    }
+
+    char first = input->block[input->position];
+    if(first == '\n') {
+        input->position++;
+        return LINE_EMPTY;
+    }
+    if(first == '#') {
+        SkipLine(input);
+        return LINE_EMPTY;
+    }
+
+    int length = 0;
+    int words = 1;
+    bool white = false;
+    while(Refill(input)) {
+        char c = input->block[input->position++];
+        switch(CHAR_CLASS[(unsigned char)c]) {
+            case CHAR_WHITE:
+                if(white) {
+                    break;
+                }
+                white = true;
+                words++;
+                if(length > max_length) {
+                    SkipLine(input);
+                    return LINE_ERROR;
+                }
+                command->text[length++] = c;
+                break;
+            case CHAR_PATH:
+                // znaki nazwy pliku mogą wystąpić tylko w drugim słowie
+                // komend 's' i 'l'
+                if(words != 2 || (command->text[0] != 's'
+                                  && command->text[0] != 'l')
+                   || CHAR_CLASS[(unsigned char)command->text[1]]
+                      != CHAR_WHITE) {
+                    SkipLine(input);
+                    return LINE_ERROR;
+                }
+                // fall through
+            case CHAR_VALID:
+                white = false;
+                if(length > max_length) {
+                    SkipLine(input);
+                    return LINE_ERROR;
+                }
+                command->text[length++] = c;
+                break;
+            case CHAR_NEWLINE:
+                if(length > max_length) {
+                    return LINE_ERROR;
+                }
+                if(length > 1 && white) {
+                    length--;
+                }
+                if(CHAR_CLASS[(unsigned char)command->text[0]]
+                   == CHAR_WHITE) {
+                    return LINE_ERROR;
+                }
+                SplitWords(command, length);
+                return LINE_COMMAND;
+            default:
+                SkipLine(input);
+                return LINE_ERROR;
+        }
+    }
+
+    // wejście skończyło się w środku linii
+    return white ? LINE_ERROR : LINE_END;
+}
+
+bool ParseNumber(const char *word, int length, uint32_t *value) {
+    uint64_t result = 0;
+
+    for(int k = 0; k < length; k++) {
+        if(word[k] < '0' || word[k] > '9') {
+            return false;
+        }
+        result = result * 10 + (word[k] - '0');
+        if(result > UINT32_MAX) {
+            return false;
+        }
+    }
+
+    *value = result;
+    return true;
+}
+
+bool GetNumbers(const batch_command *command, int first, int count,
+                uint32_t *input) {
+    if(command->count != first + count) {
+        return false;
+    }
+    for(int k = 0; k < count; k++) {
+        if(!ParseNumber(command->words[first + k],
+                        command->lengths[first + k], &input[k])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+batch_session *NewSession(uint32_t flush_every) {
+    // bufory są duże, więc nie trzymamy ich na stosie
+    batch_session *session = malloc(sizeof(batch_session));
+    if(session == NULL) {
+        return NULL;
+    }
+    // odpowiedzi wypisane wcześniej przez printf muszą poprzedzać nasze
+    fflush(stdout);
+    session->input.descriptor = STDIN_FILENO;
+    session->input.position = 0;
+    session->input.size = 0;
+    session->output.descriptor = STDOUT_FILENO;
+    session->output.lock = NULL;
+    session->output.size = 0;
+    session->errors.descriptor = STDERR_FILENO;
+    session->errors.lock = NULL;
+    session->errors.size = 0;
+    session->same_file = SameFile(STDOUT_FILENO, STDERR_FILENO);
+    session->flush_every = flush_every;
+    session->since_flush = 0;
+    return session;
+}
+
+void CountLine(batch_session *session) {
+    if(session->flush_every != 0
+       && ++session->since_flush == session->flush_every) {
+        Flush(&session->output);
+        session->since_flush = 0;
+    }
+}
+
+void EndSession(batch_session *session) {
+    Flush(&session->output);
+    free(session);
+}
@@ -0,0 +1,229 @@
+/** @file
+ * Interfejs buforowanego wejścia i wyjścia trybów wsadowych
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef GAMMA_BATCH_IO_H
+#define GAMMA_BATCH_IO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <pthread.h>
+
+/** @brief Rozmiar bloku wczytywanego naraz z wejścia. */
+#define INPUT_BLOCK 65536
+
+/** @brief Rozmiar bufora odpowiedzi, po którego zapełnieniu są one
+ * wypisywane. */
+#define OUTPUT_BLOCK 65536
+
+/** @brief Największa długość jednej odpowiedzi liczbowej lub komunikatu
+ * o błędzie, razem ze znakiem końca linii. */
+#define MAX_ANSWER 32
+
+/** @brief Największa liczba znaków poprawnej komendy, po zastąpieniu
+ * ciągów białych znaków jednym znakiem i bez znaku końca linii. Razem ze
+ * znakiem końca linii i znakiem '\0' komenda mieści się w 50 znakach. */
+#define MAX_COMMAND 46
+
+/** @brief Największa liczba znaków komendy, jaką można wczytać. */
+#define MAX_LINE 62
+
+/** @brief Największa liczba słów komendy, która może być poprawna. */
+#define MAX_WORDS 6
+
+/** @brief Wypełnia tablicę rodzajów znaków wejścia zgodnie z funkcjami
+ * @ref isWhiteChar, @ref isNumber, @ref isAcceptable i @ref isPathChar.
+ */
+
+void InitCharClasses(void);
+
+/**
+ * @brief Struktura przechowująca bufor wejścia trybu wsadowego.
+ */
+typedef struct batch_input {
+    int descriptor;           /**< deskryptor, z którego czytane jest
+                                *  wejście */
+    size_t position;          /**< indeks następnego znaku w buforze */
+    size_t size;              /**< liczba wczytanych znaków w buforze */
+    char block[INPUT_BLOCK];  /**< bufor na blok wejścia */
+} batch_input;
+
+/** @brief Rodzaje linii wejścia. */
+enum line_kind {
+    LINE_END,     /**< wejście się skończyło, linia nie jest liczona */
+    LINE_EMPTY,   /**< pusta linia lub komentarz */
+    LINE_ERROR,   /**< niepoprawna linia */
+    LINE_COMMAND  /**< komenda podzielona na słowa */
+};
+
+/**
+ * @brief Struktura przechowująca komendę podzieloną na słowa.
+ */
+typedef struct batch_command {
+    char text[MAX_LINE + 2];    /**< komenda, słowa zakończone znakiem '\0' */
+    const char *words[MAX_WORDS]; /**< początki słów w @p text */
+    int lengths[MAX_WORDS];     /**< długości słów */
+    int count;                  /**< liczba słów, @ref MAX_WORDS + 1 gdy
+                                  *  jest ich więcej */
+} batch_command;
+
+/** @brief Wczytuje kolejny blok wejścia, gdy bufor się wyczerpał.
+ * @param[in,out] input   – wskaźnik na bufor wejścia.
+ * @return Wartość @p true, jeśli w buforze są nieprzeczytane znaki.
+ */
+
+bool Refill(batch_input *input);
+
+/**
+ * @brief Struktura przechowująca odpowiedzi czekające na wypisanie.
+ */
+typedef struct batch_output {
+    int descriptor;            /**< deskryptor, do którego wypisujemy */
+    pthread_mutex_t *lock;     /**< blokada wypisywania wspólna dla wątków
+                                 *  piszących do tego samego deskryptora,
+                                 *  NULL gdy pisze tylko jeden wątek */
+    size_t size;               /**< liczba znaków w buforze */
+    char block[OUTPUT_BLOCK];  /**< bufor na odpowiedzi */
+} batch_output;
+
+/**
+ * @brief Struktura przechowująca stan sesji trybu wsadowego.
+ */
+typedef struct batch_session {
+    batch_input input;         /**< bufor wejścia */
+    batch_output output;       /**< odpowiedzi dla stdout */
+    batch_output errors;       /**< komunikat o błędzie dla stderr,
+                                 *  wypisywany od razu */
+    bool same_file;            /**< czy stdout i stderr to ten sam plik */
+    uint32_t flush_every;      /**< co ile linii wypisywać odpowiedzi,
+                                 *  0 gdy tylko po zapełnieniu bufora */
+    uint32_t since_flush;      /**< liczba linii od ostatniego wypisania */
+} batch_session;
+
+/** @brief Wypisuje zawartość bufora i go opróżnia.
+ * Całe odpowiedzi z bufora nie przeplatają się z odpowiedziami innych
+ * wątków używających tej samej blokady.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi.
+ */
+
+void Flush(batch_output *output);
+
+/** @brief Zapewnia miejsce na @p length znaków w buforze.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi,
+ * @param[in] length      – liczba znaków, niewiększa od @ref OUTPUT_BLOCK.
+ * @return Wskaźnik na miejsce w buforze.
+ */
+
+static inline char *Reserve(batch_output *output, size_t length) {
+    if(OUTPUT_BLOCK - output->size < length) {
+        Flush(output);
+    }
+    return output->block + output->size;
+}
+
+/** @brief Dopisuje liczbę i znak końca linii do bufora.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi,
+ * @param[in] x           – wypisywana liczba.
+ */
+
+void AppendNumber(batch_output *output, uint64_t x);
+
+/** @brief Dopisuje fragment napisu do bufora, a gdy fragment jest dłuższy
+ * niż bufor, wypisuje go od razu.
+ * @param[in] chunk       – fragment napisu,
+ * @param[in] length      – długość fragmentu,
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi.
+ * @return Wartość @p true.
+ */
+
+bool AppendChunk(const char *chunk, size_t length, void *output);
+
+/** @brief Dopisuje do bufora odpowiedź złożoną z nagłówka i treści tak,
+ * aby przy wypisywaniu nie została rozdzielona odpowiedziami innych wątków.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi,
+ * @param[in] head        – nagłówek odpowiedzi,
+ * @param[in] head_length – długość nagłówka,
+ * @param[in] body        – treść odpowiedzi,
+ * @param[in] body_length – długość treści.
+ */
+
+void AppendWhole(batch_output *output, const char *head, size_t head_length,
+                 const char *body, size_t body_length);
+
+/** @brief Zgłasza błąd w linii @p line_number.
+ * Komunikat jest wypisywany od razu. Gdy stdout i stderr to ten sam plik,
+ * wcześniejsze odpowiedzi są wypisywane przed komunikatem, aby zachować
+ * kolejność linii.
+ * @param[in,out] session – wskaźnik na stan sesji,
+ * @param[in] line_number – numer linii.
+ */
+
+void ReportError(batch_session *session, int line_number);
+
+/** @brief Wczytuje kolejną linię wejścia.
+ * Ciągi białych znaków zastępuje pierwszym z nich i usuwa biały znak przed
+ * końcem linii. Linia jest niepoprawna, gdy zawiera niedozwolony znak,
+ * zaczyna się białym znakiem lub jest dłuższa niż @p max_length znaków.
+ * Znaki nazwy pliku (@ref isPathChar) są dozwolone tylko w drugim słowie
+ * linii, której pierwszym słowem jest 's' lub 'l'.
+ * Ostatnia linia bez znaku końca linii jest pomijana, chyba że jest
+ * komentarzem, zawiera niedozwolony znak, jest za długa lub kończy się
+ * białym znakiem.
+ * @param[in,out] input   – wskaźnik na bufor wejścia,
+ * @param[out] command    – komenda podzielona na słowa,
+ * @param[in] max_length  – największa długość poprawnej komendy, nie
+ *                          większa od @ref MAX_LINE.
+ * @return Rodzaj wczytanej linii.
+ */
+
+enum line_kind ReadLine(batch_input *input, batch_command *command,
+                        int max_length);
+
+/** @brief Zamienia słowo złożone z cyfr na liczbę.
+ * @param[in] word    – słowo,
+ * @param[in] length  – długość słowa,
+ * @param[out] value  – wartość liczby.
+ * @return Wartość @p true, jeśli słowo składa się z samych cyfr i jego
+ * wartość nie przekracza zakresu uint32_t.
+ */
+
+bool ParseNumber(const char *word, int length, uint32_t *value);
+
+/** @brief Zamienia argumenty komendy na liczby.
+ * @param[in] command – komenda podzielona na słowa,
+ * @param[in] first   – indeks słowa będącego pierwszym argumentem,
+ * @param[in] count   – oczekiwana liczba argumentów,
+ * @param[out] input  – tablica na argumenty o rozmiarze co najmniej
+ *                      @p count.
+ * @return Wartość @p true, jeśli komenda ma dokładnie @p count argumentów
+ * i są one poprawnymi liczbami.
+ */
+
+bool GetNumbers(const batch_command *command, int first, int count,
+                uint32_t *input);
+
+/** @brief Tworzy sesję czytającą ze stdin i wypisującą na stdout i stderr.
+ * @param[in] flush_every – co ile linii lub rekordów wypisywać odpowiedzi,
+ *                          0 gdy tylko po zapełnieniu bufora.
+ * @return Wskaźnik na sesję lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+
+batch_session *NewSession(uint32_t flush_every);
+
+/** @brief Zlicza obsłużoną linię lub rekord i co @p flush_every z nich
+ * wypisuje odpowiedzi.
+ * @param[in,out] session – wskaźnik na stan sesji.
+ */
+
+void CountLine(batch_session *session);
+
+/** @brief Wypisuje pozostałe odpowiedzi i zwalnia sesję.
+ * @param[in] session – wskaźnik na stan sesji.
+ */
+
+void EndSession(batch_session *session);
+
+#endif //GAMMA_BATCH_IO_H
@@ -9,245 +9,257 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 #include "gamma.h"
-#include <errno.h>
 #include "utilities.h"
+#include "batch_mode.h"
+#include "batch_io.h"
 
-/** @brief Sprawdza czy @p arg po zamienieniu z stringa na liczbę całkowitą
- * nie przekracza max uint32_t.
- * @param[in] arg   – wskiaźnik na strukturę przechowującą stan gry,
- *                          o rozmiarze większym lub równym 3.
- *                          różny od NULL.
- * @return true - @p arg nie przekracza zakresu uint32_t.
- *         false - @p arg przekracza zakres uint32_t.
- */
-
-bool GoodArgument(char * arg) {
-    char *end;
-
-    uint64_t test = strtol(arg,&end,10);
-    if(errno == ERANGE) {
-        // sprawdza czy parametr nie jest większy od max uint64_t.
-        return false;
-    }
-    if(test > 4294967295) {
-        // sprawdza czy parametr nie jest większy od max uint32_t.
-
-        return false;
-    }
-
-    return true;
+/** @brief Rozmiar rekordu komendy binarnego trybu wsadowego. */
+#define BINARY_COMMAND 16
 
-}
-
-/** @brief Sprawdza czy wejście z stdin jest poprawne dla komendy wykonującej
- * ruch oraz zapisuje kolejne argumenty na kolejne indeksy {0,1,2} @p input.
- * Jeśli argumenty były niepoprawne funkcja zwraca false ale niektóre z
- * argumentów mogą zostać zapisane do @p input.
- * @param[in,out] input   – wskiaźnik na strukturę przechowującą stan gry,
- *                          o rozmiarze większym lub równym 3.
- *                          różny od NULL.
- * @param[in] avoid       - tablica zawierająca znaki które maja być pomijane
- *                          przez strtok.
- * @return true - podane parametry były poprawne.
- *         false - podane parametry były niepoprawne.
- */
+/** @brief Rozmiar rekordu odpowiedzi binarnego trybu wsadowego. */
+#define BINARY_RESULT 16
 
-bool GetInputForMove(uint32_t **input,char *avoid) {
-    char *buffor = NULL;
-    int iter = 0;
-    char *end;
+/** @brief Liczba wątków bota komendy "a"; przy jednym wątku ruch zależy
+ * tylko od stanu gry, liczby rozgrywek i ziarna, a nie od komputera. */
+#define BOT_THREADS 1
 
-    buffor = strtok(NULL, avoid);
+/** @brief Ziarno generatora liczb pseudolosowych bota komendy "a". */
+#define BOT_SEED 1
 
-    while (buffor != NULL) {
-        if (iter > 2) {
-            return false;
-        }
+/** @brief Limit pozycji odwiedzanych przy rozwiązywaniu gry komendą "e". */
+#define SOLVE_NODES 20000000
 
-        for (unsigned long i = 0; i < strlen(buffor); i++) {
-            if ((int) buffor[i] < (int) '0' || (int) buffor[i] > (int) '9') {
-                return false;
-            }
-        }
+/** @brief Liczba wątków rozwiązujących grę komendą "e"; przy jednym wątku
+ * to, czy gra zostanie rozwiązana w limicie pozycji, nie zależy od
+ * komputera. */
+#define SOLVE_THREADS 1
 
-        if (GoodArgument(buffor)) {
-            (*input)[iter] = (uint32_t) strtol(buffor, &end, 10);
-        } else {
-            return false;
+gamma_t *BatchMode(gamma_t *g, int line_number, uint32_t flush_every) {
+    batch_session *session = NewSession(flush_every);
+    if(session == NULL) {
+        return g;
+    }
+    InitCharClasses();
+
+    batch_output *output = &session->output;
+    batch_command command;
+    enum line_kind kind;
+
+    while((kind = ReadLine(&session->input, &command,
+                           MAX_COMMAND)) != LINE_END) {
+        uint32_t numbers[3];
+        char name = '\0';
+        bool correct = kind != LINE_ERROR;
+        if(kind == LINE_COMMAND && command.lengths[0] == 1) {
+            name = command.words[0][0];
         }
 
-        iter++;
-        buffor = strtok(NULL, avoid);
-    }
+        if(kind != LINE_COMMAND) {
+            // pusta linia, komentarz lub błąd w zapisie linii
 
-    if (iter < 3) {
-        return false;
-    }
+        } else if(name == 'm' || name == 'g') {
+            if(GetNumbers(&command, 1, 3, numbers)) {
+                bool done = name == 'm'
+                            ? gamma_move(g,numbers[0],numbers[1],numbers[2])
+                            : gamma_golden_move(g,numbers[0],numbers[1],
+                                                numbers[2]);
+                AppendNumber(output, done);
+            } else {
+                correct = false;
+            }
 
-    return true;
+        } else if(name == 'b' || name == 'f') {
+            if(GetNumbers(&command, 1, 1, numbers)) {
+                AppendNumber(output, name == 'b'
+                                     ? gamma_busy_fields(g,numbers[0])
+                                     : gamma_free_fields(g,numbers[0]));
+            } else {
+                correct = false;
+            }
 
-}
+        } else if(name == 'q') {
+            if(GetNumbers(&command, 1, 1, numbers)) {
+                AppendNumber(output, gamma_golden_possible(g,numbers[0]));
+            } else {
+                correct = false;
+            }
 
+        } else if(name == 'a') {
+            gamma_bot_move move;
+            if(GetNumbers(&command, 1, 2, numbers) && numbers[1] > 0) {
+                gamma_bot_options options = {
+                    .threads = BOT_THREADS,
+                    .playouts = numbers[1],
+                    .seed = BOT_SEED
+                };
+                correct = gamma_bot_suggest(g,numbers[0],&options,&move);
+            } else {
+                correct = false;
+            }
+            if(correct) {
+                char answer[MAX_ANSWER];
+                int length = snprintf(answer, sizeof(answer), "%u %u %d\n",
+                                      move.x, move.y, move.golden);
+                AppendChunk(answer, length, output);
+            }
 
-/** @brief Sprawdza czy wejście z stdin jest poprawne dla komendy wykonującej
- * sprawdzającej parametry gracza oraz zapisuje kolejne argumenty na
- * kolejne indeksy {0,1,2} @p input.
- * Jeśli argumenty były niepoprawne funkcja zwraca false ale niektóre z
- * argumentów mogą zostać zapisane do @p input.
- * @param[in,out] input   – wskiaźnik na strukturę przechowującą stan gry,
- *                          o rozmiarze większym lub równym 3.
- *                          różny od NULL.
- * @return true - podane parametry były poprawne.
- *         false - podane parametry były niepoprawne.
- */
+        } else if(name == 'e') {
+            gamma_solve_options options = {
+                .threads = SOLVE_THREADS,
+                .max_nodes = SOLVE_NODES
+            };
+            gamma_solve_result result;
+            correct = GetNumbers(&command, 1, 2, numbers)
+                      && gamma_solve(g,numbers[0],numbers[1],&options,
+                                     &result);
+            if(correct && !result.solved) {
+                AppendChunk("?\n", 2, output);
+            } else if(correct && result.has_move) {
+                char answer[2 * MAX_ANSWER];
+                int length = snprintf(answer, sizeof(answer),
+                                      "%u %u %u %u %d\n", result.busy,
+                                      result.player, result.x, result.y,
+                                      result.golden);
+                AppendChunk(answer, length, output);
+            } else if(correct) {
+                AppendNumber(output, result.busy);
+            }
 
-bool GetInputPlayer(uint32_t *input) {
-    char *buffor = NULL;
-    char avoid[] = " \t\v\f\r";
+        } else if(name == 'p') {
+            correct = command.count == 1
+                      && gamma_board_stream(g,AppendChunk,output);
 
-    buffor = strtok(NULL, avoid);
+        } else if(name == 'i') {
+            correct = command.count == 1
+                      && gamma_stats_stream(AppendChunk,output);
 
-    if(buffor == NULL) {
-        return false;
-    }
+        } else if(name == 's') {
+            if(command.count == 2) {
+                AppendNumber(output, gamma_save(g,command.words[1]));
+            } else {
+                correct = false;
+            }
 
-    for(unsigned long i = 0; i < strlen(buffor); i++) {
-        if((int)buffor[i] < (int)'0' || (int)buffor[i] > (int)'9') {
-            if(!(i == strlen(buffor) - 1 && buffor[i] == '\n')) {
-                return false;
+        } else if(name == 'l') {
+            if(command.count == 2) {
+                gamma_t *loaded = gamma_load(command.words[1]);
+                if(loaded != NULL) {
+                    gamma_delete(g);
+                    g = loaded;
+                }
+                AppendNumber(output, loaded != NULL);
+            } else {
+                correct = false;
             }
+
+        } else {
+            correct = false;
         }
-    }
-    char *end;
 
-    if(GoodArgument(buffor)) {
-        *input = (uint32_t) strtol(buffor,&end,10);;
-    } else {
-        return false;
+        if(!correct) {
+            ReportError(session, line_number);
+        }
+        line_number++;
+        CountLine(session);
     }
 
-    buffor = strtok(NULL, avoid);
+    EndSession(session);
 
-    if(buffor != NULL) {
-        return false;
-    }
+    return g;
+}
 
-    return true;
+/** @brief Odczytuje liczbę zapisaną w czterech bajtach od najmniej
+ * znaczącego.
+ * @param[in] bytes   – bajty liczby.
+ * @return Wartość liczby.
+ */
 
+static inline uint32_t GetLittle32(const unsigned char *bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8
+           | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
 }
 
+/** @brief Zapisuje liczbę w @p count bajtach od najmniej znaczącego.
+ * @param[out] bytes  – miejsce na bajty liczby,
+ * @param[in] x       – zapisywana liczba,
+ * @param[in] count   – liczba bajtów.
+ */
 
-void BatchMode(gamma_t *g, int line_number) {
+static inline void PutLittle(unsigned char *bytes, uint64_t x, int count) {
+    for(int k = 0; k < count; k++) {
+        bytes[k] = x >> (8 * k);
+    }
+}
 
-    // zmienna do wczytywania linii z getline
-    // jest zaalokowana pesymistycznie ponieważ poprawne wejście nigdy nie
-    // przekroczy 50 znaków.
-    char *newline = malloc(sizeof(char) * 50);
-    char avoid[] = " \t\v\f\r\n";
+/** @brief Wczytuje kolejny rekord komendy binarnego trybu wsadowego.
+ * @param[in,out] input   – wskaźnik na bufor wejścia,
+ * @param[out] record     – miejsce na @ref BINARY_COMMAND bajtów rekordu.
+ * @return Wartość @p true, jeśli wczytano cały rekord. Niepełny rekord
+ * na końcu wejścia jest pomijany.
+ */
 
-    while (getline2(&newline)) {
-        if(isWhiteChar(newline[0]) || strlen(newline) == 0 ||
-                            newline[strlen(newline) - 1] != '\n') {
-            fprintf(stderr,"ERROR %d\n", line_number);
-            line_number++;
-            continue;
+static bool ReadRecord(batch_input *input, unsigned char *record) {
+    size_t read = 0;
+    while(read < BINARY_COMMAND && Refill(input)) {
+        size_t size = input->size - input->position;
+        if(size > BINARY_COMMAND - read) {
+            size = BINARY_COMMAND - read;
         }
-        if(newline[0] != '#' && newline[0] != '\n') {
-            char *buffor = NULL;
-
-            buffor = strtok(newline, avoid);
-
-            if(strcmp(buffor,"m") == 0) {
-
-                uint32_t *input = malloc(sizeof(uint32_t) * 3);
-
-                if(GetInputForMove(&input,avoid)) {
-                    if(gamma_move(g,input[0],input[1],input[2])) {
-                        printf("1\n");
-                    } else {
-                        printf("0\n");
-                    }
-
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
-
-                free(input);
-
-            } else if(strcmp(buffor,"g") == 0) {
-                uint32_t *input = malloc(sizeof(uint32_t) * 3);
-
-                if(GetInputForMove(&input,avoid)) {
-                    if(gamma_golden_move(g,input[0],input[1],input[2])) {
-                        printf("1\n");
-                    } else {
-                        printf("0\n");
-                    }
-
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
-
-                free(input);
-
-            } else if(strcmp(buffor,"b") == 0) {
-                uint32_t input;
-
-                if(GetInputPlayer(&input)) {
-                    printf("%lu\n",gamma_busy_fields(g,input));
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
-
-            } else if(strcmp(buffor,"f") == 0) {
-                uint32_t input;
-
-                if(GetInputPlayer(&input)) {
-                    printf("%lu\n",gamma_free_fields(g,input));
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
-
-            } else if(strcmp(buffor,"q") == 0) {
-                uint32_t input;
-
-                if(GetInputPlayer(&input)) {
-                    if(gamma_golden_possible(g,input)) {
-                        printf("1\n");
-                    } else {
-                        printf("0\n");
-                    }
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
-
-            } else if(strcmp(buffor,"p") == 0) {
-
-                buffor = strtok(NULL, avoid);
-
-                if(buffor == NULL) {
-                    char *board = gamma_board(g);
-                    if(board != NULL) {
-                        printf("%s", board);
-                    } else {
-                        fprintf(stderr,"ERROR %d\n", line_number);
-                    }
-                    free(board);
-                } else {
-                    fprintf(stderr,"ERROR %d\n", line_number);
-                }
+        memcpy(record + read, input->block + input->position, size);
+        input->position += size;
+        read += size;
+    }
+    return read == BINARY_COMMAND;
+}
 
-            } else {
-                fprintf(stderr,"ERROR %d\n", line_number);
-            }
+gamma_t *BinaryMode(gamma_t *g, uint32_t flush_every) {
+    batch_session *session = NewSession(flush_every);
+    if(session == NULL) {
+        return g;
+    }
 
+    unsigned char record[BINARY_COMMAND];
+    while(ReadRecord(&session->input, record)) {
+        uint32_t opcode = GetLittle32(record);
+        uint32_t player = GetLittle32(record + 4);
+        uint32_t x = GetLittle32(record + 8);
+        uint32_t y = GetLittle32(record + 12);
+        uint32_t status = BINARY_OK;
+        uint64_t value = 0;
+
+        switch(opcode) {
+            case OPCODE_MOVE:
+                value = gamma_move(g,player,x,y);
+                break;
+            case OPCODE_GOLDEN_MOVE:
+                value = gamma_golden_move(g,player,x,y);
+                break;
+            case OPCODE_BUSY_FIELDS:
+                value = gamma_busy_fields(g,player);
+                break;
+            case OPCODE_FREE_FIELDS:
+                value = gamma_free_fields(g,player);
+                break;
+            case OPCODE_GOLDEN_POSSIBLE:
+                value = gamma_golden_possible(g,player);
+                break;
+            default:
+                status = BINARY_UNKNOWN_OPCODE;
         }
-        line_number++;
-    }
 
-    free(newline);
-}
+        unsigned char *result = (unsigned char *)Reserve(&session->output,
+                                                         BINARY_RESULT);
+        PutLittle(result, opcode, 4);
+        PutLittle(result + 4, status, 4);
+        PutLittle(result + 8, value, 8);
+        session->output.size += BINARY_RESULT;
+        CountLine(session);
+    }
 
+    EndSession(session);
 
+    return g;
+}
@@ -4,6 +4,7 @@
  * @author Daniel Ciołek
  */
 
+#include <stdint.h>
 #include "gamma_structures.h"
 
 #ifndef GAMMA_BATCH_MODE_H
@@ -11,11 +12,75 @@
 
 
 /** @brief Uruchamia gre w trybie "batch mode".
+ * Komenda "s plik" zapisuje stan gry do pliku, a komenda "l plik" zastępuje
+ * grę stanem wczytanym z pliku; obie wypisują 1, gdy się powiodły, i 0
+ * w przeciwnym przypadku.
+ * Komenda "i" wypisuje liczniki i histogramy pracy silnika
+ * (@ref gamma_stats_stream); w wersji skompilowanej bez opcji GAMMA_STATS
+ * jest błędna.
+ * Komenda "a gracz rozgrywki" wypisuje ruch gracza wybrany przez bota
+ * (@ref gamma_bot_suggest) po podanej liczbie rozgrywek w jednym wątku
+ * i ze stałym ziarnem, więc ta sama gra daje ten sam ruch na każdym
+ * komputerze, jako "x y 0" dla zwykłego i "x y 1" dla złotego
+ * ruchu; gdy gracz nie może wykonać ruchu, komenda jest błędna. Ruch nie
+ * jest wykonywany.
+ * Komenda "e gracz następny" rozwiązuje grę na małej planszy
+ * (@ref gamma_solve) i wypisuje "wynik gracz x y złoty": liczbę pól, jaką
+ * gracz może sobie zapewnić, oraz optymalny pierwszy ruch i jego gracza,
+ * a gdy nikt nie może wykonać ruchu, tylko liczbę pól. Gra jest
+ * rozwiązywana w jednym wątku, a z równie dobrych ruchów wybierany jest
+ * pierwszy według @ref gamma_solve, więc odpowiedź nie zależy od komputera;
+ * gdy gry nie da się rozwiązać w 2 * 10^7 pozycjach, komenda wypisuje "?".
+ * Odpowiedzi są zbierane w buforze i wypisywane po jego zapełnieniu,
+ * po każdych @p flush_every liniach wejścia i na końcu wejścia, a komunikaty
+ * o błędach na stderr od razu.
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
  *                      róźny od NULL.
  * @param[in] line_number - numer wiersza, liczba dodatnia.
+ * @param[in] flush_every - co ile linii wejścia wypisywać odpowiedzi,
+ *                          0 oznacza wypisywanie tylko po zapełnieniu
+ *                          bufora i na końcu wejścia.
+ * @return Wskaźnik na strukturę gry trwającej w chwili zakończenia wejścia,
+ * która może być inna niż @p g, jeśli gra została wczytana z pliku.
  */
 
-void BatchMode(gamma_t *g, int line_number);
+gamma_t *BatchMode(gamma_t *g, int line_number, uint32_t flush_every);
+
+/** @brief Kody operacji w rekordach binarnego trybu wsadowego, równe
+ * kodom liter odpowiadających im komend tekstowych.
+ */
+enum binary_opcode {
+    OPCODE_MOVE = 'm',           /**< @ref gamma_move */
+    OPCODE_GOLDEN_MOVE = 'g',    /**< @ref gamma_golden_move */
+    OPCODE_BUSY_FIELDS = 'b',    /**< @ref gamma_busy_fields */
+    OPCODE_FREE_FIELDS = 'f',    /**< @ref gamma_free_fields */
+    OPCODE_GOLDEN_POSSIBLE = 'q' /**< @ref gamma_golden_possible */
+};
+
+/** @brief Stany wykonania komendy w rekordach odpowiedzi binarnego trybu
+ * wsadowego.
+ */
+enum binary_status {
+    BINARY_OK = 0,            /**< komenda wykonana */
+    BINARY_UNKNOWN_OPCODE = 1 /**< nieznany kod operacji, wartość 0 */
+};
+
+/** @brief Uruchamia gre w binarnym trybie wsadowym dla programów.
+ * Wejście to ciąg 16-bajtowych rekordów złożonych z czterech liczb
+ * uint32_t zapisanych od najmniej znaczącego bajtu: kodu operacji
+ * @ref binary_opcode, numeru gracza i współrzędnych x, y, używanych tylko
+ * przez ruchy. Na każdy rekord wypisywany jest 16-bajtowy rekord
+ * odpowiedzi: kod operacji i stan @ref binary_status jako uint32_t oraz
+ * wynik funkcji jako uint64_t, wszystkie od najmniej znaczącego bajtu.
+ * Niepełny rekord na końcu wejścia jest pomijany.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ *                      róźny od NULL.
+ * @param[in] flush_every - co ile rekordów wypisywać odpowiedzi,
+ *                          0 oznacza wypisywanie tylko po zapełnieniu
+ *                          bufora i na końcu wejścia.
+ * @return Wskaźnik na strukturę gry.
+ */
+
+gamma_t *BinaryMode(gamma_t *g, uint32_t flush_every);
 
 #endif //GAMMA_BATCH_MODE_H
@@ -0,0 +1,578 @@
+/** @file
+ * Implementacja bota wybierającego ruch przeszukiwaniem drzewa gry metodą
+ * Monte Carlo (MCTS)
+ *
+ * Każdy wątek buduje własne drzewo z korzenia w stanie gry, dla którego
+ * szukany jest ruch, na własnej kopii gry z włączonym dziennikiem. Jedna
+ * iteracja schodzi w drzewie, dodaje do niego jeden węzeł, rozgrywa losową
+ * grę do końca, a następnie cofa wszystkie ruchy dziennikiem, więc kopia
+ * gry wraca do stanu korzenia bez kopiowania planszy. Na koniec liczby
+ * odwiedzin ruchów z korzenia są sumowane po wątkach.
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+#include <pthread.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "arena_gamma.h"
+
+/** @brief Brak węzła. */
+#define BOT_NONE UINT32_MAX
+
+/** @brief Waga eksploracji we wzorze UCT dla wygranych z przedziału
+ * [0, 1]. */
+#define BOT_EXPLORATION 0.7
+
+/** @brief Największa łączna liczba węzłów drzew wszystkich wątków;
+ * po jej osiągnięciu drzewa przestają rosnąć, a iteracje kończą się
+ * losową grą z liścia. */
+#define BOT_MAX_NODES (1u << 21)
+
+/** @brief Największa liczba pól planszy, dla której bot rozważa złote ruchy;
+ * wyznaczenie ich wymaga próby złotego ruchu na każdym polu przeciwnika. */
+#define BOT_GOLDEN_FIELDS 65536
+
+/**
+ * @brief Ruch z korzenia drzewa.
+ */
+typedef struct bot_candidate {
+    uint32_t field;   /**< indeks pola */
+    bool golden;      /**< czy jest to złoty ruch */
+} bot_candidate;
+
+/**
+ * @brief Węzeł drzewa gry, odpowiadający stanowi po ruchu.
+ */
+typedef struct bot_node {
+    uint32_t field;         /**< indeks pola ruchu prowadzącego do węzła */
+    uint32_t player;        /**< gracz, który wykonał ten ruch, 0 w korzeniu */
+    uint32_t first_child;   /**< pierwsze dziecko lub @ref BOT_NONE */
+    uint32_t next_sibling;  /**< następne dziecko rodzica lub
+                              *  @ref BOT_NONE */
+    uint32_t children;      /**< liczba dzieci */
+    uint32_t moves;         /**< liczba ruchów możliwych w stanie węzła,
+                              *  @ref BOT_NONE przed pierwszym odwiedzeniem */
+    uint32_t visits;        /**< liczba odwiedzin */
+    bool golden;            /**< czy ruch był złoty */
+    double reward;          /**< suma wygranych gracza @p player */
+} bot_node;
+
+/**
+ * @brief Stan wątku przeszukującego drzewo.
+ */
+typedef struct bot_worker {
+    gamma_t *g;                     /**< kopia gry z włączonym dziennikiem,
+                                      *  w stanie korzenia między
+                                      *  iteracjami */
+    uint32_t player;                /**< gracz, dla którego szukany jest
+                                      *  ruch */
+    const bot_candidate *root_moves; /**< ruchy z korzenia */
+    uint32_t root_count;            /**< liczba ruchów z korzenia */
+    bot_node *nodes;                /**< węzły drzewa, korzeń ma indeks 0 */
+    uint32_t nodes_count;           /**< liczba węzłów */
+    uint32_t nodes_capacity;        /**< rozmiar tablicy @p nodes */
+    uint32_t nodes_limit;           /**< największa liczba węzłów */
+    gamma_field *moves;             /**< bufor na ruchy gracza */
+    uint32_t *path;                 /**< węzły odwiedzone w iteracji */
+    uint32_t *stamps;               /**< znaczniki ruchów będących już
+                                      *  dziećmi węzła, dwa na pole */
+    uint32_t stamp;                 /**< bieżący znacznik */
+    double *rewards;                /**< wygrane graczy w ostatniej grze */
+    uint64_t rng;                   /**< stan generatora splitmix64 */
+    uint64_t budget;                /**< liczba iteracji, 0 bez limitu */
+    uint64_t deadline;              /**< czas zakończenia w ns, 0 bez
+                                      *  limitu */
+    uint64_t playouts;              /**< liczba wykonanych iteracji */
+    bool failed;                    /**< czy zabrakło pamięci */
+    bool started;                   /**< czy wątek został uruchomiony */
+    pthread_t thread;               /**< wątek */
+} bot_worker;
+
+/** @brief Podaje czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+static uint64_t Now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/** @brief Losuje liczbę z przedziału [0, @p bound) generatorem splitmix64.
+ * @param[in,out] state – stan generatora,
+ * @param[in] bound     – liczba dodatnia.
+ * @return Liczba pseudolosowa.
+ */
+static uint32_t RandomBelow(uint64_t *state, uint32_t bound) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    return (uint32_t)(((z >> 32) * bound) >> 32);
+}
+
+/** @brief Podaje następnego gracza, który może wykonać zwykły ruch.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] after   – gracz, który wykonał ostatni ruch.
+ * @return Numer gracza lub 0, gdy żaden gracz nie może wykonać ruchu.
+ */
+static uint32_t NextPlayer(gamma_t *g, uint32_t after) {
+    for(uint32_t k = 1; k <= g->number_of_players; k++) {
+        uint32_t player = (after + k - 1) % g->number_of_players + 1;
+        if(gamma_free_fields(g, player) > 0) {
+            return player;
+        }
+    }
+    return 0;
+}
+
+/** @brief Wykonuje ruch węzła na kopii gry wątku.
+ * @param[in,out] w   – wątek,
+ * @param[in] node    – indeks węzła.
+ * @return Wartość @p true, jeśli ruch został wykonany.
+ */
+static bool Apply(bot_worker *w, uint32_t node) {
+    const bot_node *n = &w->nodes[node];
+    uint32_t x = n->field % w->g->width;
+    uint32_t y = n->field / w->g->width;
+    return n->golden ? gamma_golden_move(w->g, n->player, x, y)
+                     : gamma_move(w->g, n->player, x, y);
+}
+
+/** @brief Dodaje węzeł do drzewa.
+ * @param[in,out] w   – wątek,
+ * @param[in] parent  – indeks rodzica,
+ * @param[in] player  – gracz wykonujący ruch,
+ * @param[in] field   – indeks pola ruchu,
+ * @param[in] golden  – czy ruch jest złoty.
+ * @return Indeks węzła lub @ref BOT_NONE, gdy drzewo osiągnęło największy
+ * rozmiar lub nie udało się zaalokować pamięci.
+ */
+static uint32_t AddNode(bot_worker *w, uint32_t parent, uint32_t player,
+                        uint32_t field, bool golden) {
+    if(w->nodes_count == w->nodes_limit) {
+        return BOT_NONE;
+    }
+    if(w->nodes_count == w->nodes_capacity) {
+        uint32_t capacity = w->nodes_capacity * 2 < w->nodes_limit
+                            ? w->nodes_capacity * 2 : w->nodes_limit;
+        bot_node *nodes = GammaRealloc(w->g->arena, w->nodes,
+                                       sizeof(bot_node) * capacity);
+        if(nodes == NULL) {
+            w->nodes_limit = w->nodes_count;
+            return BOT_NONE;
+        }
+        w->nodes = nodes;
+        w->nodes_capacity = capacity;
+    }
+
+    uint32_t node = w->nodes_count++;
+    w->nodes[node] = (bot_node){.field = field, .player = player,
+                                .first_child = BOT_NONE,
+                                .next_sibling = w->nodes[parent].first_child,
+                                .moves = BOT_NONE, .golden = golden};
+    w->nodes[parent].first_child = node;
+    w->nodes[parent].children++;
+    return node;
+}
+
+/** @brief Dodaje do węzła dziecko dla losowego ruchu, który nie jest jeszcze
+ * jego dzieckiem. Kopia gry musi być w stanie węzła.
+ * @param[in,out] w   – wątek,
+ * @param[in] parent  – indeks węzła, który ma mniej dzieci niż ruchów,
+ * @param[in] player  – gracz wykonujący ruch.
+ * @return Indeks dziecka lub @ref BOT_NONE, jak w @ref AddNode.
+ */
+static uint32_t Expand(bot_worker *w, uint32_t parent, uint32_t player) {
+    if(++w->stamp == 0) {
+        uint64_t fields = (uint64_t)w->g->width * w->g->height;
+        for(uint64_t k = 0; k < 2 * fields; k++) {
+            w->stamps[k] = 0;
+        }
+        w->stamp = 1;
+    }
+    for(uint32_t c = w->nodes[parent].first_child; c != BOT_NONE;
+        c = w->nodes[c].next_sibling) {
+        w->stamps[2 * w->nodes[c].field + w->nodes[c].golden] = w->stamp;
+    }
+
+    uint32_t untried = RandomBelow(&w->rng, w->nodes[parent].moves
+                                            - w->nodes[parent].children);
+    if(parent == 0) {
+        for(uint32_t k = 0; k < w->root_count; k++) {
+            const bot_candidate *move = &w->root_moves[k];
+            if(w->stamps[2 * move->field + move->golden] != w->stamp
+               && untried-- == 0) {
+                return AddNode(w, parent, player, move->field, move->golden);
+            }
+        }
+    } else {
+        uint64_t count = gamma_legal_moves(w->g, player, w->moves,
+                                           w->nodes[parent].moves);
+        for(uint64_t k = 0; k < count; k++) {
+            uint32_t field = w->moves[k].y * w->g->width + w->moves[k].x;
+            if(w->stamps[2 * field] != w->stamp && untried-- == 0) {
+                return AddNode(w, parent, player, field, false);
+            }
+        }
+    }
+    return BOT_NONE;
+}
+
+/** @brief Wybiera dziecko węzła o największej wartości UCT.
+ * @param[in] w       – wątek,
+ * @param[in] parent  – indeks węzła mającego dzieci.
+ * @return Indeks dziecka.
+ */
+static uint32_t Select(const bot_worker *w, uint32_t parent) {
+    double exploration = BOT_EXPLORATION
+                         * sqrt(log((double)w->nodes[parent].visits));
+    uint32_t best = BOT_NONE;
+    double best_value = -1;
+    for(uint32_t c = w->nodes[parent].first_child; c != BOT_NONE;
+        c = w->nodes[c].next_sibling) {
+        const bot_node *n = &w->nodes[c];
+        double value = n->reward / n->visits
+                       + exploration / sqrt((double)n->visits);
+        if(value > best_value) {
+            best_value = value;
+            best = c;
+        }
+    }
+    return best;
+}
+
+/** @brief Rozgrywa losową grę do końca zwykłymi ruchami.
+ * @param[in,out] w    – wątek,
+ * @param[in] player   – gracz wykonujący pierwszy ruch lub 0,
+ * @param[in,out] made – liczba ruchów do cofnięcia, zwiększana o ruchy
+ *                       z gry.
+ * @return Wartość @p true, jeśli wszystkie ruchy zostały wykonane.
+ */
+static bool Playout(bot_worker *w, uint32_t player, uint64_t *made) {
+    while(player != 0) {
+        uint32_t x, y;
+        if(!gamma_random_legal_move(w->g, player, &w->rng, &x, &y)
+           || !gamma_move(w->g, player, x, y)) {
+            return false;
+        }
+        (*made)++;
+        player = NextPlayer(w->g, player);
+    }
+    return true;
+}
+
+/** @brief Wyznacza wygrane graczy w zakończonej grze: gracze z największą
+ * liczbą zajętych pól dzielą wygraną równą 1.
+ * @param[in,out] w   – wątek.
+ */
+static void Score(bot_worker *w) {
+    uint32_t players = w->g->number_of_players;
+    uint64_t best = 0;
+    uint32_t winners = 0;
+    for(uint32_t p = 1; p <= players; p++) {
+        uint64_t busy = gamma_busy_fields(w->g, p);
+        if(busy > best) {
+            best = busy;
+            winners = 0;
+        }
+        winners += busy == best;
+    }
+    for(uint32_t p = 1; p <= players; p++) {
+        w->rewards[p - 1] = gamma_busy_fields(w->g, p) == best
+                            ? 1.0 / winners : 0;
+    }
+}
+
+/** @brief Wykonuje jedną iteracją przeszukiwania i przywraca kopię gry do
+ * stanu korzenia.
+ * @param[in,out] w   – wątek.
+ * @return Wartość @p true, jeśli nie zabrakło pamięci.
+ */
+static bool Iterate(bot_worker *w) {
+    uint32_t depth = 0;
+    uint32_t node = 0;
+    uint32_t player = w->player;
+    uint64_t made = 0;
+    bool done = true;
+    w->path[depth++] = node;
+
+    while(player != 0) {
+        bot_node *n = &w->nodes[node];
+        if(n->moves == BOT_NONE) {
+            n->moves = node == 0 ? w->root_count
+                                 : gamma_free_fields(w->g, player);
+        }
+        uint32_t child = n->children < n->moves ? Expand(w, node, player)
+                                                : Select(w, node);
+        if(child == BOT_NONE) {
+            break;
+        }
+        if(!Apply(w, child)) {
+            done = false;
+            break;
+        }
+        made++;
+        node = child;
+        w->path[depth++] = node;
+        player = NextPlayer(w->g, player);
+        if(w->nodes[node].visits == 0) {
+            break;
+        }
+    }
+
+    done = done && Playout(w, player, &made);
+    if(done) {
+        Score(w);
+        for(uint32_t k = 0; k < depth; k++) {
+            bot_node *n = &w->nodes[w->path[k]];
+            n->visits++;
+            if(n->player != 0) {
+                n->reward += w->rewards[n->player - 1];
+            }
+        }
+    }
+
+    while(made > 0 && gamma_undo(w->g)) {
+        made--;
+    }
+    return done && made == 0;
+}
+
+/** @brief Przeszukuje drzewo do wyczerpania limitu iteracji lub czasu.
+ * Wykonuje co najmniej jedną iterację.
+ * @param[in,out] arg – wątek, @ref bot_worker.
+ * @return NULL.
+ */
+static void *Search(void *arg) {
+    bot_worker *w = arg;
+    do {
+        if(!Iterate(w)) {
+            w->failed = true;
+            break;
+        }
+        w->playouts++;
+    } while((w->budget == 0 || w->playouts < w->budget)
+            && (w->deadline == 0 || Now() < w->deadline));
+    return NULL;
+}
+
+/** @brief Wyznacza ruchy gracza z korzenia: zwykłe oraz, na niedużych
+ * planszach, złote.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player    – numer gracza,
+ * @param[out] count    – liczba ruchów.
+ * @return Tablica ruchów lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static bot_candidate *RootMoves(gamma_t *g, uint32_t player,
+                                uint32_t *count) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint64_t regular = gamma_free_fields(g, player);
+    bool golden = fields <= BOT_GOLDEN_FIELDS
+                  && gamma_golden_possible(g, player);
+    uint64_t capacity = regular + (golden ? fields : 0);
+    bot_candidate *moves = GammaAlloc(g->arena, sizeof(bot_candidate)
+                                                * (capacity + 1));
+    gamma_field *buffer = GammaAlloc(g->arena, sizeof(gamma_field)
+                                               * (regular + 1));
+    if(moves == NULL || buffer == NULL) {
+        GammaFree(g->arena, moves);
+        GammaFree(g->arena, buffer);
+        return NULL;
+    }
+
+    *count = gamma_legal_moves(g, player, buffer, regular);
+    for(uint32_t k = 0; k < *count; k++) {
+        moves[k] = (bot_candidate){buffer[k].y * g->width + buffer[k].x,
+                                   false};
+    }
+    GammaFree(g->arena, buffer);
+
+    gamma_t *trial = golden ? gamma_clone(g) : NULL;
+    if(trial != NULL && gamma_journal_enable(trial, true)) {
+        for(uint32_t i = 0; i < fields; i++) {
+            uint32_t owner = Owner(trial, i);
+            if(owner != 0 && owner != player
+               && gamma_golden_move(trial, player, i % g->width,
+                                    i / g->width)) {
+                moves[(*count)++] = (bot_candidate){i, true};
+                gamma_undo(trial);
+            }
+        }
+    }
+    gamma_delete(trial);
+    return moves;
+}
+
+/** @brief Przygotowuje wątek: kopię gry z dziennikiem, korzeń drzewa
+ * i bufory.
+ * @param[in,out] w   – wątek z ustawionymi polami @p player, @p root_moves,
+ *                      @p root_count i @p nodes_limit,
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool NewWorker(bot_worker *w, gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    w->g = gamma_clone(g);
+    if(w->g == NULL) {
+        return false;
+    }
+    gamma_set_query_threads(w->g, 1);
+    w->nodes_capacity = w->nodes_limit < 1024 ? w->nodes_limit : 1024;
+    w->nodes = GammaAlloc(g->arena, sizeof(bot_node) * w->nodes_capacity);
+    w->moves = GammaAlloc(g->arena, sizeof(gamma_field) * fields);
+    w->path = GammaAlloc(g->arena, sizeof(uint32_t) * (fields + 2));
+    w->stamps = GammaCalloc(g->arena, 2 * fields, sizeof(uint32_t));
+    w->rewards = GammaAlloc(g->arena, sizeof(double) * g->number_of_players);
+    if(!gamma_journal_enable(w->g, true) || w->nodes == NULL
+       || w->moves == NULL || w->path == NULL || w->stamps == NULL
+       || w->rewards == NULL) {
+        return false;
+    }
+    w->nodes[0] = (bot_node){.first_child = BOT_NONE,
+                             .next_sibling = BOT_NONE,
+                             .moves = w->root_count};
+    w->nodes_count = 1;
+    return true;
+}
+
+/** @brief Zwalnia pamięć wątku.
+ * @param[in,out] w   – wątek,
+ * @param[in] arena   – arena gry, z której pochodzi pamięć wątku.
+ */
+static void DeleteWorker(bot_worker *w, gamma_arena *arena) {
+    gamma_delete(w->g);
+    GammaFree(arena, w->nodes);
+    GammaFree(arena, w->moves);
+    GammaFree(arena, w->path);
+    GammaFree(arena, w->stamps);
+    GammaFree(arena, w->rewards);
+}
+
+/** @brief Sumuje odwiedziny ruchów z korzenia po wątkach i wybiera ruch
+ * odwiedzany najczęściej.
+ * @param[in] workers – wątki,
+ * @param[in] threads – liczba wątków,
+ * @param[in] moves   – ruchy z korzenia,
+ * @param[in] count   – liczba ruchów z korzenia,
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Indeks wybranego ruchu w @p moves lub @p count, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static uint32_t BestMove(const bot_worker *workers, uint32_t threads,
+                         const bot_candidate *moves, uint32_t count,
+                         gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t *index = GammaAlloc(g->arena, sizeof(uint32_t) * 2 * fields);
+    uint64_t *visits = GammaCalloc(g->arena, count, sizeof(uint64_t));
+    if(index == NULL || visits == NULL) {
+        GammaFree(g->arena, index);
+        GammaFree(g->arena, visits);
+        return count;
+    }
+    for(uint32_t k = 0; k < count; k++) {
+        index[2 * moves[k].field + moves[k].golden] = k;
+    }
+    for(uint32_t t = 0; t < threads; t++) {
+        const bot_node *nodes = workers[t].nodes;
+        for(uint32_t c = nodes[0].first_child; c != BOT_NONE;
+            c = nodes[c].next_sibling) {
+            visits[index[2 * nodes[c].field + nodes[c].golden]] +=
+                    nodes[c].visits;
+        }
+    }
+
+    uint32_t best = 0;
+    for(uint32_t k = 1; k < count; k++) {
+        if(visits[k] > visits[best]) {
+            best = k;
+        }
+    }
+    GammaFree(g->arena, index);
+    GammaFree(g->arena, visits);
+    return best;
+}
+
+bool gamma_bot_suggest(gamma_t *g, uint32_t player,
+                       const gamma_bot_options *options,
+                       gamma_bot_move *move) {
+    if(g == NULL || options == NULL || move == NULL || player == 0
+       || player > g->number_of_players || options->threads == 0
+       || options->threads > GAMMA_BOT_MAX_THREADS
+       || (options->playouts == 0 && options->time_ms == 0)) {
+        return false;
+    }
+    uint64_t start = Now();
+    move->playouts = 0;
+
+    uint32_t count = 0;
+    bot_candidate *moves = RootMoves(g, player, &count);
+    if(moves == NULL || count == 0) {
+        GammaFree(g->arena, moves);
+        return false;
+    }
+
+    // pamięci z areny nie można używać z wielu wątków naraz
+    uint32_t threads = g->arena != NULL ? 1 : options->threads;
+    if(options->playouts != 0 && options->playouts < threads) {
+        threads = options->playouts;
+    }
+    bot_worker *workers = GammaCalloc(g->arena, threads, sizeof(bot_worker));
+    bool ready = workers != NULL;
+    for(uint32_t k = 0; ready && k < threads; k++) {
+        bot_worker *w = &workers[k];
+        w->player = player;
+        w->root_moves = moves;
+        w->root_count = count;
+        w->nodes_limit = BOT_MAX_NODES / threads;
+        w->rng = options->seed + (k + 1) * 0xD1B54A32D192ED03ULL;
+        w->budget = options->playouts / threads
+                    + (k < options->playouts % threads);
+        w->deadline = options->time_ms == 0
+                      ? 0 : start + options->time_ms * 1000000;
+        ready = NewWorker(w, g);
+    }
+
+    uint32_t best = count;
+    if(ready) {
+        for(uint32_t k = 1; k < threads; k++) {
+            workers[k].started = pthread_create(&workers[k].thread, NULL,
+                                                Search, &workers[k]) == 0;
+        }
+        Search(&workers[0]);
+        for(uint32_t k = 1; k < threads; k++) {
+            if(workers[k].started) {
+                pthread_join(workers[k].thread, NULL);
+            } else {
+                Search(&workers[k]);
+            }
+        }
+
+        for(uint32_t k = 0; k < threads; k++) {
+            ready = ready && !workers[k].failed;
+            move->playouts += workers[k].playouts;
+        }
+        if(ready) {
+            best = BestMove(workers, threads, moves, count, g);
+        }
+    }
+
+    if(best < count) {
+        move->x = moves[best].field % g->width;
+        move->y = moves[best].field / g->width;
+        move->golden = moves[best].golden;
+    }
+    for(uint32_t k = 0; workers != NULL && k < threads; k++) {
+        DeleteWorker(&workers[k], g->arena);
+    }
+    GammaFree(g->arena, workers);
+    GammaFree(g->arena, moves);
+    return best < count;
+}
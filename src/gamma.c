@@ -10,74 +10,76 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+#include "gamma.h"
 #include "gamma_structures.h"
 #include "union_find_gamma.h"
+#include "golden_gamma.h"
+#include "journal_gamma.h"
+#include "legal_gamma.h"
+#include "active_gamma.h"
+#include "tiles_gamma.h"
+#include "arena_gamma.h"
+#include "scan_gamma.h"
+#include "stats_gamma.h"
 #include "utilities.h"
 
 gamma_t* gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas) {
+    return gamma_new_in(NULL, width, height, players, areas);
+}
+
+gamma_t* gamma_new_in(gamma_arena *arena, uint32_t width, uint32_t height,
+                      uint32_t players, uint32_t areas) {
+    STATS_TIME(STATS_API_NEW);
 
     if(width == 0 || height == 0 || areas == 0 || players == 0) {
         return NULL;
     }
+    // indeksy pól muszą mieścić się w uint32_t
+    uint64_t fields = (uint64_t)width * height;
+    if(fields > UINT32_MAX) {
+        return NULL;
+    }
 
     gamma_t *new_game;
-    new_game = malloc(sizeof(gamma_t));
+    new_game = GammaAlloc(arena, sizeof(gamma_t));
 
     if(new_game == NULL)
         return NULL;
 
+    new_game->width = width;
+    new_game->height = height;
     new_game->number_of_players = players;
     new_game->max_areas = areas;
-    new_game->free_fields_under_max_areas = width * height;
-    new_game->board = (board_element **) malloc(sizeof(struct board_element*) * width);
-    if(new_game->board == NULL) {
-        free(new_game);
-        return NULL;
-    }
-
-    for(uint32_t i = 0; i < width; i++) {
-        new_game->board[i] = (board_element *) malloc(sizeof(struct board_element) * height);
-        if(new_game->board[i] == NULL) {
-
-            for(int j = i; j >= 0; j --) {
-                free(new_game->board[j]);
-            }
-            free(new_game->board);
-            free(new_game);
-
-            return NULL;
-        }
-        for(uint32_t j = 0; j < height; j++) {
-
-            (new_game->board[i][j]).player_number = 0;
-            (new_game->board[i][j]).parent_x = i;
-            (new_game->board[i][j]).parent_y = j;
-            (new_game->board[i][j]).size = 1;
-            (new_game->board[i][j]).visited = false;
-
-        }
-    }
-
-    new_game->players = (one_player *)malloc(sizeof(one_player) * players);
-    if(new_game->players == NULL) {
-        for(uint32_t j = 0; j < width; j++) {
-            free(new_game->board[j]);
-        }
-        free(new_game->board);
-        free(new_game);
+    new_game->free_fields_under_max_areas = fields;
+    new_game->visited = NULL;
+    new_game->queue = NULL;
+    new_game->generation = 0;
+    new_game->discovery = NULL;
+    new_game->low = NULL;
+    new_game->dfs_state = NULL;
+    new_game->journal = NULL;
+    new_game->legal = NULL;
+    new_game->active = NULL;
+    new_game->arena = arena;
+    new_game->pool = NULL;
+    new_game->query_threads = 1;
+    new_game->players = GammaAlloc(arena, sizeof(one_player) * players);
+    if(!NewBoard(new_game) || new_game->players == NULL) {
+        FreeBoard(new_game);
+        GammaFree(arena, new_game->players);
+        GammaFree(arena, new_game);
         return NULL;
     }
 
     for(uint32_t i = 0; i < players; i ++) {
         (new_game->players[i]).number_of_areas = 0;
         (new_game->players[i]).busy_fields = 0;
+        (new_game->players[i]).adjacent_free_fields = 0;
         (new_game->players[i]).gold_possible = true;
     }
 
-    new_game->width = width;
-    new_game-> height = height;
-
     return new_game;
 }
 
@@ -85,12 +87,56 @@ void gamma_delete(gamma_t *g) {
     if(g == NULL) {
         return;
     }
-    for(uint32_t i = 0; i < g->width; i++) {
-        free(g->board[i]);
+    if(g->pool != NULL) {
+        gamma_pool_release(g);
+        return;
     }
-    free(g->board);
-    free(g->players);
-    free(g);
+    gamma_arena *arena = g->arena;
+    FreeBoard(g);
+    GammaFree(arena, g->visited);
+    GammaFree(arena, g->queue);
+    GammaFree(arena, g->discovery);
+    GammaFree(arena, g->low);
+    GammaFree(arena, g->dfs_state);
+    FreeJournal(arena, g->journal);
+    DropLegal(g);
+    DropActive(g);
+    GammaFree(arena, g->players);
+    GammaFree(arena, g);
+}
+
+gamma_t* gamma_clone(gamma_t *g) {
+    if(g == NULL) {
+        return NULL;
+    }
+
+    gamma_t *copy = GammaAlloc(g->arena, sizeof(gamma_t));
+    if(copy == NULL) {
+        return NULL;
+    }
+
+    *copy = *g;
+    copy->visited = NULL;
+    copy->queue = NULL;
+    copy->generation = 0;
+    copy->discovery = NULL;
+    copy->low = NULL;
+    copy->dfs_state = NULL;
+    copy->journal = NULL;
+    copy->legal = NULL;
+    copy->active = NULL;
+    copy->pool = NULL;
+    copy->players = GammaAlloc(g->arena,
+                               sizeof(one_player) * g->number_of_players);
+    if(copy->players == NULL || !ShareBoard(copy,g)) {
+        GammaFree(g->arena, copy->players);
+        GammaFree(g->arena, copy);
+        return NULL;
+    }
+    memcpy(copy->players, g->players,
+           sizeof(one_player) * g->number_of_players);
+
+    return copy;
 }
 
 /** @brief Oblicza ilość elementów należących do gracza @p player
@@ -107,174 +153,435 @@ void gamma_delete(gamma_t *g) {
  * które sąsiadują z (@p x,@p y).
  */
 int NumberOfAdjacent(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    uint32_t i = x;
-    uint32_t j = y;
+    uint32_t i = BoardIndex(g,x,y);
 
     int result = 0;
 
-    if(i > 0 && i - 1 < g->width) {
-        if(g->board[i - 1][y].player_number == player) {
-            result++;
-        }
+    if(x > 0 && Owner(g,i - 1) == player) {
+        result++;
     }
-    i++;
-    if(i < g->width) {
-        if(g->board[i][j].player_number == player) {
-            result++;
-        }
+    if(x + 1 < g->width && Owner(g,i + 1) == player) {
+        result++;
     }
-    i = x;
-    if(j > 0 && j - 1 < g->height) {
-        if(g->board[i][j - 1].player_number == player) {
-            result++;
-        }
+    if(y > 0 && Owner(g,i - g->width) == player) {
+        result++;
     }
-    j++;
-    if(j < g->height) {
-        if(g->board[i][j].player_number == player) {
-            result++;
-        }
+    if(y + 1 < g->height && Owner(g,i + g->width) == player) {
+        result++;
     }
 
     return result;
 }
 
-bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if(g == NULL) {
-        return false;
-    }
-    if(x >= g->width || y >= g->height || player == 0)
-        return false;
-    if(g->board[x][y].player_number != 0 || g->board[x][y].player_number == player) {
-        return false;
+/** @brief Aktualizuje liczniki wolnych pól sąsiadujących z graczami przed
+ * zajęciem wolnego pola (@p x,@p y) przez gracza @p player.
+ * Sprawdza jedynie sąsiedztwo pola (@p x,@p y) i sąsiedztwa jego sąsiadów.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza zajmującego pole,
+ *                      liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny wolnego pola, liczba nieujemna mniejsza
+ *                      od wartości @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza wolnego pola, liczba nieujemna mniejsza
+ *                      od wartości @p height z funkcji @ref gamma_new.
+ */
+void FieldTaken(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    uint32_t neighbours[4];
+    int count = Neighbours(g,x,y,neighbours);
+
+    for(int k = 0; k < count; k++) {
+        uint32_t owner = Owner(g,neighbours[k]);
+        if(owner == 0) {
+            // wolny sąsiad staje się sąsiadem gracza player
+            uint32_t nx = neighbours[k] % g->width;
+            uint32_t ny = neighbours[k] / g->width;
+            if(NumberOfAdjacent(g,player,nx,ny) == 0) {
+                JournalPlayer(g,player);
+                g->players[player - 1].adjacent_free_fields++;
+            }
+            continue;
+        }
+        int z;
+        for(z = 0; z < k; z++) {
+            if(Owner(g,neighbours[z]) == owner) {
+                break;
+            }
+        }
+        if(z == k) {
+            // pole (x,y) przestaje być wolnym polem sąsiadującym z owner
+            JournalPlayer(g,owner);
+            g->players[owner - 1].adjacent_free_fields--;
+        }
     }
-    if(player > g->number_of_players) {
-        return false;
+}
+
+/** @brief Aktualizuje liczniki wolnych pól sąsiadujących z graczami po
+ * zwolnieniu pola (@p x,@p y) zajmowanego dotąd przez gracza @p player.
+ * Pole (@p x,@p y) musi być już puste.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, który zajmował pole,
+ *                      liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny pola, liczba nieujemna mniejsza
+ *                      od wartości @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza pola, liczba nieujemna mniejsza
+ *                      od wartości @p height z funkcji @ref gamma_new.
+ */
+void FieldFreed(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    uint32_t neighbours[4];
+    int count = Neighbours(g,x,y,neighbours);
+
+    for(int k = 0; k < count; k++) {
+        uint32_t owner = Owner(g,neighbours[k]);
+        if(owner == 0) {
+            // wolny sąsiad mógł sąsiadować z graczem player tylko przez (x,y)
+            uint32_t nx = neighbours[k] % g->width;
+            uint32_t ny = neighbours[k] / g->width;
+            if(NumberOfAdjacent(g,player,nx,ny) == 0) {
+                JournalPlayer(g,player);
+                g->players[player - 1].adjacent_free_fields--;
+            }
+            continue;
+        }
+        int z;
+        for(z = 0; z < k; z++) {
+            if(Owner(g,neighbours[z]) == owner) {
+                break;
+            }
+        }
+        if(z == k) {
+            // pole (x,y) staje się wolnym polem sąsiadującym z owner
+            JournalPlayer(g,owner);
+            g->players[owner - 1].adjacent_free_fields++;
+        }
     }
-    if(NumOfUniqueAreas(g,player,x,y) == 0) {
+}
+
+/** @brief Stawia pionek gracza @p player na wolnym polu (@p x,@p y),
+ * jeśli nie zwiększy to liczby jego obszarów ponad maksymalną.
+ * Nie sprawdza poprawności parametrów i nie rozpoczyna ruchu w dzienniku.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny wolnego pola, liczba nieujemna mniejsza
+ *                      od wartości @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza wolnego pola, liczba nieujemna mniejsza
+ *                      od wartości @p height z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli pionek został postawiony, a @p false,
+ * gdy gracz przekroczyłby maksymalną liczbę obszarów.
+ */
+bool PlaceField(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    uint32_t i = BoardIndex(g,x,y);
+    int unique_areas = NumOfUniqueAreas(g,player,x,y);
+
+    if(unique_areas == 0) {
         if(g->players[player - 1].number_of_areas + 1 > g->max_areas){
             return false;
         }
-        g->board[x][y].player_number = player;
+        FieldTaken(g,player,x,y);
+        JournalField(g,i);
+        SetOwner(g,i,player);
+        LegalField(g,i,0,player);
+        JournalPlayer(g,player);
         g->players[player - 1].number_of_areas++;
 
         g->players[player - 1].busy_fields++;
         g->free_fields_under_max_areas--;
+        ActivePlaced(g,player,x,y,unique_areas);
 
         return true;
     } else {
 
-        int unique_areas = NumOfUniqueAreas(g,player,x,y);
-
-        g->board[x][y].player_number = player;
+        FieldTaken(g,player,x,y);
+        JournalField(g,i);
+        SetOwner(g,i,player);
+        LegalField(g,i,0,player);
 
         UnionAdjacent(g,player,x,y);
 
-        g->board[x][y].player_number = player;
-
+        JournalPlayer(g,player);
         g->players[player - 1].number_of_areas -= (unique_areas - 1);
 
         g->players[player - 1].busy_fields++;
         g->free_fields_under_max_areas--;
+        ActivePlaced(g,player,x,y,unique_areas);
 
         return true;
     }
 }
 
-/** @brief Realokuje pamięć na tablice board jeśli jej przewidywany rozmiar
- * przekracza zaalokowane miejsce w pamięci.
- * @param[in,out] board       - wskaźnik na tablice,liczba nieujemna
- * @param[in,out] board_size  – aktualny rozmiar tablicy,liczba nieujemna
- * @param[in,out] board_size_in_memory – aktualny rozmiar tablicy w pamięci,
- *                                       liczba nieujemna
- * @return Wskaźnik na board lub NULL, gdy nie udało się zaalokować pamięci.
+/** @brief Kopiuje współdzielone kafelki, które zmieni postawienie pionka
+ * gracza @p player na wolnym polu (@p x,@p y), tak aby ruch nie mógł się
+ * przerwać w połowie z braku pamięci.
+ * Zmieniane są tylko to pole i korzenie sąsiednich obszarów gracza.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
  */
-char* BoardRealloc(char *board, size_t *board_size, size_t *board_size_in_memory) {
-    if (board_size > board_size_in_memory) {
-        board = realloc(board, sizeof(char) * (*board_size * 2));
-        if (board == NULL) {
-            return NULL;
+bool PrepareMove(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if(!g->shared_tiles) {
+        return true;
+    }
+    if(!UnshareField(g,BoardIndex(g,x,y))) {
+        return false;
+    }
+
+    uint32_t neighbours[4];
+    int count = Neighbours(g,x,y,neighbours);
+    for(int k = 0; k < count; k++) {
+        if(Owner(g,neighbours[k]) == player
+           && !UnshareField(g,Root(g,neighbours[k]))) {
+            return false;
         }
-        *board_size_in_memory = *board_size * 2;
     }
-    return board;
+    return true;
 }
 
-char *gamma_board(gamma_t *g) {
+/** @brief Kopiuje współdzielone kafelki, które zmieni złoty ruch gracza
+ * @p player na zajęte pole (@p x,@p y): pola obszaru, do którego należy to
+ * pole, i pola zmieniane przez @ref PrepareMove.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p height z funkcji @ref gamma_new.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool PrepareGoldenMove(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    if(!g->shared_tiles) {
+        return true;
+    }
+    if(!NewVisitGeneration(g)) {
+        return false;
+    }
+
+    uint32_t i = BoardIndex(g,x,y);
+    uint32_t size = FloodArea(g,Owner(g,i),i);
+    for(uint32_t k = 0; k < size; k++) {
+        if(!UnshareField(g,g->queue[k])) {
+            return false;
+        }
+    }
+    return PrepareMove(g,player,x,y);
+}
+
+bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    STATS_TIME(STATS_API_MOVE);
     if(g == NULL) {
-        return NULL;
+        return false;
     }
-    
-    char *board;
-    if( NumberOfDigits(g->number_of_players) > 1) {
-        // alokuje pamięć pesymistycznie
-        board = malloc(sizeof(char) * (g->width + 1) * g->height *
-                        (2+ NumberOfDigits(g->number_of_players))+ 2);
-    } else {
-        board = malloc(sizeof(char) * (g->width + 1) * g->height + 2);
+    if(x >= g->width || y >= g->height || player == 0)
+        return false;
+    if(player > g->number_of_players) {
+        return false;
     }
-    if (board == NULL) {
-        return NULL;
+    if(Owner(g,BoardIndex(g,x,y)) != 0) {
+        return false;
     }
-    size_t board_size = 0;
-    size_t board_size_in_memory = (g->width + 1) * g->height + 1;
-    size_t iter = 0;
-
-    for (int i = g->height - 1; i >= 0; i--) {
-        for (uint32_t j = 0; j < g->width; j++) {
-
-            if (g->board[j][i].player_number == 0) {
-
-                board = BoardRealloc(board,&board_size,&board_size_in_memory);
-                if (board == NULL) {
-                    return NULL;
-                }
-
-                board_size++;
-                board[iter] = '.';
-                iter++;
-            } else {
-                int number_of_digits = NumberOfDigits(g->board[j][i].player_number);
-                board_size += number_of_digits + 2;
-
-                board = BoardRealloc(board,&board_size,&board_size_in_memory);
-                if (board == NULL) {
-                    return NULL;
-                }
-
-                if (number_of_digits > 9) {
-                    board[iter] = '|';
-                    iter++;
-                }
-                IntToString(g->board[j][i].player_number, board, number_of_digits, iter);
-                iter += number_of_digits;
-
-                if (number_of_digits > 9) {
-                    board[iter] = '|';
-                    iter++;
-                }
-            }
-            board_size++;
 
-            board = BoardRealloc(board,&board_size,&board_size_in_memory);
-            if (board == NULL) {
-                return NULL;
+    JournalBeginMove(g,player,x,y,false);
+    if(!PrepareMove(g,player,x,y) || !PlaceField(g,player,x,y)) {
+        JournalCancelMove(g);
+        return false;
+    }
+    return true;
+}
+
+/** @brief Największa liczba znaków opisujących jedno pole planszy:
+ * dziesięciocyfrowy numer gracza otoczony znakami '|'. */
+#define MAX_FIELD_LENGTH 12
+
+/** @brief Rozmiar bufora, w którym @ref gamma_board_stream składa
+ * kolejne fragmenty napisu. */
+#define BOARD_CHUNK 65536
+
+/** @brief Podaje liczbę znaków opisujących pole zajęte przez gracza
+ * @p player lub wolne pole, gdy @p player jest równy 0.
+ * @param[in] player  – numer gracza lub 0.
+ * @return Liczba znaków opisu pola.
+ */
+static inline int FieldLength(uint32_t player) {
+    if(player < 10) {
+        return 1;
+    }
+    int digits = NumberOfDigits(player);
+    return digits > 9 ? digits + 2 : digits;
+}
+
+/** @brief Wpisuje opis pola zajętego przez gracza @p player do @p out.
+ * Wolne pole opisuje znak '.', a numery graczy mające więcej niż 9 cyfr
+ * otoczone są znakami '|'.
+ * @param[in] player  – numer gracza lub 0 dla wolnego pola,
+ * @param[out] out    – bufor o rozmiarze co najmniej @ref MAX_FIELD_LENGTH.
+ * @return Liczba wpisanych znaków.
+ */
+static inline int WriteField(uint32_t player, char *out) {
+    if(player < 10) {
+        *out = player == 0 ? '.' : (char)('0' + player);
+        return 1;
+    }
+    if(player < 1000000000) {
+        return FormatNumber(player, out);
+    }
+    out[0] = '|';
+    int digits = FormatNumber(player, out + 1);
+    out[digits + 1] = '|';
+    return digits + 2;
+}
+
+/** @brief Podaje długość napisu opisującego planszę, bez znaku '\0'.
+ * Gdy graczy jest mniej niż pól, korzysta z liczby pól każdego gracza,
+ * w przeciwnym przypadku przegląda planszę.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry.
+ * @return Długość napisu.
+ */
+static uint64_t BoardLength(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint64_t length = fields + g->height;
+
+    if(g->number_of_players < 10) {
+        return length;
+    }
+    if(g->number_of_players <= fields) {
+        for(uint32_t player = 10; player <= g->number_of_players; player++) {
+            length += g->players[player - 1].busy_fields
+                      * (FieldLength(player) - 1);
+        }
+    } else {
+        for(uint32_t i = 0; i < fields; i++) {
+            length += FieldLength(Owner(g,i)) - 1;
+        }
+    }
+    return length;
+}
+
+/** @brief Pozycja w napisie opisującym planszę, od której
+ * @ref RenderBoard wypisuje kolejny fragment.
+ */
+typedef struct board_cursor {
+    uint32_t row;     /**< numer wiersza napisu, licząc od góry planszy */
+    uint32_t column;  /**< numer kolumny w wierszu */
+} board_cursor;
+
+/** @brief Wpisuje do @p out kolejny fragment napisu opisującego planszę,
+ * zaczynając od pozycji @p cursor. Przechodzi planszę wierszami, od
+ * najwyższego wiersza, i nie dzieli opisu pola między fragmenty.
+ * @param[in] g          – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] cursor – pozycja w napisie, przesuwana za wpisany fragment,
+ * @param[out] out       – bufor na fragment,
+ * @param[in] capacity   – rozmiar bufora @p out.
+ * @return Liczba wpisanych znaków; 0 oznacza koniec napisu.
+ */
+static size_t RenderBoard(gamma_t *g, board_cursor *cursor, char *out,
+                          size_t capacity) {
+    size_t length = 0;
+
+    while(cursor->row < g->height) {
+        uint32_t i = BoardIndex(g,cursor->column,g->height - 1 - cursor->row);
+
+        // przy jednocyfrowych numerach graczy każde pole to jeden znak,
+        // więc wiersz wypisujemy fragmentami leżącymi w jednym kafelku
+        while(g->number_of_players < 10 && cursor->column < g->width
+              && length < capacity) {
+            uint32_t k = i & (TILE_FIELDS - 1);
+            uint64_t run = g->width - cursor->column;
+            if(run > TILE_FIELDS - k) {
+                run = TILE_FIELDS - k;
+            }
+            if(run > capacity - length) {
+                run = capacity - length;
+            }
+            RenderDigits(g->tiles[i >> TILE_BITS]->owners + k,run,
+                         out + length);
+            length += run;
+            cursor->column += run;
+            i += run;
+        }
+        while(cursor->column < g->width) {
+            uint32_t player = Owner(g,i);
+            if(capacity - length < MAX_FIELD_LENGTH
+               && capacity - length < (size_t)FieldLength(player)) {
+                return length;
             }
+            length += WriteField(player,out + length);
+            cursor->column++;
+            i++;
         }
-        board[iter] = '\n';
-        iter++;
+        if(length == capacity) {
+            return length;
+        }
+        out[length++] = '\n';
+        cursor->row++;
+        cursor->column = 0;
     }
+    return length;
+}
 
-    board = BoardRealloc(board,&iter,&board_size_in_memory);
-    if (board == NULL) {
+char *gamma_board(gamma_t *g) {
+    STATS_TIME(STATS_API_BOARD);
+    if(g == NULL) {
         return NULL;
     }
 
-    board[iter] = '\0';
+    uint64_t length = BoardLength(g);
+    if(length >= SIZE_MAX) {
+        return NULL;
+    }
+    char *board = malloc(length + 1);
+    if(board == NULL) {
+        return NULL;
+    }
+
+    // liczniki pól graczy z uszkodzonego wczytanego pliku mogą nie zgadzać
+    // się z planszą, więc napis kończy się tam, gdzie skończyło wypisywanie
+    board_cursor cursor = {0, 0};
+    board[RenderBoard(g,&cursor,board,length)] = '\0';
     return board;
 }
 
+bool gamma_board_stream(gamma_t *g, gamma_board_writer write, void *context) {
+    STATS_TIME(STATS_API_BOARD);
+    if(g == NULL || write == NULL) {
+        return false;
+    }
+
+    char chunk[BOARD_CHUNK];
+    board_cursor cursor = {0, 0};
+    size_t length;
+    while((length = RenderBoard(g,&cursor,chunk,sizeof(chunk))) > 0) {
+        if(!write(chunk,length,context)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Dopisuje fragment napisu do pliku.
+ * @param[in] chunk   – fragment napisu,
+ * @param[in] length  – długość fragmentu,
+ * @param[in] file    – plik otwarty do zapisu.
+ * @return Wartość @p true, jeśli udało się zapisać cały fragment.
+ */
+static bool WriteChunk(const char *chunk, size_t length, void *file) {
+    return fwrite(chunk,1,length,file) == length;
+}
+
+bool gamma_board_write(gamma_t *g, FILE *file) {
+    if(file == NULL) {
+        return false;
+    }
+    return gamma_board_stream(g,WriteChunk,file);
+}
+
 uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
+    STATS_TIME(STATS_API_BUSY_FIELDS);
     if(g == NULL) {
         return 0;
     }
@@ -285,124 +592,107 @@ uint64_t gamma_busy_fields(gamma_t *g, uint32_t player) {
 }
 
 uint64_t gamma_free_fields(gamma_t *g, uint32_t player) {
+    STATS_TIME(STATS_API_FREE_FIELDS);
     if(g == NULL) {
         return 0;
     }
-    uint64_t result = 0;
     if(player == 0 || player > g->number_of_players) {
         return 0;
     }
     if(g->players[player - 1].number_of_areas < g->max_areas) {
         return g->free_fields_under_max_areas;
     } else {
-        for (uint32_t i = 0; i < g->width; i++) {
-            for (uint32_t j = 0; j < g->height; j++) {
-                if (g->board[i][j].player_number == 0
-                    && NumberOfAdjacent(g,player,i,j) > 0) {
-                    result++;
-                }
-            }
-        }
+        return g->players[player - 1].adjacent_free_fields;
     }
-
-    return result;
 }
 
-
-
-/** @brief Zmienia g->board[x][y].visited z true na false w obszarze gracza
- * player który zawiera w sobie element (@p x,@p y)
+/** @brief Odłącza pole (@p x,@p y) od obszaru gracza, który je zajmuje.
+ * Pole staje się puste, a pozostałe pola jego obszaru są łączone za pomocą
+ * Union-Find w obszary, na które ten obszar się rozpadł. Każde pole obszaru
+ * jest odwiedzane dokładnie raz.
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza którego pola połączymy w obszar,
- *                      liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new,
+ *                      róźny od NULL,
  * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
  *                      @p width z funkcji @ref gamma_new,
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+ *                      @p height z funkcji @ref gamma_new,
+ * @param[out] roots  – tablica o rozmiarze co najmniej 4, do której zapisane
+ *                      zostaną korzenie nowych obszarów.
+ * @return Liczba obszarów, na które rozpadł się obszar zawierający
+ * (@p x,@p y) lub -1, gdy nie udało się zaalokować pamięci (wtedy plansza
+ * nie jest zmieniana).
  */
-void RemoveVisited(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    uint32_t i = x;
-    uint32_t j = y;
-
-    if(!(x <g->width && y < g->height)) {
-        return;
-    }
-
-    if(g->board[x][y].visited == false) {
-        return;
-    }
-
-    g->board[x][y].visited = false;
-
-    if(i > 0 && i - 1 < g->width) {
-        if(g->board[i - 1][j].player_number == player) {
-            RemoveVisited(g,player,i - 1,j);
+int DetachField(gamma_t *g, uint32_t x, uint32_t y, uint32_t roots[4]) {
+    if(!NewVisitGeneration(g)) {
+        return -1;
+    }
+
+    uint32_t i = BoardIndex(g,x,y);
+    uint32_t player = Owner(g,i);
+    uint32_t neighbours[4];
+    int count = Neighbours(g,x,y,neighbours);
+    int areas = 0;
+#ifdef GAMMA_STATS
+    uint64_t flooded = 0;
+#endif
+
+    JournalField(g,i);
+    SetOwner(g,i,0);
+    LegalField(g,i,player,0);
+    board_element *field = WritableElement(g,i);
+    field->parent = i;
+    field->rank = 0;
+
+    for(int k = 0; k < count; k++) {
+        uint32_t root = neighbours[k];
+        if(Owner(g,root) != player || IsVisited(g,root)) {
+            continue;
         }
-    }
-    i++;
-    if(i < g->width) {
-        if(g->board[i][j].player_number == player) {
-            RemoveVisited(g,player,i,j);        }
-    }
-    i = x;
-    if(j > 0 && j - 1 < g->height) {
-        if(g->board[i][j - 1].player_number == player) {
-            RemoveVisited(g,player,i,j - 1);
-        }
-    }
-    j++;
-    if(j < g->height) {
-        if(g->board[i][j].player_number == player) {
-            RemoveVisited(g,player,i,j);
+
+        uint32_t size = FloodArea(g,player,root);
+#ifdef GAMMA_STATS
+        flooded += size;
+#endif
+        for(uint32_t j = 0; j < size; j++) {
+            JournalField(g,g->queue[j]);
+            board_element *member = WritableElement(g,g->queue[j]);
+            member->parent = root;
+            member->rank = 0;
         }
-    }
-}
+        WritableElement(g,root)->rank = size > 1;
 
+        roots[areas++] = root;
+    }
 
-/** @brief Zmienia parametry pola planszy o współrzędnych (@p x,@p y)
- * na domyślne.
- * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- *                      róźny od NULL.
- * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- */
-void ResetBoardElement(gamma_t *g, uint32_t x, uint32_t y) {
-    g->board[x][y].player_number = 0;
-    g->board[x][y].parent_x = x;
-    g->board[x][y].parent_y = y;
-    g->board[x][y].size = 1;
+    STATS_RECORD(STATS_GOLDEN_FLOOD, flooded);
+    return areas;
 }
 
-/** @brief Łączy w obszary za pomocą Union-Find
- * elementy sąsiadujące z (@p x,@p y) i należące do gracza @p player
- * (bez elementu (@p x,@p y)).
+/** @brief Przywraca pole (@p x,@p y) odłączone przez @ref DetachField.
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza którego pola połączymy w obszar,
- *                      liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new,
+ *                      róźny od NULL,
  * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
  *                      @p width z funkcji @ref gamma_new,
  * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+ *                      @p height z funkcji @ref gamma_new,
+ * @param[in] player  – numer gracza, który zajmował pole,
+ * @param[in] roots   – korzenie obszarów zwrócone przez @ref DetachField,
+ * @param[in] areas   – liczba obszarów zwrócona przez @ref DetachField.
  */
-void UnionNewAreas(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    UnionAllAdjacent(g,player,x - 1,y,x - 1,y);
-    RemoveVisited(g,player,x - 1,y);
-
-    UnionAllAdjacent(g,player,x + 1,y,x + 1,y);
-    RemoveVisited(g,player,x + 1,y);
-
-    UnionAllAdjacent(g,player,x,y - 1,x,y - 1);
-    RemoveVisited(g,player,x,y - 1);
+void AttachField(gamma_t *g, uint32_t x, uint32_t y, uint32_t player,
+                 const uint32_t roots[4], int areas) {
+    uint32_t i = BoardIndex(g,x,y);
 
-    UnionAllAdjacent(g,player,x,y + 1,x,y + 1);
-    RemoveVisited(g,player,x,y + 1);
+    JournalField(g,i);
+    SetOwner(g,i,player);
+    LegalField(g,i,0,player);
+    for(int k = 0; k < areas; k++) {
+        Union(g,i,roots[k]);
+    }
 }
 
 bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
+    STATS_TIME(STATS_API_GOLDEN_MOVE);
     //Przypadki brzegowe
     if(g == NULL) {
         return false;
@@ -410,8 +700,12 @@ bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
     if(x >= g->width || y >= g->height || player == 0) {
         return false;
     }
-    if(g->board[x][y].player_number == 0
-       || g->board[x][y].player_number == player) {
+    if(player > g->number_of_players) {
+        return false;
+    }
+    uint32_t i = BoardIndex(g,x,y);
+    if(Owner(g,i) == 0
+       || Owner(g,i) == player) {
         return false;
     }
     if(!(g->players[player - 1].gold_possible)) {
@@ -422,119 +716,68 @@ bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
         return false;
     }
 
-    uint32_t old_player_num = g->board[x][y].player_number;
-
-
-    //Rozbijamy obszary należące do old_player_num na pojedyńcze elementy
-    RemoveUnionOnAdjacent(g,old_player_num,x,y);
-    RemoveVisited(g,old_player_num,x,y);
-
-    //Zmieniamy parametry miejsca (x,y) na planszy na podstawowe.
-    //Co może podzielić istniejący obszar na wiele obszarów.
-    ResetBoardElement(g,x,y);
-
-    //Łączymy elementy w nowo powstałe obszary za pomocą Union-Find
-    UnionNewAreas(g,old_player_num,x,y);
-
-    int Num_of_unique_areas_after_gold = NumOfUniqueAreas(g,old_player_num,x,y);
-
-    uint32_t New_number_of_areas =
-            Num_of_unique_areas_after_gold - 1
-            + g->players[old_player_num - 1].number_of_areas;
-
-
-    //Jeśli podział obszaru jest nielegalny cofamy zmiany
-    //po czym scalamy nowe obszary w jeden.
-    if(New_number_of_areas > g->max_areas) {
-        g->board[x][y].player_number = old_player_num;
-        UnionAdjacent(g,old_player_num,x,y);
-        return false;
-    }
-
-    g->players[old_player_num - 1].number_of_areas = New_number_of_areas;
-
-    //Stawiamy pionek gracza o numerze player w miejscu (x,y)
-    if(gamma_move(g,player,x,y)) {
-        g->players[player - 1].gold_possible = false;
+    uint32_t old_player_num = Owner(g,i);
 
-        g->players[old_player_num - 1].busy_fields--;
-        g->free_fields_under_max_areas++;
-        return true;
-    } else {
+    JournalBeginMove(g,player,x,y,true);
+    if(!PrepareGoldenMove(g,player,x,y)) {
+        JournalCancelMove(g);
         return false;
     }
-}
-
-/** @brief Sprawdza czy na danym polu @p x @p y grac @p player może wykonać
- * złoty ruch.
- *  @param[in,out] g - zmienna przechowujaca stan gry.
- *  @param[in] x - współrzędna x gracza @p player, liczba nieujemna, mniejsza
- *                 od g->width.
- *  @param[in] y - współrzędna y gracza @p player, liczba nieujemna, mniejsza
- *                 od g->height.
- *  @param[in] player - numer gracza liczba całkowita nieujemna, mniejsza od
- *                      g->number_of_players.
- *  @return true - Jeśli gracz @p player moze wykonac zloty ruch na to pole.
- *         false - Jeśli gracz @p player nie moze wykonac zlotego ruchu na
- *                 to pole.
- */
-bool TestForGolden(gamma_t *g, uint32_t x, uint32_t y, uint32_t player) {
 
-    if(NumberOfAdjacent(g,player,x,y) == 0
-       && g->players[player - 1].number_of_areas == g->max_areas) {
+    //Rozbijamy obszar należący do old_player_num na obszary powstałe
+    //po usunięciu pola (x,y)
+    uint32_t roots[4];
+    int Num_of_unique_areas_after_gold = DetachField(g,x,y,roots);
+    if(Num_of_unique_areas_after_gold < 0) {
+        JournalCancelMove(g);
         return false;
     }
 
-    uint32_t old_player_num = g->board[x][y].player_number;
-
-    //Rozbijamy obszary należące do old_player_num na pojedyńcze elementy
-    RemoveUnionOnAdjacent(g,old_player_num,x,y);
-    RemoveVisited(g,old_player_num,x,y);
-
-    //Zmieniamy parametry miejsca (x,y) na planszy na podstawowe.
-    //Co może podzielić istniejący obszar na wiele obszarów.
-    ResetBoardElement(g,x,y);
-
-    //Łączymy elementy w nowo powstałe obszary za pomocą Union-Find
-    UnionNewAreas(g,old_player_num,x,y);
-
-    int Num_of_unique_areas_after_gold = NumOfUniqueAreas(g,old_player_num,x,y);
-
     uint32_t New_number_of_areas =
             Num_of_unique_areas_after_gold - 1
             + g->players[old_player_num - 1].number_of_areas;
 
 
-    //Jeśli podział obszaru jest nielegalny cofamy zmiany
-    //po czym scalamy nowe obszary w jeden.
+    //Jeśli podział obszaru jest nielegalny cofamy zmiany.
     if(New_number_of_areas > g->max_areas) {
-        g->board[x][y].player_number = old_player_num;
-        UnionAdjacent(g,old_player_num,x,y);
+        AttachField(g,x,y,old_player_num,roots,
+                    Num_of_unique_areas_after_gold);
+        JournalCancelMove(g);
         return false;
-    } else {
-        g->board[x][y].player_number = old_player_num;
-        UnionAdjacent(g,old_player_num,x,y);
-        return true;
     }
+
+    JournalPlayer(g,old_player_num);
+    g->players[old_player_num - 1].number_of_areas = New_number_of_areas;
+    g->players[old_player_num - 1].busy_fields--;
+    g->free_fields_under_max_areas++;
+    FieldFreed(g,old_player_num,x,y);
+
+    //Stawiamy pionek gracza o numerze player w miejscu (x,y),
+    //co zawsze się udaje, bo wcześniej sprawdziliśmy liczbę jego obszarów
+    PlaceField(g,player,x,y);
+    JournalPlayer(g,player);
+    g->players[player - 1].gold_possible = false;
+    ActiveChanged(g);
+
+    return true;
 }
 
 bool gamma_golden_possible(gamma_t *g, uint32_t player) {
-
-
+    STATS_TIME(STATS_API_GOLDEN_POSSIBLE);
     if(g == NULL || player == 0 || player > g->number_of_players) {
         return false;
     }
-    if(g->players[player - 1].gold_possible) {
-        for(uint32_t i = 0; i < g->width; i++) {
-            for(uint32_t j = 0; j < g->height; j++) {
-                if(g->board[i][j].player_number != 0 && g->board[i][j].player_number != player) {
-                    if(TestForGolden(g,i,j,player)) {
-                        return true;
-                    }
-                }
-            }
-        }
+    if(!g->players[player - 1].gold_possible) {
+        return false;
     }
 
-    return false;
+    return CachedGoldenTarget(g,player);
+}
+
+bool gamma_set_query_threads(gamma_t *g, uint32_t threads) {
+    if(g == NULL || threads == 0 || threads > GAMMA_MAX_QUERY_THREADS) {
+        return false;
+    }
+    g->query_threads = threads;
+    return true;
 }
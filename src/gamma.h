@@ -10,7 +10,9 @@
 #define GAMMA_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 /**
  * Struktura przechowująca stan gry.
@@ -26,18 +28,115 @@ typedef struct gamma gamma_t;
  * @param[in] areas   – maksymalna liczba obszarów,
  *                      jakie może zająć jeden gracz.
  * @return Wskaźnik na utworzoną strukturę lub NULL, gdy nie udało się
- * zaalokować pamięci lub któryś z parametrów jest niepoprawny.
+ * zaalokować pamięci lub któryś z parametrów jest niepoprawny (również gdy
+ * plansza ma więcej niż 2^32 - 1 pól).
  */
 gamma_t* gamma_new(uint32_t width, uint32_t height,
                    uint32_t players, uint32_t areas);
 
 /** @brief Usuwa strukturę przechowującą stan gry.
- * Usuwa z pamięci strukturę wskazywaną przez @p g.
+ * Usuwa z pamięci strukturę wskazywaną przez @p g. Pamięć gry utworzonej
+ * przez @ref gamma_new_in wraca do jej areny.
  * Nic nie robi, jeśli wskaźnik ten ma wartość NULL.
  * @param[in] g       – wskaźnik na usuwaną strukturę.
  */
 void gamma_delete(gamma_t *g);
 
+/**
+ * Arena, z której gry biorą pamięć i do której ją oddają po usunięciu.
+ */
+typedef struct gamma_arena gamma_arena;
+
+/** @brief Tworzy pustą arenę.
+ * Arena nie jest bezpieczna wątkowo: wszystkie gry utworzone z jednej areny
+ * (razem z ich kopiami) muszą być używane i usuwane przez jeden wątek naraz.
+ * @return Wskaźnik na arenę lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+gamma_arena* gamma_arena_new(void);
+
+/** @brief Usuwa arenę i zwalnia całą jej pamięć.
+ * Wszystkie gry utworzone z areny muszą być wcześniej usunięte.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] arena   – wskaźnik na usuwaną arenę.
+ */
+void gamma_arena_delete(gamma_arena *arena);
+
+/** @brief Tworzy strukturę przechowującą stan gry w pamięci z areny.
+ * Działa jak @ref gamma_new, ale cała pamięć gry, również alokowana
+ * później przez ruchy, dziennik i kopie gry, pochodzi z areny @p arena,
+ * a po usunięciu gry jest w niej ponownie używana.
+ * @param[in,out] arena – arena lub NULL, wtedy działa jak @ref gamma_new,
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz.
+ * @return Wskaźnik na utworzoną strukturę lub NULL, tak jak @ref gamma_new.
+ */
+gamma_t* gamma_new_in(gamma_arena *arena, uint32_t width, uint32_t height,
+                      uint32_t players, uint32_t areas);
+
+/**
+ * Pula gier o jednakowych parametrach, ponownie używanych po zwolnieniu.
+ */
+typedef struct gamma_pool gamma_pool;
+
+/** @brief Tworzy pustą pulę gier o podanych parametrach.
+ * Pula nie jest bezpieczna wątkowo: gry z jednej puli (razem z ich kopiami)
+ * muszą być pobierane, używane i zwalniane przez jeden wątek naraz.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów,
+ *                      jakie może zająć jeden gracz.
+ * @return Wskaźnik na pulę lub NULL, gdy nie udało się zaalokować pamięci
+ * lub któryś z parametrów jest niepoprawny, tak jak w @ref gamma_new.
+ */
+gamma_pool* gamma_pool_new(uint32_t width, uint32_t height,
+                           uint32_t players, uint32_t areas);
+
+/** @brief Pobiera z puli grę w stanie początkowym.
+ * Stan gry, razem z buforami używanymi przez ruchy, leży w jednym miejscu
+ * większego bloku pamięci puli. Poza blokiem alokowane są tylko struktury
+ * tworzone przy pierwszym użyciu: dziennik ruchów, indeks legalnych ruchów
+ * (@ref gamma_legal_moves) i zbiór graczy, którzy mogą wykonać ruch
+ * (@ref gamma_next_active_player); są one zwalniane przy oddaniu gry do
+ * puli. Zwolnione miejsca są przywracane
+ * do stanu początkowego jednym przejściem po planszy, bez alokowania
+ * pamięci. Gra zachowuje się tak jak utworzona przez @ref gamma_new.
+ * @param[in,out] pool – wskaźnik na pulę.
+ * @return Wskaźnik na grę lub NULL, gdy nie udało się zaalokować pamięci
+ * lub @p pool ma wartość NULL.
+ */
+gamma_t* gamma_pool_acquire(gamma_pool *pool);
+
+/** @brief Oddaje grę pobraną z puli.
+ * Działa tak samo jak @ref gamma_delete, które dla gier z puli również
+ * oddaje je do puli. Miejsce gry może zostać ponownie użyte, gdy usunięte
+ * zostaną też wszystkie kopie gry utworzone przez @ref gamma_clone.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] g       – wskaźnik na grę pobraną z puli.
+ */
+void gamma_pool_release(gamma_t *g);
+
+/** @brief Usuwa pulę i zwalnia całą jej pamięć.
+ * Wszystkie gry pobrane z puli i ich kopie muszą być wcześniej oddane.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in] pool    – wskaźnik na usuwaną pulę.
+ */
+void gamma_pool_delete(gamma_pool *pool);
+
+/** @brief Tworzy kopię stanu gry.
+ * Kopia i gra @p g są dalej niezależne. Plansza nie jest kopiowana od razu:
+ * obie gry współdzielą jej fragmenty, dopóki któraś z nich ich nie zmieni.
+ * Dziennik ruchów nie jest kopiowany. Kopię usuwa się funkcją
+ * @ref gamma_delete, niezależnie od gry @p g.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na kopię lub NULL, gdy nie udało się zaalokować
+ * pamięci lub @p g ma wartość NULL.
+ */
+gamma_t* gamma_clone(gamma_t *g);
+
 /** @brief Wykonuje ruch.
  * Ustawia pionek gracza @p player na polu (@p x, @p y).
  * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
@@ -68,6 +167,170 @@ bool gamma_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
  */
 bool gamma_golden_move(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
+/**
+ * @brief Współrzędne pola planszy.
+ */
+typedef struct gamma_field {
+    uint32_t x;   /**< numer kolumny */
+    uint32_t y;   /**< numer wiersza */
+} gamma_field;
+
+/** @brief Wyznacza pola, na których gracz może wykonać zwykły ruch.
+ * Przy pierwszym wywołaniu dla gry budowany jest indeks wolnych pól
+ * i wolnych pól sąsiadujących z każdym graczem, aktualizowany potem przez
+ * @ref gamma_move i @ref gamma_golden_move, więc kolejne wywołania nie
+ * przeglądają planszy. Kolejność pól jest nieokreślona.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[out] moves  – tablica na pola, może mieć wartość NULL, gdy
+ *                      @p capacity jest równe 0,
+ * @param[in] capacity – rozmiar tablicy @p moves.
+ * @return Liczba pól, na których gracz może wykonać ruch; do @p moves
+ * wpisywanych jest co najwyżej @p capacity pierwszych z nich. Zero, gdy
+ * któryś z parametrów jest niepoprawny.
+ */
+uint64_t gamma_legal_moves(gamma_t *g, uint32_t player, gamma_field *moves,
+                           uint64_t capacity);
+
+/** @brief Losuje pole, na którym gracz może wykonać zwykły ruch.
+ * Wszystkie takie pola są jednakowo prawdopodobne. Korzysta z indeksu
+ * opisanego przy @ref gamma_legal_moves, więc działa w czasie stałym.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new,
+ * @param[in,out] rng – stan generatora liczb pseudolosowych (splitmix64),
+ *                      dowolna początkowa wartość,
+ * @param[out] x      – numer kolumny wylosowanego pola,
+ * @param[out] y      – numer wiersza wylosowanego pola.
+ * @return Wartość @p true, jeśli gracz może wykonać jakikolwiek ruch,
+ * a @p false, gdy nie może lub któryś z parametrów jest niepoprawny.
+ */
+bool gamma_random_legal_move(gamma_t *g, uint32_t player, uint64_t *rng,
+                             uint32_t *x, uint32_t *y);
+
+/** @brief Największa liczba wątków, której może używać
+ * @ref gamma_bot_suggest. */
+#define GAMMA_BOT_MAX_THREADS 256
+
+/**
+ * @brief Ustawienia bota wybierającego ruch.
+ */
+typedef struct gamma_bot_options {
+    uint32_t threads;   /**< liczba wątków, liczba dodatnia niewiększa od
+                          *  @ref GAMMA_BOT_MAX_THREADS */
+    uint64_t playouts;  /**< łączna liczba rozgrywek, 0 bez limitu */
+    uint64_t time_ms;   /**< limit czasu w milisekundach, 0 bez limitu */
+    uint64_t seed;      /**< ziarno generatora liczb pseudolosowych */
+} gamma_bot_options;
+
+/**
+ * @brief Ruch wybrany przez bota.
+ */
+typedef struct gamma_bot_move {
+    uint32_t x;         /**< numer kolumny */
+    uint32_t y;         /**< numer wiersza */
+    bool golden;        /**< czy jest to złoty ruch */
+    uint64_t playouts;  /**< liczba rozegranych rozgrywek */
+} gamma_bot_move;
+
+/** @brief Wybiera ruch gracza przeszukiwaniem drzewa gry metodą Monte Carlo.
+ * Każdy wątek buduje własne drzewo na kopii gry (@ref gamma_clone)
+ * i rozgrywa z jego liści losowe gry do końca zwykłymi ruchami, po
+ * których kopia wraca do stanu wyjściowego przez cofnięcie ruchów
+ * w dzienniku. W drzewie gracze ruszają się kolejno, pomijając tych, którzy
+ * nie mogą wykonać zwykłego ruchu; złote ruchy są rozważane tylko jako
+ * pierwszy ruch i tylko na planszach do 65536 pól. Wygrywa gracz z
+ * największą liczbą zajętych pól. Wybierany jest ruch najczęściej
+ * odwiedzany łącznie we wszystkich drzewach.
+ * Przeszukiwanie kończy się po wyczerpaniu liczby rozgrywek lub czasu,
+ * ale każdy wątek wykonuje co najmniej jedną rozgrywkę. Gra utworzona
+ * przez @ref gamma_new_in jest przeszukiwana jednym wątkiem.
+ * Stan gry @p g się nie zmienia.
+ * @param[in,out] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player      – numer gracza, liczba dodatnia niewiększa od
+ *                          wartości @p players z funkcji @ref gamma_new,
+ * @param[in] options     – ustawienia bota; co najmniej jeden z limitów
+ *                          musi być niezerowy,
+ * @param[out] move       – wybrany ruch.
+ * @return Wartość @p true, jeśli ruch został wybrany, a @p false, gdy
+ * gracz nie może wykonać żadnego ruchu, nie udało się zaalokować pamięci
+ * lub któryś z parametrów jest niepoprawny.
+ */
+bool gamma_bot_suggest(gamma_t *g, uint32_t player,
+                       const gamma_bot_options *options,
+                       gamma_bot_move *move);
+
+/** @brief Największa liczba pól planszy, na której można rozwiązać grę
+ * funkcją @ref gamma_solve. */
+#define GAMMA_SOLVE_MAX_FIELDS 64
+
+/** @brief Największa liczba graczy w grze rozwiązywanej funkcją
+ * @ref gamma_solve. */
+#define GAMMA_SOLVE_MAX_PLAYERS 4
+
+/** @brief Największa liczba wątków, której może używać @ref gamma_solve. */
+#define GAMMA_SOLVE_MAX_THREADS 256
+
+/**
+ * @brief Ustawienia rozwiązywania gry.
+ */
+typedef struct gamma_solve_options {
+    uint32_t threads;     /**< liczba wątków, liczba dodatnia niewiększa od
+                            *  @ref GAMMA_SOLVE_MAX_THREADS */
+    uint32_t table_bits;  /**< tablica transpozycji ma 2^table_bits wpisów
+                            *  po 16 bajtów, najwyżej 30; 0 oznacza 20 */
+    uint64_t max_nodes;   /**< limit odwiedzonych pozycji, 0 bez limitu */
+} gamma_solve_options;
+
+/**
+ * @brief Wynik rozwiązania gry.
+ */
+typedef struct gamma_solve_result {
+    bool solved;        /**< czy grę rozwiązano w limicie pozycji; gdy nie,
+                          *  pozostałe pola poza @p nodes są
+                          *  nieokreślone */
+    uint32_t busy;      /**< liczba pól gracza na koniec gry przy
+                          *  optymalnej grze */
+    bool has_move;      /**< czy któryś z graczy może wykonać ruch; gdy nie,
+                          *  pozostałe pola poza @p busy i @p nodes są
+                          *  nieokreślone */
+    uint32_t player;    /**< gracz wykonujący pierwszy ruch */
+    uint32_t x;         /**< numer kolumny optymalnego pierwszego ruchu */
+    uint32_t y;         /**< numer wiersza optymalnego pierwszego ruchu */
+    bool golden;        /**< czy optymalny pierwszy ruch jest złoty */
+    uint64_t nodes;     /**< liczba odwiedzonych pozycji */
+} gamma_solve_result;
+
+/** @brief Rozwiązuje grę na małej planszy.
+ * Wyznacza największą liczbę pól, jaką gracz @p player może mieć na koniec
+ * gry, gdy wszyscy pozostali gracze grają przeciw niemu, oraz pierwszy ruch
+ * optymalnej gry. Gracze wykonują ruchy kolejno, zaczynając od gracza
+ * @p to_move; gracz, który nie może wykonać ani zwykłego, ani złotego
+ * ruchu, jest pomijany, a gra kończy się, gdy nikt nie może wykonać ruchu.
+ * Pozycje są zapamiętywane w tablicy transpozycji współdzielonej przez
+ * wątki bez blokad, indeksowanej 64-bitowym kluczem pozycji i sprawdzanej
+ * drugim, niezależnym kluczem. Z ruchów o równym wyniku wybierany jest
+ * pierwszy w kolejności: zwykłe ruchy przed złotymi, a w każdym rodzaju
+ * według indeksu pola y * szerokość + x, więc wynik nie zależy od liczby
+ * wątków. Stan gry @p g się nie zmienia.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry, z
+ *                      planszą o co najwyżej @ref GAMMA_SOLVE_MAX_FIELDS
+ *                      polach i co najwyżej @ref GAMMA_SOLVE_MAX_PLAYERS
+ *                      graczach,
+ * @param[in] player  – numer gracza, którego wynik jest liczony,
+ * @param[in] to_move – numer gracza wykonującego następny ruch,
+ * @param[in] options – ustawienia rozwiązywania,
+ * @param[out] result – wynik.
+ * @return Wartość @p true, jeśli gra została przeszukana, także gdy
+ * przekroczono limit pozycji, co podaje @p result->solved, a @p false, gdy
+ * nie udało się zaalokować pamięci lub któryś z parametrów jest
+ * niepoprawny.
+ */
+bool gamma_solve(gamma_t *g, uint32_t player, uint32_t to_move,
+                 const gamma_solve_options *options,
+                 gamma_solve_result *result);
+
 /** @brief Podaje liczbę pól zajętych przez gracza.
  * Podaje liczbę pól zajętych przez gracza @p player.
  * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
@@ -102,6 +365,51 @@ uint64_t gamma_free_fields(gamma_t *g, uint32_t player);
  */
 bool gamma_golden_possible(gamma_t *g, uint32_t player);
 
+/** @brief Podaje następnego gracza, który może wykonać ruch.
+ * Szuka wśród graczy o numerach @p player + 1, @p player + 2, ...,
+ * a po ostatnim graczu wraca do gracza 1, kończąc na samym @p player.
+ * Gracz może wykonać ruch, jeśli @ref gamma_free_fields jest dodatnie lub
+ * @ref gamma_golden_possible jest prawdziwe. Przy pierwszym wywołaniu gra
+ * zaczyna utrzymywać zbiór graczy, którzy mogą wykonać ruch: gracze, którzy
+ * na pewno nie odzyskają ruchu, są pomijani bez sprawdzania, a przeglądanie
+ * planszy w poszukiwaniu złotego ruchu jest powtarzane tylko po ruchach,
+ * które mogły zmienić jego wynik. Kolejne wywołania dla kolejnych tur
+ * działają w zamortyzowanym czasie stałym.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, po którym szukamy następnego, lub 0,
+ *                      aby zacząć od gracza 1.
+ * @return Numer gracza lub 0, gdy żaden gracz nie może wykonać ruchu lub
+ * któryś z parametrów jest niepoprawny.
+ */
+uint32_t gamma_next_active_player(gamma_t *g, uint32_t player);
+
+/** @brief Sprawdza, czy gra się skończyła.
+ * Gra kończy się, gdy żaden gracz nie może wykonać ruchu
+ * (@ref gamma_next_active_player).
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli żaden gracz nie może wykonać ruchu lub
+ * @p g ma wartość NULL, a @p false w przeciwnym przypadku.
+ */
+bool gamma_game_over(gamma_t *g);
+
+/** @brief Największa liczba wątków, którą można ustawić funkcją
+ * @ref gamma_set_query_threads. */
+#define GAMMA_MAX_QUERY_THREADS 256
+
+/** @brief Ustawia liczbę wątków przeglądających planszę w zapytaniach.
+ * Gdy jest większa od 1, @ref gamma_golden_possible dzieli duże plansze
+ * na pasy wierszy przeglądane równolegle i kończy się, gdy tylko któryś
+ * wątek znajdzie pole złotego ruchu. Wyniki są takie same jak przy
+ * przeglądaniu jednowątkowym. Nowe gry przeglądają planszę jednym wątkiem,
+ * a kopie gry przejmują liczbę wątków od kopiowanej gry.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] threads – liczba wątków, liczba dodatnia niewiększa od
+ *                      @ref GAMMA_MAX_QUERY_THREADS.
+ * @return Wartość @p true, jeśli liczba wątków została ustawiona, a @p false,
+ * gdy parametry są niepoprawne.
+ */
+bool gamma_set_query_threads(gamma_t *g, uint32_t threads);
+
 /** @brief Daje napis opisujący stan planszy.
  * Alokuje w pamięci bufor, w którym umieszcza napis zawierający tekstowy
  * opis aktualnego stanu planszy. Przykład znajduje się w pliku gamma_test.c.
@@ -112,4 +420,116 @@ bool gamma_golden_possible(gamma_t *g, uint32_t player);
  */
 char* gamma_board(gamma_t *g);
 
+/** @brief Typ funkcji odbierającej kolejne fragmenty napisu opisującego
+ * planszę.
+ * Funkcja dostaje fragment o podanej długości (bez znaku '\0') i wskaźnik
+ * @p context przekazany do @ref gamma_board_stream; zwraca @p false, aby
+ * przerwać wypisywanie.
+ */
+typedef bool (*gamma_board_writer)(const char *chunk, size_t length,
+                                   void *context);
+
+/** @brief Przekazuje napis opisujący stan planszy we fragmentach.
+ * Napis jest taki sam jak wynik funkcji @ref gamma_board, ale nie jest
+ * składany w całości w pamięci: fragmenty mają co najwyżej kilkadziesiąt
+ * kilobajtów i kończą się na granicy opisu pola.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] write   – funkcja odbierająca fragmenty,
+ * @param[in] context – wskaźnik przekazywany funkcji @p write.
+ * @return Wartość @p true, jeśli cały napis został przekazany, a @p false,
+ * gdy funkcja @p write przerwała wypisywanie lub któryś z parametrów
+ * @p g, @p write ma wartość NULL.
+ */
+bool gamma_board_stream(gamma_t *g, gamma_board_writer write, void *context);
+
+/** @brief Wypisuje napis opisujący stan planszy do pliku.
+ * Działa jak @ref gamma_board_stream, dopisując fragmenty do pliku @p file.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] file    – plik otwarty do zapisu.
+ * @return Wartość @p true, jeśli cały napis został zapisany, a @p false,
+ * gdy zapis się nie powiódł lub któryś z parametrów ma wartość NULL.
+ */
+bool gamma_board_write(gamma_t *g, FILE *file);
+
+/** @brief Zapisuje pełny stan gry do pliku binarnego.
+ * Zapisywane są pola planszy razem ze strukturą obszarów Union-Find oraz
+ * liczniki i możliwość złotego ruchu każdego gracza; dziennik ruchów nie
+ * jest zapisywany. Plik jest najpierw tworzony pod nazwą z przyrostkiem
+ * ".tmp", a potem zastępuje plik @p path, więc można nadpisać plik, z którego
+ * wczytano trwającą grę. Format zależy od architektury komputera.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] path    – ścieżka do tworzonego pliku.
+ * @return Wartość @p true, jeśli stan został zapisany, a @p false, gdy nie
+ * udało się zapisać pliku lub któryś z parametrów ma wartość NULL.
+ */
+bool gamma_save(gamma_t *g, const char *path);
+
+/** @brief Wczytuje stan gry zapisany przez @ref gamma_save.
+ * Plik jest odwzorowywany w pamięci, więc plansza nie jest kopiowana ani
+ * czytana przy wczytywaniu, a zmiany wczytanej gry nie trafiają do pliku.
+ * Sprawdzany jest tylko nagłówek i rozmiar pliku. Numery graczy i ojcowie
+ * Union-Find spoza zakresu są sprawdzane dopiero przy użyciu pola, więc
+ * uszkodzona plansza daje co najwyżej niepoprawny stan gry, ale nie błąd
+ * dostępu do pamięci. Plik nie może być zmieniany w inny sposób niż przez
+ * @ref gamma_save, dopóki gra jest używana.
+ * @param[in] path    – ścieżka do wczytywanego pliku.
+ * @return Wskaźnik na strukturę przechowującą stan gry lub NULL, gdy nie
+ * udało się otworzyć pliku, plik nie został zapisany przez @ref gamma_save
+ * w tej samej wersji formatu, ma uszkodzony nagłówek lub nie udało się
+ * zaalokować pamięci.
+ */
+gamma_t* gamma_load(const char *path);
+
+/** @brief Włącza lub wyłącza dziennik ruchów.
+ * Gdy dziennik jest włączony, każdy wykonany ruch i złoty ruch można cofnąć
+ * funkcją @ref gamma_undo i powtórzyć funkcją @ref gamma_redo. Dziennik
+ * przechowuje jedynie poprzednie wartości zmienionych pól planszy i stanów
+ * graczy, więc cofnięcie ruchu trwa proporcjonalnie do liczby zmian, które
+ * ten ruch wprowadził. Wyłączenie dziennika usuwa zapisaną historię.
+ * Gdy w trakcie gry zabraknie pamięci na dziennik, jest on wyłączany.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] enable  – @p true, aby włączyć dziennik, @p false, aby go
+ *                      wyłączyć.
+ * @return Wartość @p true, jeśli operacja się powiodła, a @p false, gdy
+ * nie udało się zaalokować pamięci lub @p g ma wartość NULL.
+ */
+bool gamma_journal_enable(gamma_t *g, bool enable);
+
+/** @brief Cofa ostatni ruch zapisany w dzienniku.
+ * Przywraca stan gry sprzed ostatniego wykonanego ruchu lub złotego ruchu.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli ruch został cofnięty, a @p false, gdy
+ * dziennik jest wyłączony lub nie ma ruchu do cofnięcia.
+ */
+bool gamma_undo(gamma_t *g);
+
+/** @brief Powtarza ostatnio cofnięty ruch.
+ * Wykonanie nowego ruchu po cofnięciu usuwa możliwość powtórzenia
+ * cofniętych ruchów.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli ruch został powtórzony, a @p false, gdy
+ * dziennik jest wyłączony lub nie ma ruchu do powtórzenia.
+ */
+bool gamma_redo(gamma_t *g);
+
+/** @brief Przekazuje opis liczników i histogramów pracy silnika.
+ * Liczniki są wspólne dla wszystkich gier i zbierane tylko w wersji
+ * skompilowanej z opcją CMake GAMMA_STATS. Każda linia opisuje jeden
+ * licznik lub histogram; histogram ma też linie z liczbą wartości
+ * w przedziałach [2^k, 2^(k+1)).
+ * @param[in] write   – funkcja odbierająca fragmenty opisu,
+ * @param[in] context – wskaźnik przekazywany funkcji @p write.
+ * @return Wartość @p true, jeśli cały opis został przekazany, a @p false,
+ * gdy funkcja @p write przerwała wypisywanie, ma wartość NULL lub silnik
+ * skompilowano bez liczników.
+ */
+bool gamma_stats_stream(gamma_board_writer write, void *context);
+
+/** @brief Wypisuje opis liczników i histogramów pracy silnika do pliku.
+ * Działa jak @ref gamma_stats_stream, dopisując fragmenty do pliku @p file.
+ * @param[in] file    – plik otwarty do zapisu.
+ * @return Wartość @p true, jeśli cały opis został zapisany.
+ */
+bool gamma_stats_write(FILE *file);
+
 #endif /* GAMMA_H */
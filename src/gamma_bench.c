@@ -0,0 +1,1011 @@
+/** @file
+ * Testy wydajnościowe silnika gry gamma
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "union_find_gamma.h"
+#include "scan_gamma.h"
+
+/** @brief Podaje aktualny czas w sekundach.
+ * @return Czas zegara monotonicznego w sekundach.
+ */
+static double Now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/** @brief Wyznacza spiralę szerokości jednego pola pokrywającą planszę.
+ * Spirala zaczyna się w lewym dolnym rogu, a kolejne jej zwoje są oddzielone
+ * jednym wolnym polem.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[out] length – długość spirali.
+ * @return Tablica indeksów pól spirali w kolejności przechodzenia lub NULL,
+ * gdy nie udało się zaalokować pamięci.
+ */
+static uint32_t* Spiral(uint32_t width, uint32_t height, uint64_t *length) {
+    uint64_t fields = (uint64_t)width * height;
+    uint32_t *path = malloc(sizeof(uint32_t) * fields);
+    bool *on_path = calloc(fields, sizeof(bool));
+    if(path == NULL || on_path == NULL) {
+        free(path);
+        free(on_path);
+        return NULL;
+    }
+
+    const int dx[4] = {1, 0, -1, 0};
+    const int dy[4] = {0, 1, 0, -1};
+    int64_t x = 0, y = 0;
+    int direction = 0;
+    int turns = 0;
+    uint64_t n = 0;
+
+    path[n++] = 0;
+    on_path[0] = true;
+
+    // idziemy prosto dopóki pole dwa kroki dalej nie należy do spirali,
+    // w przeciwnym przypadku skręcamy; dwa skręty z rzędu kończą spiralę
+    while(turns < 2) {
+        int64_t nx = x + dx[direction], ny = y + dy[direction];
+        int64_t fx = nx + dx[direction], fy = ny + dy[direction];
+        bool inside = nx >= 0 && ny >= 0 && nx < width && ny < height;
+        bool far_inside = fx >= 0 && fy >= 0 && fx < width && fy < height;
+        if(inside && !on_path[ny * width + nx]
+           && !(far_inside && on_path[fy * width + fx])) {
+            x = nx;
+            y = ny;
+            path[n++] = (uint32_t)(y * width + x);
+            on_path[y * width + x] = true;
+            turns = 0;
+        } else {
+            direction = (direction + 1) % 4;
+            turns++;
+        }
+    }
+
+    free(on_path);
+    *length = n;
+    return path;
+}
+
+/** @brief Mierzy koszt Union-Find na spirali pokrywającej planszę.
+ * Gracz 1 zajmuje spiralę w kolejności przechodzenia, gracz 2 wypełnia
+ * resztę planszy wierszami. Następnie szukany jest korzeń każdego pola spirali.
+ * @param[in] side – długość boku planszy, liczba dodatnia.
+ */
+static void SpiralBenchmark(uint32_t side) {
+    uint64_t length;
+    uint32_t *path = Spiral(side, side, &length);
+    gamma_t *g = gamma_new(side, side, 2, side * side);
+    if(path == NULL || g == NULL) {
+        fprintf(stderr, "spiral %ux%u: out of memory\n", side, side);
+        free(path);
+        gamma_delete(g);
+        return;
+    }
+
+    double start = Now();
+    for(uint64_t k = 0; k < length; k++) {
+        gamma_move(g, 1, path[k] % side, path[k] / side);
+    }
+    double path_time = Now() - start;
+
+    start = Now();
+    uint64_t wall = 0;
+    for(uint32_t y = 0; y < side; y++) {
+        for(uint32_t x = 0; x < side; x++) {
+            wall += gamma_move(g, 2, x, y);
+        }
+    }
+    double wall_time = Now() - start;
+
+    // najdłuższa ścieżka do korzenia przed skracaniem ścieżek przez Root
+    uint64_t max_depth = 0;
+    for(uint64_t k = 0; k < length; k++) {
+        uint64_t depth = 0;
+        for(uint32_t i = path[k]; Element(g,i)->parent != i;
+            i = Element(g,i)->parent) {
+            depth++;
+        }
+        if(depth > max_depth) {
+            max_depth = depth;
+        }
+    }
+
+    start = Now();
+    uint64_t checksum = 0;
+    for(uint64_t k = 0; k < length; k++) {
+        checksum += Root(g, path[k]);
+    }
+    double root_time = Now() - start;
+
+    // złoty ruch w środku spirali dzieli obszar gracza 1 na dwa obszary
+    uint32_t middle = path[length / 2];
+    start = Now();
+    bool golden = gamma_golden_move(g, 2, middle % side, middle / side);
+    double golden_time = Now() - start;
+
+    printf("spiral %ux%u: path %lu fields, %.1f ns/move; "
+           "wall %lu fields, %.1f ns/move\n",
+           side, side, length, path_time * 1e9 / length,
+           wall, wall_time * 1e9 / (wall > 0 ? wall : 1));
+    printf("spiral %ux%u: max depth %lu, %.1f ns/Root (checksum %lu)\n",
+           side, side, max_depth, root_time * 1e9 / length, checksum);
+    printf("spiral %ux%u: golden move %s in %.1f ms, areas %u/%u\n",
+           side, side, golden ? "done" : "failed", golden_time * 1e3,
+           g->players[0].number_of_areas, g->players[1].number_of_areas);
+
+    free(path);
+    gamma_delete(g);
+}
+
+/** @brief Rozgrywa krótką grę na planszy @p side x @p side.
+ * @param[in,out] g    – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] side     – długość boku planszy,
+ * @param[in,out] seed – stan generatora liczb pseudolosowych.
+ * @return Liczba wykonanych ruchów.
+ */
+static uint64_t ShortGame(gamma_t *g, uint32_t side, unsigned *seed) {
+    uint64_t moves = 0;
+    for(uint32_t k = 0; k < side * side / 2; k++) {
+        *seed = *seed * 1103515245 + 12345;
+        moves += gamma_move(g, 1 + (*seed >> 8) % 4, (*seed >> 12) % side,
+                            (*seed >> 20) % side);
+    }
+    return moves;
+}
+
+/** @brief Mierzy koszt tworzenia i usuwania wielu krótkich gier o tych
+ * samych parametrach przez gamma_new i gamma_delete oraz przez pulę gier.
+ * @param[in] side    – długość boku planszy, liczba dodatnia,
+ * @param[in] games   – liczba gier.
+ */
+static void ChurnBenchmark(uint32_t side, uint32_t games) {
+    unsigned seed = 1;
+    uint64_t moves = 0;
+    double start = Now();
+    for(uint32_t k = 0; k < games; k++) {
+        gamma_t *g = gamma_new(side, side, 4, 4);
+        if(g == NULL) {
+            fprintf(stderr, "churn %ux%u: out of memory\n", side, side);
+            return;
+        }
+        moves += ShortGame(g, side, &seed);
+        gamma_delete(g);
+    }
+    double new_time = Now() - start;
+
+    gamma_pool *pool = gamma_pool_new(side, side, 4, 4);
+    seed = 1;
+    start = Now();
+    for(uint32_t k = 0; k < games; k++) {
+        gamma_t *g = gamma_pool_acquire(pool);
+        if(g == NULL) {
+            fprintf(stderr, "churn %ux%u: out of memory\n", side, side);
+            gamma_pool_delete(pool);
+            return;
+        }
+        moves -= ShortGame(g, side, &seed);
+        gamma_pool_release(g);
+    }
+    double pool_time = Now() - start;
+    gamma_pool_delete(pool);
+
+    printf("churn %ux%u: gamma_new %.1f ns/game, pool %.1f ns/game%s\n",
+           side, side, new_time * 1e9 / games, pool_time * 1e9 / games,
+           moves == 0 ? "" : " (results differ)");
+}
+
+/** @brief Rozgrywa losową grę do końca: gracze na zmianę wykonują ruch na
+ * losowym polu, na którym mogą go wykonać, dopóki któryś z nich może.
+ * @param[in,out] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] players     – liczba graczy,
+ * @param[in] indexed     – czy pole losować przez gamma_random_legal_move,
+ *                          czy próbując gamma_move na losowych polach,
+ * @param[in,out] seed    – stan generatora liczb pseudolosowych.
+ * @return Liczba wykonanych ruchów.
+ */
+static uint64_t Playout(gamma_t *g, uint32_t players, bool indexed,
+                        uint64_t *seed) {
+    uint64_t moves = 0;
+    for(uint32_t stuck = 0; stuck < players;) {
+        stuck = 0;
+        for(uint32_t player = 1; player <= players; player++) {
+            uint32_t x, y;
+            if(indexed) {
+                if(!gamma_random_legal_move(g, player, seed, &x, &y)) {
+                    stuck++;
+                    continue;
+                }
+                gamma_move(g, player, x, y);
+            } else {
+                if(gamma_free_fields(g, player) == 0) {
+                    stuck++;
+                    continue;
+                }
+                do {
+                    *seed = *seed * 6364136223846793005ULL + 1;
+                    x = (*seed >> 33) % g->width;
+                    y = (*seed >> 11) % g->height;
+                } while(!gamma_move(g, player, x, y));
+            }
+            moves++;
+        }
+    }
+    return moves;
+}
+
+/** @brief Mierzy czas losowych gier rozgrywanych do końca, gdy pole ruchu
+ * jest losowane przez próby gamma_move i przez gamma_random_legal_move.
+ * @param[in] side    – długość boku planszy, liczba dodatnia,
+ * @param[in] games   – liczba gier.
+ */
+static void PlayoutBenchmark(uint32_t side, uint32_t games) {
+    gamma_pool *pool = gamma_pool_new(side, side, 4, 3);
+    double times[2];
+    uint64_t moves[2] = {0, 0};
+    for(int indexed = 0; indexed < 2; indexed++) {
+        uint64_t seed = 1;
+        double start = Now();
+        for(uint32_t k = 0; k < games; k++) {
+            gamma_t *g = gamma_pool_acquire(pool);
+            if(g == NULL) {
+                fprintf(stderr, "playout %ux%u: out of memory\n", side, side);
+                gamma_pool_delete(pool);
+                return;
+            }
+            moves[indexed] += Playout(g, 4, indexed, &seed);
+            gamma_pool_release(g);
+        }
+        times[indexed] = Now() - start;
+    }
+    gamma_pool_delete(pool);
+
+    printf("playout %ux%u: probing %.1f ns/move, legal index %.1f ns/move\n",
+           side, side, times[0] * 1e9 / moves[0], times[1] * 1e9 / moves[1]);
+}
+
+/** @brief Podaje następnego gracza, który może wykonać ruch, sprawdzając
+ * kolejnych graczy przez @ref gamma_free_fields
+ * i @ref gamma_golden_possible.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] players – liczba graczy,
+ * @param[in] player  – numer gracza, po którym szukamy następnego, lub 0.
+ * @return Numer gracza lub 0, gdy nikt nie może wykonać ruchu.
+ */
+static uint32_t ScanNextPlayer(gamma_t *g, uint32_t players, uint32_t player) {
+    for(uint32_t k = 1; k <= players; k++) {
+        uint32_t next = (player + k - 1) % players + 1;
+        if(gamma_free_fields(g, next) > 0 || gamma_golden_possible(g, next)) {
+            return next;
+        }
+    }
+    return 0;
+}
+
+/** @brief Rozgrywa grę do końca; gracz bez zwykłego ruchu z szansą 1/8
+ * wykonuje złoty ruch na pierwszym możliwym polu od losowego, a w przeciwnym
+ * przypadku czeka, tak jak gracz trybu interaktywnego zachowujący złoty
+ * ruch na później.
+ * @param[in,out] g    – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] players  – liczba graczy,
+ * @param[in] active   – czy kolejnego gracza wyznacza
+ *                       @ref gamma_next_active_player, a nie
+ *                       @ref ScanNextPlayer,
+ * @param[in,out] seed – stan generatora liczb pseudolosowych.
+ * @return Liczba tur.
+ */
+static uint64_t Referee(gamma_t *g, uint32_t players, bool active,
+                        uint64_t *seed) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint64_t turns = 0;
+    for(uint32_t player = active ? gamma_next_active_player(g, 0)
+                                 : ScanNextPlayer(g, players, 0);
+        player != 0;
+        player = active ? gamma_next_active_player(g, player)
+                        : ScanNextPlayer(g, players, player)) {
+        uint32_t x, y;
+        if(gamma_random_legal_move(g, player, seed, &x, &y)) {
+            gamma_move(g, player, x, y);
+        } else if((*seed = *seed * 6364136223846793005ULL + 1) >> 61 == 0) {
+            uint64_t start = (*seed >> 11) % fields;
+            for(uint64_t k = 0; k < fields; k++) {
+                uint64_t i = (start + k) % fields;
+                if(gamma_golden_move(g, player, i % g->width, i / g->width)) {
+                    break;
+                }
+            }
+        }
+        turns++;
+    }
+    return turns;
+}
+
+/** @brief Mierzy koszt wyznaczania kolejnego gracza w grze rozgrywanej do
+ * końca: sprawdzanie wszystkich graczy w każdej turze i zbiór graczy, którzy
+ * mogą wykonać ruch, utrzymywany przez silnik.
+ * @param[in] side    – długość boku planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy,
+ * @param[in] games   – liczba gier.
+ */
+static void TurnBenchmark(uint32_t side, uint32_t players, uint32_t games) {
+    gamma_pool *pool = gamma_pool_new(side, side, players, 1);
+    double times[2];
+    uint64_t turns[2] = {0, 0};
+    for(int active = 0; active < 2; active++) {
+        uint64_t seed = 1;
+        double start = Now();
+        for(uint32_t k = 0; k < games; k++) {
+            gamma_t *g = gamma_pool_acquire(pool);
+            if(g == NULL) {
+                fprintf(stderr, "turns %ux%u: out of memory\n", side, side);
+                gamma_pool_delete(pool);
+                return;
+            }
+            turns[active] += Referee(g, players, active, &seed);
+            gamma_pool_release(g);
+        }
+        times[active] = Now() - start;
+    }
+    gamma_pool_delete(pool);
+
+    printf("turns %ux%u, %u players: scanning players %.1f ns/turn, "
+           "active players %.1f ns/turn\n", side, side, players,
+           times[0] * 1e9 / turns[0], times[1] * 1e9 / turns[1]);
+}
+
+/** @brief Mierzy liczbę rozgrywek bota na sekundę i na wątek w grze
+ * czterech graczy na planszy @p side x @p side, po kilku losowych ruchach
+ * każdego gracza, dla jednego wątku i dla liczby procesorów.
+ * @param[in] side     – długość boku planszy, liczba większa od 1,
+ * @param[in] playouts – liczba rozgrywek w jednym wyborze ruchu.
+ */
+static void BotBenchmark(uint32_t side, uint64_t playouts) {
+    gamma_t *g = gamma_new(side, side, 4, side);
+    if(g == NULL) {
+        return;
+    }
+    uint64_t seed = 1;
+    for(uint32_t k = 0; k < 4 * side; k++) {
+        uint32_t x, y;
+        uint32_t player = 1 + k % 4;
+        if(gamma_random_legal_move(g, player, &seed, &x, &y)) {
+            gamma_move(g, player, x, y);
+        }
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t most = online > 1 ? online : 1;
+    if(most > GAMMA_BOT_MAX_THREADS) {
+        most = GAMMA_BOT_MAX_THREADS;
+    }
+    printf("bot %ux%u, 4 players:", side, side);
+    const uint32_t counts[] = {1, most};
+    for(int k = 0; k < (most > 1 ? 2 : 1); k++) {
+        uint32_t threads = counts[k];
+        gamma_bot_options options = {.threads = threads,
+                                     .playouts = playouts};
+        gamma_bot_move move;
+        double start = Now();
+        bool done = gamma_bot_suggest(g, 1, &options, &move);
+        double time = Now() - start;
+        printf(" %u threads %.0f playouts/s per thread%s", threads,
+               move.playouts / time / threads, done ? "" : " (failed)");
+    }
+    printf("\n");
+    gamma_delete(g);
+}
+
+/** @brief Zlicza wolne pola sąsiadujące z polami gracza @p player,
+ * sprawdzając pola po kolei.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól.
+ */
+static uint64_t CountFieldByField(gamma_t *g, uint32_t player) {
+    uint64_t count = 0;
+    for(uint32_t y = 0; y < g->height; y++) {
+        for(uint32_t x = 0; x < g->width; x++) {
+            uint32_t neighbours[4];
+            int n = Neighbours(g, x, y, neighbours);
+            bool near = false;
+            for(int k = 0; k < n; k++) {
+                near = near || Owner(g, neighbours[k]) == player;
+            }
+            count += Owner(g, BoardIndex(g, x, y)) == 0 && near;
+        }
+    }
+    return count;
+}
+
+/** @brief Tworzy planszę, na której gracz 1 zajmuje pola w szachownicę,
+ * a gracz 2 ma jedyny obszar w prawym górnym rogu, otoczony polami gracza 3.
+ * Gracz 2 ma maksymalną liczbę obszarów, więc jedyne pola jego złotego
+ * ruchu leżą w ostatnim wierszu.
+ * @param[in] side    – długość boku planszy, liczba większa od 2.
+ * @return Wskaźnik na strukturę przechowującą stan gry lub NULL, gdy nie
+ * udało się zaalokować pamięci.
+ */
+static gamma_t* CornerBoard(uint32_t side) {
+    gamma_t *g = gamma_new(side, side, 3, side * side);
+    if(g == NULL) {
+        return NULL;
+    }
+    for(uint32_t y = 0; y + 2 < side; y++) {
+        for(uint32_t x = y % 2; x < side; x += 2) {
+            gamma_move(g, 1, x, y);
+        }
+    }
+    gamma_move(g, 2, side - 1, side - 1);
+    gamma_move(g, 3, side - 2, side - 1);
+    gamma_move(g, 3, side - 1, side - 2);
+    g->max_areas = g->players[1].number_of_areas;
+    return g;
+}
+
+/** @brief Mierzy przeglądanie całej planszy kolejnymi zestawami instrukcji:
+ * zliczanie wolnych pól sąsiadujących z graczem, szukanie pola złotego
+ * ruchu, gdy jedyne leży w ostatnim wierszu, i wypisywanie planszy.
+ * Sprawdza, czy wyniki wszystkich zestawów są zgodne z licznikami gry.
+ * @param[in] side    – długość boku planszy.
+ */
+static void ScanBenchmark(uint32_t side) {
+    gamma_t *g = CornerBoard(side);
+    if(g == NULL) {
+        return;
+    }
+
+    double start = Now();
+    uint64_t expected = CountFieldByField(g, 1);
+    double field_time = Now() - start;
+    printf("scan %ux%u: field by field %.2f ms\n", side, side,
+           field_time * 1e3);
+
+    static const char *names[] = {"scalar", "sse2", "avx2"};
+    scan_level best = ScanLevel();
+    for(scan_level level = SCAN_SCALAR; level <= SCAN_AVX2; level++) {
+        if(!SetScanLevel(level)) {
+            continue;
+        }
+        start = Now();
+        uint64_t count = CountAdjacentFree(g, 1);
+        double count_time = Now() - start;
+
+        start = Now();
+        bool golden = gamma_golden_possible(g, 2);
+        double golden_time = Now() - start;
+
+        start = Now();
+        char *board = gamma_board(g);
+        double board_time = Now() - start;
+
+        printf("  %-6s adjacent free %.2f ms, golden_possible %.2f ms, "
+               "board %.2f ms%s\n", names[level], count_time * 1e3,
+               golden_time * 1e3, board_time * 1e3,
+               count == expected && count == g->players[0].adjacent_free_fields
+               && golden && board != NULL ? "" : " (wrong result)");
+        free(board);
+    }
+    SetScanLevel(best);
+    gamma_delete(g);
+}
+
+/** @brief Mierzy @ref gamma_golden_possible na planszy z
+ * @ref CornerBoard przy liczbie wątków od 1 do liczby procesorów (co
+ * najmniej 4), podwajanej w kolejnych krokach.
+ * @param[in] side    – długość boku planszy.
+ */
+static void ThreadsBenchmark(uint32_t side) {
+    gamma_t *g = CornerBoard(side);
+    if(g == NULL) {
+        return;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    uint32_t most = online > 4 ? online : 4;
+    if(most > GAMMA_MAX_QUERY_THREADS) {
+        most = GAMMA_MAX_QUERY_THREADS;
+    }
+    printf("golden_possible %ux%u, %ld processors:", side, side, online);
+    double serial = 0;
+    for(uint32_t threads = 1; threads <= most;
+        threads = threads < most && threads * 2 > most ? most : threads * 2) {
+        gamma_set_query_threads(g, threads);
+        double start = Now();
+        bool golden = false;
+        for(int k = 0; k < 10; k++) {
+            golden = gamma_golden_possible(g, 2);
+        }
+        double time = (Now() - start) / 10;
+        if(threads == 1) {
+            serial = time;
+        }
+        printf(" %u: %.2f ms (x%.2f)%s", threads, time * 1e3, serial / time,
+               golden ? "" : " (wrong result)");
+        if(threads == most) {
+            break;
+        }
+    }
+    printf("\n");
+    gamma_delete(g);
+}
+
+/**
+ * @brief Mierzone operacje silnika w zestawie testów wydajnościowych.
+ */
+typedef enum bench_operation {
+    BENCH_MOVE,              /**< @ref gamma_move */
+    BENCH_GOLDEN_MOVE,       /**< @ref gamma_golden_move */
+    BENCH_FREE_FIELDS,       /**< @ref gamma_free_fields */
+    BENCH_GOLDEN_POSSIBLE,   /**< @ref gamma_golden_possible */
+    BENCH_BOARD,             /**< @ref gamma_board */
+    BENCH_OPERATIONS         /**< liczba mierzonych operacji */
+} bench_operation;
+
+/** @brief Nazwy mierzonych operacji w wynikach. */
+static const char *operation_names[BENCH_OPERATIONS] = {
+    "gamma_move", "gamma_golden_move", "gamma_free_fields",
+    "gamma_golden_possible", "gamma_board"
+};
+
+/**
+ * @brief Rodzaje rozgrywek w zestawie testów wydajnościowych.
+ */
+typedef enum bench_workload {
+    BENCH_RANDOM,     /**< czterech graczy zapełnia planszę w losowej
+                        *  kolejności pól */
+    BENCH_SPIRAL,     /**< gracz 1 zajmuje spiralę, gracz 2 resztę planszy */
+    BENCH_ENDGAME,    /**< dwóch graczy z małą liczbą obszarów zapełnia
+                        *  planszę, potem wykonywanych jest wiele złotych
+                        *  ruchów */
+    BENCH_PLAYERS,    /**< liczba graczy równa jednej czwartej liczby pól */
+    BENCH_WORKLOADS   /**< liczba rodzajów rozgrywek */
+} bench_workload;
+
+/** @brief Nazwy rodzajów rozgrywek w wynikach. */
+static const char *workload_names[BENCH_WORKLOADS] = {
+    "random", "spiral", "endgame", "players"
+};
+
+/** @brief Długości boków plansz zestawu testów wydajnościowych. */
+static const uint32_t suite_sides[] = {10, 100, 1000, 10000};
+
+/**
+ * @brief Wynik pomiaru jednej operacji w jednej rozgrywce.
+ */
+typedef struct bench_result {
+    uint32_t players;         /**< liczba graczy */
+    uint64_t count;           /**< liczba wywołań operacji */
+    double seconds;           /**< łączny czas wywołań */
+} bench_result;
+
+/** @brief Losuje kolejną liczbę generatorem xorshift64*.
+ * @param[in,out] state – stan generatora, liczba niezerowa.
+ * @return Liczba pseudolosowa.
+ */
+static uint64_t Random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+/** @brief Zapełnia planszę, przechodząc pola w losowej kolejności; na każdym
+ * polu kolejni gracze, poczynając od losowego, próbują wykonać ruch, dopóki
+ * któremuś się nie uda. Po przejściu wszystkich pól żaden gracz nie może
+ * wykonać zwykłego ruchu.
+ * @param[in,out] g      – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] seed   – stan generatora liczb pseudolosowych,
+ * @param[out] result    – pomiar @ref gamma_move.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool RandomFill(gamma_t *g, uint64_t *seed, bench_result *result) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t *order = malloc(sizeof(uint32_t) * fields);
+    if(order == NULL) {
+        return false;
+    }
+    for(uint64_t i = 0; i < fields; i++) {
+        order[i] = i;
+    }
+    for(uint64_t i = fields; i > 1; i--) {
+        uint64_t j = Random(seed) % i;
+        uint32_t swap = order[i - 1];
+        order[i - 1] = order[j];
+        order[j] = swap;
+    }
+
+    uint32_t players = g->number_of_players;
+    // gracze próbujący zająć pole są wybierani bez ponownego losowania, aby
+    // mierzyć gamma_move, a nie generator
+    uint32_t first = Random(seed) % players;
+    double start = Now();
+    for(uint64_t i = 0; i < fields; i++) {
+        uint32_t x = order[i] % g->width, y = order[i] / g->width;
+        for(uint32_t k = 0; k < players; k++) {
+            result->count++;
+            if(gamma_move(g, 1 + (first + k) % players, x, y)) {
+                break;
+            }
+        }
+        first = first + 1 < players ? first + 1 : 0;
+    }
+    result->seconds += Now() - start;
+    free(order);
+    return true;
+}
+
+/** @brief Zajmuje planszę spiralą gracza 1 z @ref Spiral, a następnie
+ * pozostałe pola wierszami przez gracza 2.
+ * @param[in,out] g      – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[out] result    – pomiar @ref gamma_move.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool SpiralFill(gamma_t *g, bench_result *result) {
+    uint64_t length;
+    uint32_t *path = Spiral(g->width, g->height, &length);
+    if(path == NULL) {
+        return false;
+    }
+    double start = Now();
+    for(uint64_t k = 0; k < length; k++) {
+        gamma_move(g, 1, path[k] % g->width, path[k] / g->width);
+    }
+    for(uint32_t y = 0; y < g->height; y++) {
+        for(uint32_t x = 0; x < g->width; x++) {
+            gamma_move(g, 2, x, y);
+        }
+    }
+    result->seconds += Now() - start;
+    result->count += length + (uint64_t)g->width * g->height;
+    free(path);
+    return true;
+}
+
+/** @brief Mierzy zapytania o stan gry oraz złote ruchy na zapełnionej
+ * planszy. Liczby powtórzeń są dobrane tak, aby każdy pomiar trwał podobnie
+ * długo niezależnie od rozmiaru planszy.
+ * @param[in,out] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] seed    – stan generatora liczb pseudolosowych,
+ * @param[in] golden      – liczba prób złotego ruchu,
+ * @param[out] results    – pomiary kolejnych operacji.
+ */
+static void MeasureQueries(gamma_t *g, uint64_t *seed, uint64_t golden,
+                           bench_result *results) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t players = g->number_of_players;
+    uint64_t repeats = fields < 1000000 ? 1000000 / fields : 1;
+    volatile uint64_t sink = 0;
+
+    // gamma_free_fields nie zależy od rozmiaru planszy
+    bench_result *free_fields = &results[BENCH_FREE_FIELDS];
+    uint64_t rounds = players < 1000000 ? 1000000 / players : 1;
+    double start = Now();
+    for(uint64_t k = 0; k < rounds; k++) {
+        for(uint32_t player = 1; player <= players; player++) {
+            sink += gamma_free_fields(g, player);
+        }
+    }
+    free_fields->seconds += Now() - start;
+    free_fields->count += rounds * players;
+
+    // dla wielu graczy pytamy tylko o część z nich, bo każde zapytanie może
+    // przeglądać całą planszę
+    uint32_t asked = players < 16 ? players : 16;
+    bench_result *possible = &results[BENCH_GOLDEN_POSSIBLE];
+    start = Now();
+    for(uint64_t k = 0; k < repeats; k++) {
+        for(uint32_t j = 0; j < asked; j++) {
+            sink += gamma_golden_possible(g, 1 + j * (players / asked));
+        }
+    }
+    possible->seconds += Now() - start;
+    possible->count += repeats * asked;
+
+    bench_result *board = &results[BENCH_BOARD];
+    start = Now();
+    for(uint64_t k = 0; k < repeats; k++) {
+        char *text = gamma_board(g);
+        sink += text != NULL;
+        free(text);
+    }
+    board->seconds += Now() - start;
+    board->count += repeats;
+
+    bench_result *golden_move = &results[BENCH_GOLDEN_MOVE];
+    for(uint64_t k = 0; k < golden; k++) {
+        uint64_t r = Random(seed);
+        uint32_t player = 1 + r % players;
+        uint32_t x = (r >> 20) % g->width, y = (r >> 42) % g->height;
+        start = Now();
+        sink += gamma_golden_move(g, player, x, y);
+        golden_move->seconds += Now() - start;
+    }
+    golden_move->count += golden;
+    (void)sink;
+}
+
+/** @brief Rozgrywa jedną rozgrywkę zestawu i mierzy jej operacje.
+ * @param[in] workload – rodzaj rozgrywki,
+ * @param[in] side     – długość boku planszy,
+ * @param[in] seed     – ziarno generatora liczb pseudolosowych,
+ * @param[out] results – pomiary kolejnych operacji.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool RunWorkload(bench_workload workload, uint32_t side, uint64_t seed,
+                        bench_result *results) {
+    uint64_t fields = (uint64_t)side * side;
+    uint32_t players = 4, areas = side;
+    uint64_t golden = 1000;
+    switch(workload) {
+        case BENCH_SPIRAL:
+            players = 2;
+            areas = fields;
+            break;
+        case BENCH_ENDGAME:
+            players = 2;
+            areas = side / 10 > 0 ? side / 10 : 1;
+            golden = 10000;
+            break;
+        case BENCH_PLAYERS:
+            players = fields / 4;
+            areas = 4;
+            break;
+        default:
+            break;
+    }
+
+    // ziarno zależy od rozgrywki i planszy, aby wyniki nie zależały od tego,
+    // które rozgrywki są uruchamiane
+    seed = seed * 31 + workload * 1000003 + side;
+    seed = seed != 0 ? seed : 1;
+    gamma_t *g = gamma_new(side, side, players, areas);
+    if(g == NULL) {
+        return false;
+    }
+    bool filled = workload == BENCH_SPIRAL
+                  ? SpiralFill(g, &results[BENCH_MOVE])
+                  : RandomFill(g, &seed, &results[BENCH_MOVE]);
+    if(filled) {
+        MeasureQueries(g, &seed, golden, results);
+    }
+    for(int k = 0; k < BENCH_OPERATIONS; k++) {
+        results[k].players = players;
+    }
+    gamma_delete(g);
+    return filled;
+}
+
+/** @brief Rozgrywa rozgrywkę w osobnym procesie, aby zmierzyć jej
+ * największe zużycie pamięci.
+ * @param[in] workload – rodzaj rozgrywki,
+ * @param[in] side     – długość boku planszy,
+ * @param[in] seed     – ziarno generatora liczb pseudolosowych,
+ * @param[out] results – pomiary kolejnych operacji,
+ * @param[out] peak_kb – największa pamięć rezydentna procesu w kilobajtach.
+ * @return Wartość @p true, jeśli rozgrywka się powiodła.
+ */
+static bool RunIsolated(bench_workload workload, uint32_t side, uint64_t seed,
+                        bench_result *results, long *peak_kb) {
+    int channel[2];
+    if(pipe(channel) != 0) {
+        return false;
+    }
+    fflush(NULL);
+    pid_t child = fork();
+    if(child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return false;
+    }
+    if(child == 0) {
+        close(channel[0]);
+        bench_result measured[BENCH_OPERATIONS] = {{0}};
+        bool done = RunWorkload(workload, side, seed, measured);
+        if(done && write(channel[1], measured, sizeof(measured))
+                   != (ssize_t)sizeof(measured)) {
+            done = false;
+        }
+        _exit(done ? 0 : 1);
+    }
+
+    close(channel[1]);
+    size_t size = sizeof(bench_result) * BENCH_OPERATIONS, got = 0;
+    ssize_t part;
+    while(got < size && (part = read(channel[0], (char *)results + got,
+                                     size - got)) > 0) {
+        got += part;
+    }
+    close(channel[0]);
+
+    int status;
+    struct rusage usage;
+    if(wait4(child, &status, 0, &usage) != child) {
+        return false;
+    }
+    *peak_kb = usage.ru_maxrss;
+    return got == size && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+/**
+ * @brief Opcje zestawu testów wydajnościowych.
+ */
+typedef struct suite_options {
+    bool json;            /**< wyniki w formacie JSON zamiast CSV */
+    uint32_t max_side;    /**< największa długość boku planszy */
+    uint64_t seed;        /**< ziarno generatora liczb pseudolosowych */
+    const char *output;   /**< plik wyników, NULL dla stdout */
+} suite_options;
+
+/** @brief Odczytuje liczbę dziesiętną z argumentu programu.
+ * @param[in] text    – argument,
+ * @param[in] most    – największa dopuszczalna wartość,
+ * @param[out] value  – odczytana liczba.
+ * @return Wartość @p true, jeśli argument był liczbą niewiększą od @p most.
+ */
+static bool ParseNumber(const char *text, uint64_t most, uint64_t *value) {
+    *value = 0;
+    if(text == NULL || *text == '\0') {
+        return false;
+    }
+    for(; *text != '\0'; text++) {
+        if(*text < '0' || *text > '9'
+           || *value > (most - (*text - '0')) / 10) {
+            return false;
+        }
+        *value = *value * 10 + (*text - '0');
+    }
+    return true;
+}
+
+/** @brief Odczytuje opcje zestawu testów: "--format csv|json",
+ * "--max-side N", "--seed N" i "--output PLIK".
+ * @param[in] argc     – liczba argumentów za słowem "suite",
+ * @param[in] argv     – argumenty za słowem "suite",
+ * @param[out] options – odczytane opcje.
+ * @return Wartość @p true, jeśli opcje były poprawne.
+ */
+static bool GetSuiteOptions(int argc, char *argv[], suite_options *options) {
+    *options = (suite_options){.json = false, .max_side = 1000, .seed = 1,
+                               .output = NULL};
+    for(int k = 0; k < argc; k += 2) {
+        const char *value = k + 1 < argc ? argv[k + 1] : NULL;
+        uint64_t number;
+        if(value == NULL) {
+            return false;
+        } else if(strcmp(argv[k], "--format") == 0) {
+            if(strcmp(value, "json") != 0 && strcmp(value, "csv") != 0) {
+                return false;
+            }
+            options->json = strcmp(value, "json") == 0;
+        } else if(strcmp(argv[k], "--max-side") == 0) {
+            if(!ParseNumber(value, UINT16_MAX, &number)) {
+                return false;
+            }
+            options->max_side = number;
+        } else if(strcmp(argv[k], "--seed") == 0) {
+            if(!ParseNumber(value, UINT64_MAX, &number)) {
+                return false;
+            }
+            options->seed = number;
+        } else if(strcmp(argv[k], "--output") == 0) {
+            options->output = value;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Uruchamia zestaw testów wydajnościowych: każdą rozgrywkę na
+ * każdej planszy od 10x10 do @p options->max_side x @p options->max_side
+ * i wypisuje czas jednego wywołania każdej operacji w nanosekundach oraz
+ * największą pamięć rezydentną rozgrywki.
+ * @param[in] options – opcje zestawu.
+ * @return Zero, a 1 gdy nie udało się otworzyć pliku wyników.
+ */
+static int RunSuite(const suite_options *options) {
+    FILE *out = options->output != NULL ? fopen(options->output, "w") : stdout;
+    if(out == NULL) {
+        perror(options->output);
+        return 1;
+    }
+    if(options->json) {
+        fprintf(out, "{\"seed\": %lu, \"results\": [", options->seed);
+    } else {
+        fprintf(out, "workload,width,height,players,operation,count,"
+                     "ns_per_op,peak_rss_kb\n");
+    }
+
+    bool first = true;
+    for(size_t s = 0; s < sizeof(suite_sides) / sizeof(suite_sides[0]); s++) {
+        uint32_t side = suite_sides[s];
+        if(side > options->max_side) {
+            break;
+        }
+        for(bench_workload w = 0; w < BENCH_WORKLOADS; w++) {
+            bench_result results[BENCH_OPERATIONS] = {{0}};
+            long peak_kb = 0;
+            if(!RunIsolated(w, side, options->seed, results, &peak_kb)) {
+                fprintf(stderr, "%s %ux%u: failed\n", workload_names[w],
+                        side, side);
+                continue;
+            }
+            for(bench_operation op = 0; op < BENCH_OPERATIONS; op++) {
+                const bench_result *r = &results[op];
+                double ns = r->count > 0 ? r->seconds * 1e9 / r->count : 0;
+                if(options->json) {
+                    fprintf(out, "%s\n  {\"workload\": \"%s\", \"width\": %u, "
+                            "\"height\": %u, \"players\": %u, "
+                            "\"operation\": \"%s\", \"count\": %lu, "
+                            "\"ns_per_op\": %.1f, \"peak_rss_kb\": %ld}",
+                            first ? "" : ",", workload_names[w], side, side,
+                            r->players, operation_names[op], r->count, ns,
+                            peak_kb);
+                } else {
+                    fprintf(out, "%s,%u,%u,%u,%s,%lu,%.1f,%ld\n",
+                            workload_names[w], side, side, r->players,
+                            operation_names[op], r->count, ns, peak_kb);
+                }
+                first = false;
+            }
+            fflush(out);
+        }
+    }
+
+    if(options->json) {
+        fprintf(out, "\n]}\n");
+    }
+    if(out != stdout) {
+        fclose(out);
+    }
+    return 0;
+}
+
+/** @brief Uruchamia testy wydajnościowe silnika gry gamma.
+ * Bez argumentów wykonuje pojedyncze pomiary wypisywane dla człowieka.
+ * Argument "suite" uruchamia zestaw powtarzalnych rozgrywek opisany przy
+ * @ref RunSuite, z opcjami opisanymi przy @ref GetSuiteOptions.
+ * @param[in] argc – liczba argumentów programu,
+ * @param[in] argv – argumenty programu.
+ * @return Zero, a 1 gdy argumenty były niepoprawne lub zestaw się nie
+ * powiódł.
+ */
+int main(int argc, char *argv[]) {
+    if(argc > 1) {
+        suite_options options;
+        if(strcmp(argv[1], "suite") != 0
+           || !GetSuiteOptions(argc - 2, argv + 2, &options)) {
+            fprintf(stderr, "Użycie: %s [suite [--format csv|json] "
+                    "[--max-side N] [--seed N] [--output PLIK]]\n", argv[0]);
+            return 1;
+        }
+        return RunSuite(&options);
+    }
+    SpiralBenchmark(4096);
+    ChurnBenchmark(8, 1000000);
+    ChurnBenchmark(19, 200000);
+    ScanBenchmark(2048);
+    ThreadsBenchmark(8192);
+    PlayoutBenchmark(19, 2000);
+    PlayoutBenchmark(100, 50);
+    TurnBenchmark(19, 4, 1000);
+    TurnBenchmark(100, 16, 20);
+    BotBenchmark(20, 20000);
+    return 0;
+}
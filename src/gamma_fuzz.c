@@ -0,0 +1,507 @@
+/** @file
+ * Porównanie silnika gry gamma z silnikiem wzorcowym na losowych rozgrywkach
+ *
+ * Każda rozgrywka to losowe parametry gry i losowy ciąg operacji. Po każdej
+ * operacji zmieniającej planszę porównywane są wyniki obu silników oraz
+ * liczby obszarów graczy. Rozgrywka, w której silniki się różnią, jest
+ * skracana do możliwie małej i wypisywana jako wejście trybu wsadowego.
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "reference_gamma.h"
+
+/**
+ * @brief Rodzaje operacji w rozgrywce.
+ */
+typedef enum fuzz_kind {
+    FUZZ_MOVE,             /**< @ref gamma_move */
+    FUZZ_GOLDEN_MOVE,      /**< @ref gamma_golden_move */
+    FUZZ_BUSY_FIELDS,      /**< @ref gamma_busy_fields */
+    FUZZ_FREE_FIELDS,      /**< @ref gamma_free_fields */
+    FUZZ_GOLDEN_POSSIBLE,  /**< @ref gamma_golden_possible */
+    FUZZ_BOARD,            /**< @ref gamma_board */
+    FUZZ_LEGAL_MOVES,      /**< @ref gamma_legal_moves
+                             *  i @ref gamma_random_legal_move */
+    FUZZ_NEXT_ACTIVE,      /**< @ref gamma_next_active_player
+                             *  i @ref gamma_game_over */
+    FUZZ_CLONE             /**< zastąpienie gry jej kopią z
+                             *  @ref gamma_clone; silnik wzorcowy się nie
+                             *  zmienia */
+} fuzz_kind;
+
+/**
+ * @brief Operacja w rozgrywce.
+ */
+typedef struct fuzz_op {
+    fuzz_kind kind;     /**< rodzaj operacji */
+    uint32_t player;    /**< numer gracza */
+    uint32_t x;         /**< numer kolumny */
+    uint32_t y;         /**< numer wiersza */
+} fuzz_op;
+
+/**
+ * @brief Rozgrywka: parametry gry i ciąg operacji.
+ */
+typedef struct fuzz_case {
+    uint32_t width;     /**< szerokość planszy */
+    uint32_t height;    /**< wysokość planszy */
+    uint32_t players;   /**< liczba graczy */
+    uint32_t areas;     /**< maksymalna liczba obszarów */
+    size_t length;      /**< liczba operacji */
+    fuzz_op *ops;       /**< operacje */
+} fuzz_case;
+
+/** @brief Wynik @ref Replay, gdy nie udało się zaalokować pamięci. */
+#define REPLAY_FAILED SIZE_MAX
+
+/** @brief Losuje kolejną liczbę generatorem xorshift64*.
+ * @param[in,out] state – stan generatora, liczba niezerowa.
+ * @return Liczba pseudolosowa.
+ */
+static uint64_t Random(uint64_t *state) {
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 2685821657736338717ULL;
+}
+
+/** @brief Losuje liczbę z przedziału [0, @p bound).
+ * @param[in,out] state – stan generatora,
+ * @param[in] bound     – liczba dodatnia.
+ * @return Liczba pseudolosowa.
+ */
+static uint32_t Below(uint64_t *state, uint32_t bound) {
+    return Random(state) % bound;
+}
+
+/** @brief Losuje współrzędną; czasem leżącą poza planszą.
+ * @param[in,out] state – stan generatora,
+ * @param[in] size      – wymiar planszy.
+ * @return Współrzędna.
+ */
+static uint32_t Coordinate(uint64_t *state, uint32_t size) {
+    uint32_t r = Below(state, 64);
+    if(r == 0) {
+        return UINT32_MAX;
+    }
+    return r == 1 ? size : Below(state, size);
+}
+
+/** @brief Losuje rozgrywkę. Plansze są małe, aby silnik wzorcowy był
+ * szybki, a gracze i pola czasem niepoprawne.
+ * @param[in,out] state – stan generatora,
+ * @param[in] steps     – największa liczba operacji,
+ * @param[out] c        – rozgrywka; @p c->ops musi mieścić @p steps
+ *                        operacji.
+ */
+static void Generate(uint64_t *state, size_t steps, fuzz_case *c) {
+    c->width = 1 + Below(state, 10);
+    c->height = 1 + Below(state, 10);
+    // czasem więcej niż dziewięciu graczy, aby sprawdzić wielocyfrowe
+    // numery na planszy
+    c->players = Below(state, 8) == 0 ? 10 + Below(state, 20)
+                                      : 1 + Below(state, 5);
+    c->areas = 1 + Below(state, 5);
+    c->length = 1 + Random(state) % steps;
+
+    for(size_t k = 0; k < c->length; k++) {
+        fuzz_op *op = &c->ops[k];
+        uint32_t r = Below(state, 100);
+        op->kind = r < 55 ? FUZZ_MOVE
+                   : r < 70 ? FUZZ_GOLDEN_MOVE
+                   : r < 75 ? FUZZ_BUSY_FIELDS
+                   : r < 82 ? FUZZ_FREE_FIELDS
+                   : r < 88 ? FUZZ_GOLDEN_POSSIBLE
+                   : r < 91 ? FUZZ_LEGAL_MOVES
+                   : r < 94 ? FUZZ_NEXT_ACTIVE
+                   : r < 97 ? FUZZ_BOARD : FUZZ_CLONE;
+        r = Below(state, 32);
+        op->player = r == 0 ? 0 : r == 1 ? c->players + 1
+                                         : 1 + Below(state, c->players);
+        op->x = Coordinate(state, c->width);
+        op->y = Coordinate(state, c->height);
+    }
+}
+
+/** @brief Podaje następnego gracza, który może wykonać ruch w silniku
+ * wzorcowym, sprawdzając kolejnych graczy.
+ * @param[in,out] r    – wskaźnik na stan gry silnika wzorcowego,
+ * @param[in] player   – numer gracza, po którym szukamy następnego, lub 0.
+ * @return Numer gracza lub 0, tak jak @ref gamma_next_active_player.
+ */
+static uint32_t ReferenceNextActive(reference_gamma *r, uint32_t player) {
+    if(player > r->players) {
+        return 0;
+    }
+    for(uint32_t k = 1; k <= r->players; k++) {
+        uint32_t next = (player + k - 1) % r->players + 1;
+        if(ReferenceFreeFields(r, next) > 0
+           || ReferenceGoldenPossible(r, next)) {
+            return next;
+        }
+    }
+    return 0;
+}
+
+/** @brief Porównuje stan obu silników: liczby obszarów, zajętych
+ * i wolnych pól każdego gracza oraz planszę.
+ * @param[in] g        – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] r    – wskaźnik na stan gry silnika wzorcowego,
+ * @param[out] why     – opis różnicy,
+ * @param[in] size     – rozmiar bufora @p why.
+ * @return Wartość @p true, jeśli stany są zgodne.
+ */
+static bool SameState(gamma_t *g, reference_gamma *r, char *why,
+                      size_t size) {
+    for(uint32_t player = 1; player <= r->players; player++) {
+        uint32_t areas = ReferenceAreas(r, player);
+        if(g->players[player - 1].number_of_areas != areas) {
+            snprintf(why, size, "player %u has %u areas, reference %u",
+                     player, g->players[player - 1].number_of_areas, areas);
+            return false;
+        }
+        uint64_t busy = gamma_busy_fields(g, player);
+        if(busy != ReferenceBusyFields(r, player)) {
+            snprintf(why, size, "gamma_busy_fields(%u) = %lu, reference %lu",
+                     player, busy, ReferenceBusyFields(r, player));
+            return false;
+        }
+        uint64_t free_fields = gamma_free_fields(g, player);
+        if(free_fields != ReferenceFreeFields(r, player)) {
+            snprintf(why, size, "gamma_free_fields(%u) = %lu, reference %lu",
+                     player, free_fields, ReferenceFreeFields(r, player));
+            return false;
+        }
+    }
+
+    char *board = gamma_board(g);
+    char *expected = ReferenceBoard(r);
+    bool same = board != NULL && expected != NULL
+                && strcmp(board, expected) == 0;
+    if(!same) {
+        snprintf(why, size, "gamma_board differs");
+    }
+    free(board);
+    free(expected);
+    return same;
+}
+
+/** @brief Rozgrywa rozgrywkę w obu silnikach.
+ * @param[in] c        – rozgrywka,
+ * @param[out] why     – opis pierwszej różnicy,
+ * @param[in] size     – rozmiar bufora @p why.
+ * @return Numer pierwszej operacji, po której silniki się różnią,
+ * @p c->length, gdy są zgodne, lub @ref REPLAY_FAILED, gdy nie udało się
+ * zaalokować pamięci.
+ */
+static size_t Replay(const fuzz_case *c, char *why, size_t size) {
+    gamma_t *g = gamma_new(c->width, c->height, c->players, c->areas);
+    reference_gamma *r = ReferenceNew(c->width, c->height, c->players,
+                                      c->areas);
+    if(g == NULL || r == NULL) {
+        gamma_delete(g);
+        ReferenceDelete(r);
+        return REPLAY_FAILED;
+    }
+
+    size_t k;
+    for(k = 0; k < c->length; k++) {
+        const fuzz_op *op = &c->ops[k];
+        uint64_t got = 0, expected = 0;
+        bool changes = false;
+        switch(op->kind) {
+            case FUZZ_MOVE:
+                got = gamma_move(g, op->player, op->x, op->y);
+                expected = ReferenceMove(r, op->player, op->x, op->y);
+                changes = true;
+                break;
+            case FUZZ_GOLDEN_MOVE:
+                got = gamma_golden_move(g, op->player, op->x, op->y);
+                expected = ReferenceGoldenMove(r, op->player, op->x, op->y);
+                changes = true;
+                break;
+            case FUZZ_BUSY_FIELDS:
+                got = gamma_busy_fields(g, op->player);
+                expected = ReferenceBusyFields(r, op->player);
+                break;
+            case FUZZ_FREE_FIELDS:
+                got = gamma_free_fields(g, op->player);
+                expected = ReferenceFreeFields(r, op->player);
+                break;
+            case FUZZ_GOLDEN_POSSIBLE:
+                got = gamma_golden_possible(g, op->player);
+                expected = ReferenceGoldenPossible(r, op->player);
+                break;
+            case FUZZ_LEGAL_MOVES: {
+                // liczba pól, na których gracz może wykonać ruch, to
+                // liczba jego wolnych pól
+                uint64_t rng = op->x;
+                uint32_t x, y;
+                got = gamma_legal_moves(g, op->player, NULL, 0);
+                expected = ReferenceFreeFields(r, op->player);
+                if(gamma_random_legal_move(g, op->player, &rng, &x, &y)
+                   != (got > 0)) {
+                    snprintf(why, size, "gamma_random_legal_move(%u) "
+                             "disagrees with gamma_legal_moves", op->player);
+                    gamma_delete(g);
+                    ReferenceDelete(r);
+                    return k;
+                }
+                break;
+            }
+            case FUZZ_NEXT_ACTIVE:
+                got = gamma_next_active_player(g, op->player);
+                expected = ReferenceNextActive(r, op->player);
+                if(gamma_game_over(g) != (ReferenceNextActive(r, 0) == 0)) {
+                    snprintf(why, size, "gamma_game_over disagrees with "
+                             "the reference");
+                    gamma_delete(g);
+                    ReferenceDelete(r);
+                    return k;
+                }
+                break;
+            case FUZZ_BOARD:
+                // plansza jest porównywana po każdej zmianie
+                break;
+            case FUZZ_CLONE: {
+                gamma_t *copy = gamma_clone(g);
+                if(copy == NULL) {
+                    gamma_delete(g);
+                    ReferenceDelete(r);
+                    return REPLAY_FAILED;
+                }
+                gamma_delete(g);
+                g = copy;
+                changes = true;
+                break;
+            }
+        }
+        if(got != expected) {
+            snprintf(why, size, "engine returned %lu, reference %lu",
+                     got, expected);
+            break;
+        }
+        if(changes && !SameState(g, r, why, size)) {
+            break;
+        }
+    }
+
+    gamma_delete(g);
+    ReferenceDelete(r);
+    return k;
+}
+
+/** @brief Sprawdza, czy silniki różnią się w rozgrywce.
+ * @param[in] c       – rozgrywka.
+ * @return Wartość @p true, jeśli silniki się różnią.
+ */
+static bool Fails(const fuzz_case *c) {
+    char why[128];
+    size_t k = Replay(c, why, sizeof(why));
+    return k != REPLAY_FAILED && k < c->length;
+}
+
+/** @brief Skraca rozgrywkę, w której silniki się różnią, zachowując
+ * różnicę: obcina operacje za pierwszą różnicą, usuwa coraz krótsze ciągi
+ * operacji, a następnie zmniejsza parametry gry i upraszcza operacje.
+ * @param[in,out] c   – rozgrywka, w której silniki się różnią.
+ */
+static void Shrink(fuzz_case *c) {
+    char why[128];
+    c->length = Replay(c, why, sizeof(why)) + 1;
+
+    fuzz_op *saved = malloc(sizeof(fuzz_op) * c->length);
+    if(saved == NULL) {
+        return;
+    }
+    for(size_t chunk = c->length / 2; chunk > 0;) {
+        bool removed = false;
+        for(size_t start = 0; start + chunk <= c->length;) {
+            size_t length = c->length;
+            memcpy(saved, c->ops, sizeof(fuzz_op) * length);
+            memmove(c->ops + start, c->ops + start + chunk,
+                    sizeof(fuzz_op) * (length - start - chunk));
+            c->length = length - chunk;
+            if(Fails(c)) {
+                c->length = Replay(c, why, sizeof(why)) + 1;
+                removed = true;
+            } else {
+                memcpy(c->ops, saved, sizeof(fuzz_op) * length);
+                c->length = length;
+                start += chunk;
+            }
+        }
+        if(!removed) {
+            chunk /= 2;
+        }
+    }
+    free(saved);
+
+    uint32_t *parameters[] = {&c->width, &c->height, &c->players, &c->areas};
+    for(bool progress = true; progress;) {
+        progress = false;
+        for(int p = 0; p < 4; p++) {
+            while(*parameters[p] > 1) {
+                (*parameters[p])--;
+                if(!Fails(c)) {
+                    (*parameters[p])++;
+                    break;
+                }
+                progress = true;
+            }
+        }
+        for(size_t k = 0; k < c->length; k++) {
+            for(int field = 0; field < 3; field++) {
+                fuzz_op previous = c->ops[k];
+                uint32_t *value = field == 0 ? &c->ops[k].player
+                                  : field == 1 ? &c->ops[k].x : &c->ops[k].y;
+                uint32_t simplest = field == 0 ? 1 : 0;
+                if(*value == simplest) {
+                    continue;
+                }
+                *value = simplest;
+                if(Fails(c)) {
+                    progress = true;
+                } else {
+                    c->ops[k] = previous;
+                }
+            }
+        }
+    }
+}
+
+/** @brief Wypisuje rozgrywkę jako wejście trybu wsadowego programu gamma.
+ * Kopiowanie gry nie ma odpowiednika w trybie wsadowym i jest wypisywane
+ * jako komentarz.
+ * @param[in] c       – rozgrywka,
+ * @param[in] out     – plik wyjściowy.
+ */
+static void PrintCase(const fuzz_case *c, FILE *out) {
+    fprintf(out, "B %u %u %u %u\n", c->width, c->height, c->players,
+            c->areas);
+    for(size_t k = 0; k < c->length; k++) {
+        const fuzz_op *op = &c->ops[k];
+        switch(op->kind) {
+            case FUZZ_MOVE:
+                fprintf(out, "m %u %u %u\n", op->player, op->x, op->y);
+                break;
+            case FUZZ_GOLDEN_MOVE:
+                fprintf(out, "g %u %u %u\n", op->player, op->x, op->y);
+                break;
+            case FUZZ_BUSY_FIELDS:
+                fprintf(out, "b %u\n", op->player);
+                break;
+            case FUZZ_FREE_FIELDS:
+                fprintf(out, "f %u\n", op->player);
+                break;
+            case FUZZ_GOLDEN_POSSIBLE:
+                fprintf(out, "q %u\n", op->player);
+                break;
+            case FUZZ_LEGAL_MOVES:
+                fprintf(out, "# gamma_legal_moves %u\n", op->player);
+                break;
+            case FUZZ_NEXT_ACTIVE:
+                fprintf(out, "# gamma_next_active_player %u\n", op->player);
+                break;
+            case FUZZ_BOARD:
+                fprintf(out, "p\n");
+                break;
+            case FUZZ_CLONE:
+                fprintf(out, "# gamma_clone\n");
+                break;
+        }
+    }
+}
+
+/** @brief Odczytuje liczbę dziesiętną z argumentu programu.
+ * @param[in] text    – argument,
+ * @param[out] value  – odczytana liczba.
+ * @return Wartość @p true, jeśli argument był liczbą mieszczącą się
+ * w uint64_t.
+ */
+static bool ParseNumber(const char *text, uint64_t *value) {
+    *value = 0;
+    if(text == NULL || *text == '\0') {
+        return false;
+    }
+    for(; *text != '\0'; text++) {
+        if(*text < '0' || *text > '9'
+           || *value > (UINT64_MAX - (*text - '0')) / 10) {
+            return false;
+        }
+        *value = *value * 10 + (*text - '0');
+    }
+    return true;
+}
+
+/** @brief Rozgrywa losowe rozgrywki w silniku gry gamma i w silniku
+ * wzorcowym. Opcje: "--seed N" (ziarno, domyślnie 1), "--runs N" (liczba
+ * rozgrywek, domyślnie 100000) i "--steps N" (największa liczba operacji
+ * w rozgrywce, domyślnie 100). Pierwsza różnica jest skracana i wypisywana
+ * na stdout razem z ziarnem rozgrywki.
+ * @param[in] argc – liczba argumentów programu,
+ * @param[in] argv – argumenty programu.
+ * @return Zero, gdy silniki są zgodne, 1 przy różnicy, a 2 gdy argumenty
+ * są niepoprawne lub nie udało się zaalokować pamięci.
+ */
+int main(int argc, char *argv[]) {
+    uint64_t seed = 1, runs = 100000, steps = 100;
+    for(int k = 1; k < argc; k += 2) {
+        uint64_t *option = strcmp(argv[k], "--seed") == 0 ? &seed
+                           : strcmp(argv[k], "--runs") == 0 ? &runs
+                           : strcmp(argv[k], "--steps") == 0 ? &steps
+                           : NULL;
+        if(option == NULL || k + 1 >= argc
+           || !ParseNumber(argv[k + 1], option)
+           || (option == &steps && (steps == 0 || steps > 1000000))) {
+            fprintf(stderr, "Użycie: %s [--seed N] [--runs N] [--steps N]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    fuzz_case c;
+    c.ops = malloc(sizeof(fuzz_op) * steps);
+    if(c.ops == NULL) {
+        return 2;
+    }
+    uint64_t operations = 0;
+    for(uint64_t run = 0; run < runs; run++) {
+        // każda rozgrywka ma własne ziarno, aby można ją było powtórzyć
+        // przez --seed N --runs 1
+        uint64_t case_seed = seed + run;
+        uint64_t state = case_seed * 0x9E3779B97F4A7C15ULL + 1;
+        Generate(&state, steps, &c);
+
+        char why[128];
+        size_t k = Replay(&c, why, sizeof(why));
+        if(k == REPLAY_FAILED) {
+            fprintf(stderr, "out of memory\n");
+            free(c.ops);
+            return 2;
+        }
+        operations += c.length;
+        if(k < c.length) {
+            size_t original = k + 1;
+            Shrink(&c);
+            Replay(&c, why, sizeof(why));
+            printf("# seed %lu: %s after operation %zu; shrunk from %zu "
+                   "to %zu operations\n", case_seed, why, c.length,
+                   original, c.length);
+            PrintCase(&c, stdout);
+            free(c.ops);
+            return 1;
+        }
+    }
+    printf("%lu runs, %lu operations: engines agree\n", runs, operations);
+    free(c.ops);
+    return 0;
+}
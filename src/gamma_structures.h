@@ -9,19 +9,43 @@
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdatomic.h>
 
 /**
- * @brief Struktura przechowująca parametry jednego pola planszy
- * oraz parametry potrzebne do zastosownia Union-Find:
+ * @brief Struktura przechowująca parametry pola planszy potrzebne do
+ * zastosownia Union-Find. Numery graczy zajmujących pola trzymane są
+ * osobno, w tablicy właścicieli kafelka.
+ * Pola planszy numerowane są wierszami, pole (x, y) ma indeks y * width + x,
+ * i trzymane są w kafelkach po @ref TILE_FIELDS kolejnych pól.
  */
 typedef struct board_element {
-    uint32_t player_number; /**< numer gracza obecnego na polu */
-    uint32_t parent_x;      /**< współrzędna x ojca pola */
-    uint32_t parent_y;      /**< spółrzędna y ojca pola */
-    uint64_t size;          /**< wartość size pola potrzebna do Union-Find */
-    bool visited;           /**< zmienna potrzebna do bfs */
+    uint32_t parent;        /**< indeks ojca pola */
+    uint8_t rank;           /**< ranga pola potrzebna do Union-Find */
 } board_element;
 
+/** @brief Liczba bitów indeksu pola wyznaczających pole w kafelku. */
+#define TILE_BITS 12
+/** @brief Liczba pól w pełnym kafelku planszy. */
+#define TILE_FIELDS ((uint32_t)1 << TILE_BITS)
+
+/**
+ * @brief Struktura przechowująca kolejne pola planszy.
+ * Za nagłówkiem leży tablica właścicieli pól, po @p owner_bytes bajtów na
+ * pole, a od pozycji @p elements_offset tablica pól Union-Find
+ * @ref board_element. Obie mają @p tile_capacity pozycji, pole o indeksie
+ * @p i leży na pozycji @p i % @ref TILE_FIELDS. Przeglądanie planszy
+ * odczytuje tylko gęstą tablicę właścicieli.
+ * Kafelek może być używany przez kilka kopii gry utworzonych przez
+ * @ref gamma_clone i jest kopiowany dopiero przy pierwszej zmianie.
+ */
+typedef struct board_tile {
+    atomic_uint_least32_t references; /**< liczba gier używających kafelka;
+                                        *  nieużywana dla kafelków
+                                        *  wczytanego pliku */
+    unsigned char owners[];           /**< numery graczy zajmujących pola,
+                                        *  0 dla wolnego pola */
+} board_tile;
+
 /**
  * @brief Struktura przechowująca stan pojedyńczego gracza.
  */
@@ -29,6 +53,8 @@ typedef struct one_player {
 
     uint32_t number_of_areas; /**< aktualna liczba obszarów */
     uint64_t busy_fields;     /**< ilość pól zajmowanych przez gracza */
+    uint64_t adjacent_free_fields; /**< ilość wolnych pól sąsiadujących
+                                     *  z polami gracza */
     bool gold_possible;       /**< zmienna mówiąca czy gracz może wykonać
                                 *  złoty ruch */
 
@@ -39,7 +65,55 @@ typedef struct one_player {
  */
 typedef struct gamma {
 
-    board_element **board; /**< dwuwymiarowa tablica elementów planszy */
+    board_tile **tiles;    /**< kafelki planszy, pole o indeksie @p i leży
+                             *  w kafelku o numerze @p i / @ref TILE_FIELDS */
+    uint32_t tiles_count;  /**< liczba kafelków planszy */
+    uint32_t tile_capacity;/**< liczba pozycji w każdym kafelku */
+    uint32_t elements_offset; /**< położenie tablicy pól Union-Find
+                                *  w kafelku */
+    uint8_t owner_bytes;   /**< liczba bajtów numeru gracza w tablicy
+                             *  właścicieli: 1, 2 lub 4 */
+    bool shared_tiles;     /**< czy gra mogła współdzielić kafelki z inną
+                             *  kopią gry */
+    struct board_mapping *mapping; /**< odwzorowany w pamięci plik, w którym
+                                     *  leżą kafelki wczytanej gry, NULL gdy
+                                     *  gra nie została wczytana */
+
+    uint32_t *visited;     /**< znaczniki odwiedzenia pól potrzebne do
+                             *  przechodzenia obszarów, pole jest odwiedzone
+                             *  gdy jego znacznik równy jest @p generation;
+                             *  alokowane przy pierwszym użyciu */
+    uint32_t *queue;       /**< bufor pól do odwiedzenia przy przechodzeniu
+                             *  obszarów, alokowany przy pierwszym użyciu */
+    uint32_t generation;   /**< numer aktualnego przechodzenia obszarów */
+
+    uint32_t *discovery;   /**< czasy odwiedzenia pól przy wyznaczaniu
+                             *  punktów artykulacji, alokowane przy
+                             *  pierwszym użyciu */
+    uint32_t *low;         /**< wartości low algorytmu Tarjana, alokowane
+                             *  przy pierwszym użyciu */
+    uint8_t *dfs_state;    /**< stan pól na stosie przeszukiwania w głąb,
+                             *  alokowany przy pierwszym użyciu */
+
+    struct journal *journal; /**< dziennik zmian pozwalający cofać ruchy,
+                               *  NULL gdy dziennik jest wyłączony */
+    struct legal_index *legal; /**< indeks pól, na których gracze mogą
+                                 *  wykonać ruch, budowany przy pierwszym
+                                 *  zapytaniu, NULL gdy go nie ma */
+    struct active_players *active; /**< zbiór graczy, którzy mogą wykonać
+                                     *  ruch, budowany przy pierwszym
+                                     *  zapytaniu, NULL gdy go nie ma */
+
+    struct gamma_arena *arena; /**< arena, z której pochodzi cała pamięć
+                                 *  gry, NULL gdy pamięć alokowana jest
+                                 *  funkcją malloc */
+    struct gamma_pool *pool;   /**< pula, w której leży gra i do której
+                                 *  wraca po usunięciu, NULL gdy gra nie
+                                 *  pochodzi z puli */
+
+    uint32_t query_threads;  /**< liczba wątków przeglądających planszę
+                               *  w zapytaniach, ustawiana przez
+                               *  @ref gamma_set_query_threads */
 
     uint64_t free_fields_under_max_areas;/**< zmienna do zliczania wolnych pól
                                              * dla graczy którzy mają mniej
@@ -56,4 +130,102 @@ typedef struct gamma {
     uint32_t max_areas;                  /**< maksymalna ilość obszarów */
 } gamma_t;
 
+/** @brief Podaje indeks pola (@p x, @p y) na planszy.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
+ *                      @p g->width,
+ * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
+ *                      @p g->height.
+ * @return Indeks pola (@p x, @p y).
+ */
+static inline uint32_t BoardIndex(const gamma_t *g, uint32_t x, uint32_t y) {
+    return y * g->width + x;
+}
+
+/** @brief Podaje numer gracza zajmującego pole o indeksie @p i.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * Numer spoza zakresu, możliwy tylko w uszkodzonym wczytanym pliku, jest
+ * podawany jak wolne pole, bo numery graczy są używane jako indeksy tablic.
+ * @return Numer gracza lub 0 dla wolnego pola.
+ */
+static inline uint32_t Owner(const gamma_t *g, uint32_t i) {
+    const unsigned char *owners = g->tiles[i >> TILE_BITS]->owners;
+    uint32_t k = i & (TILE_FIELDS - 1);
+    uint32_t owner;
+
+    switch(g->owner_bytes) {
+        case 1:
+            owner = owners[k];
+            break;
+        case 2:
+            owner = ((const uint16_t *)owners)[k];
+            break;
+        default:
+            owner = ((const uint32_t *)owners)[k];
+            break;
+    }
+    return owner <= g->number_of_players ? owner : 0;
+}
+
+/** @brief Podaje pole Union-Find o indeksie @p i do odczytu.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * @return Wskaźnik na pole o indeksie @p i.
+ */
+static inline const board_element *Element(const gamma_t *g, uint32_t i) {
+    const char *tile = (const char *)g->tiles[i >> TILE_BITS];
+    return (const board_element *)(tile + g->elements_offset)
+           + (i & (TILE_FIELDS - 1));
+}
+
+/** @brief Wyznacza indeksy pól sąsiadujących z polem (@p x, @p y).
+ * @param[in] g           – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] x           – numer kolumny, liczba nieujemna mniejsza od
+ *                          wartości @p g->width,
+ * @param[in] y           – numer wiersza, liczba nieujemna mniejsza od
+ *                          wartości @p g->height,
+ * @param[out] neighbours – tablica o rozmiarze co najmniej 4, do której
+ *                          zapisane zostaną indeksy sąsiadów.
+ * @return Liczba sąsiadów pola (@p x, @p y).
+ */
+static inline int Neighbours(const gamma_t *g, uint32_t x, uint32_t y,
+                             uint32_t neighbours[4]) {
+    uint32_t i = BoardIndex(g, x, y);
+    int count = 0;
+
+    if(x > 0) {
+        neighbours[count++] = i - 1;
+    }
+    if(x + 1 < g->width) {
+        neighbours[count++] = i + 1;
+    }
+    if(y > 0) {
+        neighbours[count++] = i - g->width;
+    }
+    if(y + 1 < g->height) {
+        neighbours[count++] = i + g->width;
+    }
+    return count;
+}
+
+/** @brief Sprawdza czy pole o indeksie @p i zostało odwiedzone w aktualnym
+ * przechodzeniu obszarów.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * @return Wartość @p true, jeśli pole zostało odwiedzone.
+ */
+static inline bool IsVisited(const gamma_t *g, uint32_t i) {
+    return g->visited[i] == g->generation;
+}
+
+/** @brief Oznacza pole o indeksie @p i jako odwiedzone w aktualnym
+ * przechodzeniu obszarów.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ */
+static inline void SetVisited(gamma_t *g, uint32_t i) {
+    g->visited[i] = g->generation;
+}
+
 #endif //GAMMASTRUCTURES_H
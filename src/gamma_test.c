@@ -12,10 +12,13 @@
 #endif
 
 #include "gamma.h"
+#include "batch_io.h"
+#include "scan_gamma.h"
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 /**
  * Tak ma wyglądać plansza po wykonaniu wszystkich testów.
@@ -32,6 +35,1113 @@ static const char board[] =
   "1221......\n"
   "1.........\n";
 
+/** @brief Sprawdza czy plansza ma oczekiwany wygląd.
+ * @param[in] g        – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] expected – oczekiwany napis opisujący planszę.
+ * @return Wartość @p true, jeśli napisy są równe.
+ */
+static bool board_equals(gamma_t *g, const char *expected) {
+  char *p = gamma_board(g);
+  bool equal = p != NULL && strcmp(p, expected) == 0;
+  free(p);
+  return equal;
+}
+
+/** @brief Podaje łączną liczbę pól zajętych przez graczy.
+ * @param[in] g        – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] players  – liczba graczy.
+ * @return Suma wyników @ref gamma_busy_fields.
+ */
+static uint64_t total_busy(gamma_t *g, uint32_t players) {
+  uint64_t result = 0;
+  for (uint32_t p = 1; p <= players; p++)
+    result += gamma_busy_fields(g, p);
+  return result;
+}
+
+/** @brief Testuje cofanie i powtarzanie ruchów.
+ * Wykonuje pseudolosowe ruchy i złote ruchy, zapamiętując stan planszy po
+ * każdym z nich, po czym cofa i powtarza wszystkie ruchy, porównując stany.
+ */
+static void journal_test(void) {
+  enum { MOVES = 150 };
+  static char *states[MOVES + 1];
+  static uint64_t busy[MOVES + 1];
+  static uint64_t free_fields[MOVES + 1];
+  gamma_t *g = gamma_new(12, 11, 3, 4);
+  assert(g != NULL);
+  assert(!gamma_undo(g));
+  assert(gamma_journal_enable(g, true));
+  assert(!gamma_undo(g));
+  assert(!gamma_redo(g));
+
+  unsigned seed = 12345;
+  int done = 0;
+  int attempts = 0;
+  states[0] = gamma_board(g);
+  busy[0] = 0;
+  free_fields[0] = gamma_free_fields(g, 2);
+  while (done < MOVES && attempts++ < 100000) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t player = 1 + (seed >> 8) % 3;
+    uint32_t x = (seed >> 12) % 12;
+    uint32_t y = (seed >> 18) % 11;
+    bool golden = (seed >> 24) % 6 == 0;
+    if (golden ? !gamma_golden_move(g, player, x, y)
+               : !gamma_move(g, player, x, y))
+      continue;
+    done++;
+    states[done] = gamma_board(g);
+    busy[done] = total_busy(g, 3);
+    free_fields[done] = gamma_free_fields(g, 2);
+    if (done % 50 == 0) {
+      // cofnięcie i powtórzenie ruchu nie zmienia stanu gry
+      assert(gamma_undo(g));
+      assert(board_equals(g, states[done - 1]));
+      assert(gamma_redo(g));
+      assert(board_equals(g, states[done]));
+    }
+  }
+
+  assert(done > 100);
+  for (int k = done; k > 0; k--) {
+    assert(board_equals(g, states[k]));
+    assert(total_busy(g, 3) == busy[k]);
+    assert(gamma_free_fields(g, 2) == free_fields[k]);
+    assert(gamma_undo(g));
+  }
+  assert(!gamma_undo(g));
+  assert(board_equals(g, states[0]));
+  assert(total_busy(g, 3) == 0);
+  for (int k = 1; k <= done; k++) {
+    assert(gamma_redo(g));
+    assert(board_equals(g, states[k]));
+    assert(total_busy(g, 3) == busy[k]);
+    assert(gamma_free_fields(g, 2) == free_fields[k]);
+  }
+  assert(!gamma_redo(g));
+
+  // nowy ruch po cofnięciu uniemożliwia powtórzenie cofniętego ruchu
+  while (gamma_undo(g) && !gamma_move(g, 1, 0, 0))
+    ;
+  assert(!gamma_redo(g));
+  gamma_journal_enable(g, false);
+  assert(!gamma_undo(g));
+
+  for (int k = 0; k <= done; k++)
+    free(states[k]);
+  gamma_delete(g);
+
+  // odrzucony złoty ruch przywraca odłączony obszar i nie zmienia tego,
+  // co cofa poprzedni ruch
+  g = gamma_new(5, 1, 2, 1);
+  assert(g != NULL);
+  assert(gamma_journal_enable(g, true));
+  for (uint32_t x = 0; x < 4; x++)
+    assert(gamma_move(g, 1, x, 0));
+  char *before = gamma_board(g);
+  assert(gamma_move(g, 2, 4, 0));
+  char *after = gamma_board(g);
+  assert(!gamma_golden_move(g, 2, 1, 0));
+  assert(board_equals(g, after));
+  assert(gamma_undo(g));
+  assert(board_equals(g, before));
+  assert(gamma_free_fields(g, 2) == 1);
+  assert(gamma_redo(g));
+  assert(board_equals(g, after));
+  assert(!gamma_golden_move(g, 2, 2, 0));
+  assert(gamma_golden_move(g, 2, 3, 0));
+  for (int k = 0; k < 6; k++)
+    assert(gamma_undo(g));
+  assert(!gamma_undo(g));
+  assert(total_busy(g, 2) == 0);
+  free(before);
+  free(after);
+  gamma_delete(g);
+}
+
+/** @brief Wykonuje pseudolosowy ruch lub złoty ruch w dwóch grach.
+ * @param[in,out] a    – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in,out] b    – wskaźnik na strukturę drugiej gry lub NULL,
+ * @param[in,out] seed – stan generatora liczb pseudolosowych.
+ */
+static void random_move(gamma_t *a, gamma_t *b, unsigned *seed) {
+  *seed = *seed * 1103515245 + 12345;
+  uint32_t player = 1 + (*seed >> 8) % 3;
+  uint32_t x = (*seed >> 12) % 100;
+  uint32_t y = (*seed >> 19) % 90;
+  if ((*seed >> 26) % 8 == 0) {
+    bool done = gamma_golden_move(a, player, x, y);
+    assert(b == NULL || gamma_golden_move(b, player, x, y) == done);
+  } else {
+    bool done = gamma_move(a, player, x, y);
+    assert(b == NULL || gamma_move(b, player, x, y) == done);
+  }
+}
+
+/** @brief Sprawdza czy dwie gry są w tym samym stanie.
+ * @param[in] a       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] b       – wskaźnik na strukturę drugiej gry.
+ */
+static void assert_same(gamma_t *a, gamma_t *b) {
+  char *p = gamma_board(a);
+  assert(board_equals(b, p));
+  free(p);
+  for (uint32_t player = 1; player <= 3; player++) {
+    assert(gamma_busy_fields(a, player) == gamma_busy_fields(b, player));
+    assert(gamma_free_fields(a, player) == gamma_free_fields(b, player));
+    assert(gamma_golden_possible(a, player) ==
+           gamma_golden_possible(b, player));
+  }
+}
+
+/** @brief Testuje kopiowanie stanu gry.
+ * Kopie są rozwijane niezależnie i porównywane z grami, w których te same
+ * ruchy wykonano bez kopiowania.
+ */
+static void clone_test(void) {
+  assert(gamma_clone(NULL) == NULL);
+
+  gamma_t *g = gamma_new(100, 90, 3, 40);
+  gamma_t *g_reference = gamma_new(100, 90, 3, 40);
+  assert(g != NULL && g_reference != NULL);
+  unsigned seed = 777;
+  for (int k = 0; k < 3000; k++)
+    random_move(g, g_reference, &seed);
+
+  gamma_t *c = gamma_clone(g);
+  assert(c != NULL);
+  assert_same(c, g_reference);
+  gamma_t *c_reference = gamma_clone(g_reference);
+  assert(c_reference != NULL);
+
+  // zmiany kopii nie zmieniają oryginału i na odwrót
+  for (int k = 0; k < 2000; k++)
+    random_move(c, c_reference, &seed);
+  assert_same(g, g_reference);
+  for (int k = 0; k < 2000; k++)
+    random_move(g, g_reference, &seed);
+  assert_same(c, c_reference);
+  assert_same(g, g_reference);
+
+  // kopia kopii przeżywa usunięcie gier, z których powstała
+  gamma_t *cc = gamma_clone(c);
+  assert(cc != NULL);
+  gamma_delete(c);
+  gamma_delete(g);
+  for (int k = 0; k < 2000; k++)
+    random_move(cc, c_reference, &seed);
+  assert_same(cc, c_reference);
+
+  // cofanie ruchu kopiuje współdzielone fragmenty planszy
+  gamma_t *u = gamma_clone(cc);
+  assert(u != NULL);
+  assert(gamma_journal_enable(cc, true));
+  char *before = gamma_board(cc);
+  for (int k = 0; k < 200; k++)
+    random_move(cc, NULL, &seed);
+  while (gamma_undo(cc))
+    ;
+  assert(board_equals(cc, before));
+  assert_same(u, c_reference);
+  free(before);
+
+  gamma_delete(u);
+  gamma_delete(cc);
+  gamma_delete(c_reference);
+  gamma_delete(g_reference);
+}
+
+/** @brief Testuje zapisywanie i wczytywanie stanu gry.
+ * Wczytana gra, jej kopie i gra zapisana są rozwijane tymi samymi ruchami.
+ */
+static void save_test(void) {
+  const char *path = "gamma_test_save.bin";
+  assert(gamma_load("gamma_test_missing.bin") == NULL);
+  assert(!gamma_save(NULL, path));
+
+  gamma_t *g = gamma_new(100, 90, 3, 40);
+  assert(g != NULL);
+  unsigned seed = 4242;
+  for (int k = 0; k < 3000; k++)
+    random_move(g, NULL, &seed);
+
+  assert(gamma_save(g, path));
+  gamma_t *l = gamma_load(path);
+  assert(l != NULL);
+  assert_same(l, g);
+  gamma_t *c = gamma_clone(l);
+  assert(c != NULL);
+
+  // zmiany wczytanej gry nie trafiają do pliku
+  for (int k = 0; k < 2000; k++)
+    random_move(l, g, &seed);
+  assert_same(l, g);
+  gamma_t *again = gamma_load(path);
+  assert(again != NULL);
+  assert_same(again, c);
+
+  // nadpisanie pliku nie psuje gier, które go wczytały
+  assert(gamma_save(l, path));
+  gamma_delete(l);
+  for (int k = 0; k < 2000; k++)
+    random_move(c, again, &seed);
+  assert_same(c, again);
+  l = gamma_load(path);
+  assert(l != NULL);
+  assert_same(l, g);
+  gamma_delete(l);
+
+  // plik z innym nagłówkiem lub obcięty nie jest wczytywany
+  FILE *file = fopen(path, "r+b");
+  assert(file != NULL);
+  assert(fputc('X', file) == 'X');
+  assert(fclose(file) == 0);
+  assert(gamma_load(path) == NULL);
+  file = fopen(path, "wb");
+  assert(file != NULL);
+  assert(fputs("GAMMASAV", file) >= 0);
+  assert(fclose(file) == 0);
+  assert(gamma_load(path) == NULL);
+
+  // plansza nie jest sprawdzana przy wczytaniu, a wczytana gra
+  // z uszkodzonym dowolnym bajtem kafelków lub innym bajtem przyjętym
+  // przez sprawdzenie nagłówka nie wychodzi poza planszę, również w kopii
+  gamma_t *small = gamma_new(3, 2, 2, 2);
+  assert(small != NULL);
+  assert(gamma_move(small, 1, 0, 0));
+  assert(gamma_move(small, 1, 1, 0));
+  assert(gamma_move(small, 2, 2, 1));
+  assert(gamma_move(small, 1, 0, 1));
+  assert(gamma_save(small, path));
+  char *small_board = gamma_board(small);
+  assert(small_board != NULL);
+  file = fopen(path, "rb");
+  assert(file != NULL);
+  char saved[8192];
+  size_t length = fread(saved, 1, sizeof(saved), file);
+  assert(fclose(file) == 0);
+  assert(length > 4096 && length < sizeof(saved));
+  for (size_t k = 0; k < length; k++) {
+    saved[k] ^= 0x80;
+    file = fopen(path, "wb");
+    assert(file != NULL);
+    assert(fwrite(saved, 1, length, file) == length);
+    assert(fclose(file) == 0);
+    saved[k] ^= 0x80;
+    gamma_t *corrupted = gamma_load(path);
+    // kafelki planszy zaczynają się od pozycji 4096
+    assert(corrupted != NULL || k < 4096);
+    if (corrupted == NULL)
+      continue;
+    gamma_t *copy = gamma_clone(corrupted);
+    assert(copy != NULL);
+    for (uint32_t x = 0; x < 3; x++)
+      for (uint32_t y = 0; y < 2; y++) {
+        gamma_golden_possible(copy, 1 + x % 2);
+        gamma_golden_move(copy, 1 + x % 2, x, y);
+        gamma_move(copy, 2 - y, x, y);
+      }
+    free(gamma_board(copy));
+    gamma_delete(copy);
+    // licznik użyć zapisany w nagłówku kafelka (4 bajty) nie jest czytany,
+    // więc ruchy kopii nie zmieniają wczytanej gry
+    if (k < 4096 + 4) {
+      char *board = gamma_board(corrupted);
+      assert(board != NULL && strcmp(board, small_board) == 0);
+      free(board);
+    }
+    for (uint32_t x = 0; x < 3; x++)
+      for (uint32_t y = 0; y < 2; y++) {
+        gamma_golden_possible(corrupted, 1 + x % 2);
+        gamma_golden_move(corrupted, 1 + x % 2, x, y);
+        gamma_move(corrupted, 2 - y, x, y);
+      }
+    free(gamma_board(corrupted));
+    gamma_delete(corrupted);
+  }
+  free(small_board);
+  file = fopen(path, "wb");
+  assert(file != NULL);
+  assert(fwrite(saved, 1, length - 1, file) == length - 1);
+  assert(fclose(file) == 0);
+  assert(gamma_load(path) == NULL);
+  gamma_delete(small);
+  assert(remove(path) == 0);
+
+  gamma_delete(again);
+  gamma_delete(c);
+  gamma_delete(g);
+}
+
+/**
+ * Bufor składający fragmenty napisu przekazane przez gamma_board_stream.
+ */
+typedef struct collected {
+  char *text;
+  size_t length;
+  int chunks;
+} collected;
+
+/** @brief Dopisuje fragment napisu do bufora.
+ * @param[in] chunk       – fragment napisu,
+ * @param[in] length      – długość fragmentu,
+ * @param[in,out] context – wskaźnik na bufor typu collected.
+ * @return Wartość @p true.
+ */
+static bool collect(const char *chunk, size_t length, void *context) {
+  collected *c = context;
+  c->text = realloc(c->text, c->length + length + 1);
+  assert(c->text != NULL);
+  memcpy(c->text + c->length, chunk, length);
+  c->length += length;
+  c->text[c->length] = '\0';
+  c->chunks++;
+  return true;
+}
+
+/** @brief Odmawia przyjęcia fragmentu napisu.
+ * @param[in] chunk       – fragment napisu,
+ * @param[in] length      – długość fragmentu,
+ * @param[in,out] context – nieużywany wskaźnik.
+ * @return Wartość @p false.
+ */
+static bool refuse(const char *chunk, size_t length, void *context) {
+  (void)chunk;
+  (void)length;
+  (void)context;
+  return false;
+}
+
+/** @brief Testuje wypisywanie planszy we fragmentach.
+ * Napis złożony z fragmentów i napis zapisany do pliku muszą być równe
+ * wynikowi gamma_board, także dla wielocyfrowych numerów graczy.
+ */
+static void board_stream_test(void) {
+  gamma_t *g = gamma_new(400, 300, 123, 50);
+  assert(g != NULL);
+  unsigned seed = 99;
+  for (int k = 0; k < 60000; k++) {
+    seed = seed * 1103515245 + 12345;
+    gamma_move(g, 1 + (seed >> 8) % 123, (seed >> 12) % 400,
+               (seed >> 20) % 300);
+  }
+
+  char *p = gamma_board(g);
+  assert(p != NULL);
+  collected c = {NULL, 0, 0};
+  assert(gamma_board_stream(g, collect, &c));
+  assert(c.chunks > 1);
+  assert(c.length == strlen(p) && strcmp(c.text, p) == 0);
+  assert(!gamma_board_stream(g, refuse, NULL));
+  assert(!gamma_board_stream(NULL, collect, &c));
+
+  FILE *file = tmpfile();
+  assert(file != NULL);
+  assert(gamma_board_write(g, file));
+  assert(ftell(file) == (long)c.length);
+  rewind(file);
+  for (size_t k = 0; k < c.length; k++)
+    assert(fgetc(file) == p[k]);
+  assert(fclose(file) == 0);
+
+  free(c.text);
+  free(p);
+  gamma_delete(g);
+}
+
+/** @brief Testuje gry biorące pamięć z areny.
+ * Gry z areny, ich kopie i dzienniki są rozwijane razem z grami
+ * alokowanymi zwykle, a pamięć usuniętych gier jest używana ponownie.
+ */
+static void arena_test(void) {
+  gamma_arena *arena = gamma_arena_new();
+  assert(arena != NULL);
+  assert(gamma_new_in(arena, 0, 10, 2, 2) == NULL);
+
+  unsigned seed = 4242;
+  for (int round = 0; round < 20; round++) {
+    gamma_t *g = gamma_new_in(arena, 100, 90, 3, 30);
+    gamma_t *g_reference = gamma_new(100, 90, 3, 30);
+    assert(g != NULL && g_reference != NULL);
+    assert(gamma_journal_enable(g, true));
+    for (int k = 0; k < 1000; k++)
+      random_move(g, g_reference, &seed);
+    assert_same(g, g_reference);
+
+    gamma_t *c = gamma_clone(g);
+    assert(c != NULL);
+    for (int k = 0; k < 500; k++)
+      random_move(c, g_reference, &seed);
+    gamma_delete(g);
+    assert_same(c, g_reference);
+
+    gamma_delete(c);
+    gamma_delete(g_reference);
+  }
+  gamma_arena_delete(arena);
+  gamma_arena_delete(NULL);
+}
+
+/** @brief Testuje pulę gier.
+ * Gry z puli są rozwijane razem z grami utworzonymi przez gamma_new,
+ * także po ponownym użyciu ich miejsc i gdy ich kopie przeżywają
+ * oddanie gry do puli.
+ */
+static void pool_test(void) {
+  assert(gamma_pool_new(100, 0, 3, 30) == NULL);
+  assert(gamma_pool_acquire(NULL) == NULL);
+  gamma_pool *pool = gamma_pool_new(100, 90, 3, 30);
+  assert(pool != NULL);
+
+  unsigned seed = 31337;
+  gamma_t *previous = NULL;
+  for (int round = 0; round < 10; round++) {
+    gamma_t *g = gamma_pool_acquire(pool);
+    gamma_t *g_reference = gamma_new(100, 90, 3, 30);
+    assert(g != NULL && g_reference != NULL);
+    // zwolnione miejsce jest używane ponownie
+    assert(previous == NULL || g == previous);
+    assert_same(g, g_reference);
+    for (int k = 0; k < 1500; k++)
+      random_move(g, g_reference, &seed);
+    assert_same(g, g_reference);
+    if (round % 3 == 0)
+      assert(gamma_journal_enable(g, true));
+    // struktury tworzone przy pierwszym użyciu są zwalniane razem z grą
+    if (round % 2 == 0) {
+      assert(gamma_legal_moves(g, 1, NULL, 0) == gamma_free_fields(g, 1));
+      assert(gamma_next_active_player(g, 0) != 0);
+    }
+    previous = g;
+    gamma_pool_release(g);
+    gamma_delete(g_reference);
+  }
+
+  // kopia zatrzymuje miejsce gry w puli do swojego usunięcia
+  gamma_t *g = gamma_pool_acquire(pool);
+  gamma_t *g_reference = gamma_new(100, 90, 3, 30);
+  assert(g != NULL && g_reference != NULL);
+  for (int k = 0; k < 1500; k++)
+    random_move(g, g_reference, &seed);
+  gamma_t *c = gamma_clone(g);
+  assert(c != NULL);
+  for (int k = 0; k < 500; k++)
+    random_move(g, NULL, &seed);
+  gamma_delete(g);
+  gamma_t *other = gamma_pool_acquire(pool);
+  assert(other != NULL && other != g);
+  for (int k = 0; k < 1500; k++)
+    random_move(other, NULL, &seed);
+  assert_same(c, g_reference);
+  for (int k = 0; k < 500; k++)
+    random_move(c, g_reference, &seed);
+  assert_same(c, g_reference);
+  gamma_delete(c);
+  gamma_pool_release(other);
+  gamma_delete(g_reference);
+
+  gamma_pool_delete(pool);
+  gamma_pool_delete(NULL);
+}
+
+/** @brief Testuje gry, w których numery graczy zajmują w tablicy
+ * właścicieli pól jeden, dwa lub cztery bajty: ruchy, złote ruchy,
+ * cofanie ruchów i zapis do pliku zachowują numery graczy.
+ */
+static void owners_test(void) {
+  static const uint32_t counts[] = {255, 256, 65535, 65536, 70000};
+  const char *path = "gamma_test_owners.bin";
+  char expected[64], golden[64];
+
+  for (size_t k = 0; k < sizeof(counts) / sizeof(counts[0]); k++) {
+    uint32_t p = counts[k];
+    gamma_t *g = gamma_new(3, 2, p, 2);
+    assert(g != NULL);
+    assert(gamma_journal_enable(g, true));
+    assert(gamma_move(g, p, 0, 0));
+    assert(gamma_move(g, p, 1, 0));
+    assert(gamma_move(g, 1, 2, 1));
+    assert(!gamma_move(g, p + 1, 2, 0));
+    assert(gamma_busy_fields(g, p) == 2);
+    snprintf(expected, sizeof(expected), "..1\n%u%u.\n", p, p);
+    assert(board_equals(g, expected));
+
+    assert(gamma_golden_move(g, 1, 0, 0));
+    assert(gamma_busy_fields(g, p) == 1);
+    snprintf(golden, sizeof(golden), "..1\n1%u.\n", p);
+    assert(board_equals(g, golden));
+    assert(gamma_undo(g));
+    assert(board_equals(g, expected));
+
+    assert(gamma_save(g, path));
+    gamma_t *l = gamma_load(path);
+    assert(l != NULL);
+    assert(board_equals(l, expected));
+    assert(gamma_busy_fields(l, p) == 2);
+    assert(gamma_move(l, p, 2, 0));
+    assert(gamma_busy_fields(l, p) == 3);
+    gamma_delete(l);
+    assert(remove(path) == 0);
+    gamma_delete(g);
+  }
+}
+
+/** @brief Testuje wersje przeglądania wierszy dla różnych zestawów
+ * instrukcji. Te same pseudolosowe ruchy są wykonywane na osobnej grze dla
+ * każdej dostępnej wersji (@ref SetScanLevel) na planszach o nieparzystych
+ * szerokościach, także z dwubajtowymi numerami graczy, a liczby wolnych pól,
+ * możliwość złotego ruchu i opis planszy muszą być takie same.
+ */
+static void scan_levels_test(void) {
+  static const uint32_t widths[] = {1, 15, 17, 31, 33, 513};
+  static const uint32_t players[] = {3, 300};
+  scan_level selected = ScanLevel();
+  uint64_t seed = 5;
+  for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+    for (size_t p = 0; p < sizeof(players) / sizeof(players[0]); p++) {
+      uint32_t width = widths[w], height = 5, n = players[p];
+      gamma_t *games[SCAN_AVX2 + 1] = {NULL};
+      for (scan_level level = SCAN_SCALAR; level <= SCAN_AVX2; level++)
+        if (SetScanLevel(level)) {
+          games[level] = gamma_new(width, height, n, 2);
+          assert(games[level] != NULL);
+        }
+      for (uint32_t step = 0; step < 2 * width * height; step++) {
+        seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+        uint32_t player = (uint32_t)(seed >> 33) % 3 + 1;
+        uint32_t x = (uint32_t)(seed >> 40) % width;
+        uint32_t y = (uint32_t)(seed >> 20) % height;
+        bool golden = (seed >> 59) == 0;
+        bool moved = gamma_move(games[SCAN_SCALAR], player, x, y)
+                     || (golden && gamma_golden_move(games[SCAN_SCALAR],
+                                                     player, x, y));
+        bool check = step % 7 == 0 || step + 1 == 2 * width * height;
+        char *expected = check ? gamma_board(games[SCAN_SCALAR]) : NULL;
+        for (scan_level level = SCAN_SSE2; level <= SCAN_AVX2; level++) {
+          gamma_t *g = games[level];
+          if (g == NULL)
+            continue;
+          assert(SetScanLevel(level));
+          assert((gamma_move(g, player, x, y)
+                  || (golden && gamma_golden_move(g, player, x, y)))
+                 == moved);
+          for (uint32_t q = 1; q <= 3; q++) {
+            assert(gamma_free_fields(g, q)
+                   == gamma_free_fields(games[SCAN_SCALAR], q));
+            if (check) {
+              bool possible = gamma_golden_possible(g, q);
+              assert(SetScanLevel(SCAN_SCALAR));
+              assert(possible
+                     == gamma_golden_possible(games[SCAN_SCALAR], q));
+              assert(SetScanLevel(level));
+            }
+          }
+          if (check) {
+            char *actual = gamma_board(g);
+            assert(expected != NULL && actual != NULL);
+            assert(strcmp(actual, expected) == 0);
+            free(actual);
+          }
+        }
+        free(expected);
+        assert(SetScanLevel(SCAN_SCALAR));
+      }
+      for (scan_level level = SCAN_SCALAR; level <= SCAN_AVX2; level++)
+        gamma_delete(games[level]);
+    }
+  assert(SetScanLevel(selected));
+}
+
+/** @brief Sprawdza gamma_golden_possible przy kolejnych liczbach wątków.
+ * @param[in,out] g    – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player   – numer gracza,
+ * @param[in] expected – oczekiwany wynik.
+ */
+static void golden_in_threads(gamma_t *g, uint32_t player, bool expected) {
+  static const uint32_t threads[] = {1, 2, 3, 8, 1};
+  for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); k++) {
+    assert(gamma_set_query_threads(g, threads[k]));
+    assert(gamma_golden_possible(g, player) == expected);
+  }
+}
+
+/** @brief Testuje przeglądanie dużej planszy kilkoma wątkami.
+ * Gracz 2 ma jedyny obszar w dolnym wierszu, a jedynym kandydatem na pole
+ * jego złotego ruchu jest pole pierścienia gracza 3, dla którego trzeba
+ * przejść cały obszar.
+ */
+static void query_threads_test(void) {
+  assert(!gamma_set_query_threads(NULL, 2));
+  gamma_t *g = gamma_new(1024, 1024, 3, 1);
+  assert(g != NULL);
+  assert(!gamma_set_query_threads(g, 0));
+  assert(!gamma_set_query_threads(g, GAMMA_MAX_QUERY_THREADS + 1));
+
+  for (uint32_t y = 0; y <= 1018; y++)
+    for (uint32_t x = 0; x < 1024; x++)
+      assert(gamma_move(g, 1, x, y));
+  assert(gamma_move(g, 2, 2, 1023));
+  golden_in_threads(g, 1, false);
+  golden_in_threads(g, 2, false);
+
+  static const uint32_t ring[][2] = {{1, 1020}, {2, 1020}, {3, 1020},
+                                     {3, 1021}, {3, 1022}, {2, 1022},
+                                     {1, 1022}, {1, 1021}};
+  for (size_t k = 0; k < sizeof(ring) / sizeof(ring[0]); k++)
+    assert(gamma_move(g, 3, ring[k][0], ring[k][1]));
+  golden_in_threads(g, 1, false);
+  golden_in_threads(g, 2, true);
+  golden_in_threads(g, 3, true);
+
+  assert(gamma_set_query_threads(g, 4));
+  gamma_t *c = gamma_clone(g);
+  assert(c != NULL);
+  assert(gamma_golden_possible(c, 2));
+  assert(gamma_golden_move(c, 2, 2, 1022));
+  assert(!gamma_golden_possible(c, 2));
+  golden_in_threads(c, 3, true);
+  gamma_delete(c);
+  gamma_delete(g);
+}
+
+/** @brief Testuje wypisywanie liczników pracy silnika.
+ * W wersji z GAMMA_STATS opis musi uwzględniać ruchy wykonane przez
+ * wcześniejsze testy, a bez tej opcji wypisywanie ma się nie udawać.
+ */
+static void stats_test(void) {
+  collected text = {NULL, 0, 0};
+  bool written = gamma_stats_stream(collect, &text);
+#ifdef GAMMA_STATS
+  assert(written);
+  assert(text.text != NULL && strstr(text.text, "union_calls ") != NULL);
+  const char *moves = strstr(text.text, "gamma_move_ns count ");
+  assert(moves != NULL);
+  assert(strtoull(moves + strlen("gamma_move_ns count "), NULL, 10) > 0);
+  assert(!gamma_stats_stream(refuse, NULL));
+#else
+  assert(!written && text.text == NULL);
+#endif
+  assert(!gamma_stats_stream(NULL, NULL));
+  free(text.text);
+}
+
+/** @brief Sprawdza pola zwracane przez gamma_legal_moves
+ * i gamma_random_legal_move z wynikiem prób ruchu na kopii gry.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] width   – szerokość planszy,
+ * @param[in] height  – wysokość planszy,
+ * @param[in] player  – numer gracza,
+ * @param[in,out] rng – stan generatora dla gamma_random_legal_move.
+ */
+static void check_legal(gamma_t *g, uint32_t width, uint32_t height,
+                        uint32_t player, uint64_t *rng) {
+  enum { MAX_FIELDS = 64 };
+  gamma_field moves[MAX_FIELDS];
+  bool listed[MAX_FIELDS] = {false};
+  uint64_t count = gamma_legal_moves(g, player, moves, MAX_FIELDS);
+  assert(count <= width * height);
+  for (uint64_t k = 0; k < count; k++) {
+    assert(moves[k].x < width && moves[k].y < height);
+    uint32_t i = moves[k].y * width + moves[k].x;
+    assert(!listed[i]);
+    listed[i] = true;
+  }
+
+  uint64_t expected = 0;
+  for (uint32_t y = 0; y < height; y++)
+    for (uint32_t x = 0; x < width; x++) {
+      gamma_t *c = gamma_clone(g);
+      assert(c != NULL);
+      bool legal = gamma_move(c, player, x, y);
+      assert(legal == listed[y * width + x]);
+      expected += legal;
+      gamma_delete(c);
+    }
+  assert(count == expected);
+  assert(gamma_legal_moves(g, player, NULL, 0) == count);
+  if (count > 1) {
+    assert(gamma_legal_moves(g, player, moves, 1) == count);
+  }
+
+  uint32_t x, y;
+  bool found = gamma_random_legal_move(g, player, rng, &x, &y);
+  assert(found == (count > 0));
+  if (found) {
+    assert(listed[y * width + x]);
+  }
+}
+
+/** @brief Testuje wyznaczanie pól, na których gracze mogą wykonać ruch,
+ * w trakcie losowej gry ze złotymi ruchami, kopiami gry i cofaniem ruchów.
+ */
+static void legal_moves_test(void) {
+  uint64_t rng = 7;
+  uint32_t x, y;
+  gamma_field field;
+  assert(gamma_legal_moves(NULL, 1, &field, 1) == 0);
+  assert(!gamma_random_legal_move(NULL, 1, &rng, &x, &y));
+
+  gamma_t *g = gamma_new(8, 7, 3, 2);
+  assert(g != NULL);
+  assert(gamma_legal_moves(g, 0, &field, 1) == 0);
+  assert(gamma_legal_moves(g, 4, &field, 1) == 0);
+  assert(gamma_legal_moves(g, 1, NULL, 1) == 0);
+  assert(!gamma_random_legal_move(g, 1, NULL, &x, &y));
+  assert(gamma_journal_enable(g, true));
+  check_legal(g, 8, 7, 1, &rng);
+
+  unsigned seed = 2024;
+  gamma_t *copy = NULL;
+  for (int step = 0; step < 300; step++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t player = 1 + (seed >> 8) % 3;
+    uint32_t kind = (seed >> 12) % 16;
+    if (kind == 0) {
+      gamma_undo(g);
+    } else if (kind == 1) {
+      gamma_golden_move(g, player, (seed >> 16) % 8, (seed >> 20) % 7);
+    } else if (kind == 2 && copy == NULL) {
+      copy = gamma_clone(g);
+      assert(copy != NULL);
+    } else if (gamma_random_legal_move(g, player, &rng, &x, &y)) {
+      assert(gamma_move(g, player, x, y));
+    }
+    for (uint32_t p = 1; p <= 3; p++)
+      check_legal(g, 8, 7, p, &rng);
+    if (copy != NULL && kind == 3) {
+      gamma_golden_move(copy, player, (seed >> 16) % 8, (seed >> 20) % 7);
+      check_legal(copy, 8, 7, player, &rng);
+    }
+  }
+  gamma_delete(copy);
+  gamma_delete(g);
+}
+
+/** @brief Testuje wybieranie ruchu przez bota.
+ * Wybrany ruch musi być legalny i powtarzalny w jednym wątku, a gdy gracz
+ * ma jeden ruch prowadzący do wygranej, bot musi go znaleźć.
+ */
+static void bot_test(void) {
+  gamma_bot_options options = {.threads = 1, .playouts = 200, .seed = 3};
+  gamma_bot_move move;
+  assert(!gamma_bot_suggest(NULL, 1, &options, &move));
+
+  gamma_t *g = gamma_new(5, 4, 2, 1);
+  assert(g != NULL);
+  assert(!gamma_bot_suggest(g, 0, &options, &move));
+  assert(!gamma_bot_suggest(g, 3, &options, &move));
+  assert(!gamma_bot_suggest(g, 1, NULL, &move));
+  options.threads = 0;
+  assert(!gamma_bot_suggest(g, 1, &options, &move));
+  options.threads = 1;
+  options.playouts = 0;
+  assert(!gamma_bot_suggest(g, 1, &options, &move));
+
+  options.playouts = 200;
+  assert(gamma_bot_suggest(g, 1, &options, &move));
+  assert(move.playouts == 200);
+  gamma_t *c = gamma_clone(g);
+  assert(c != NULL);
+  assert(move.golden ? gamma_golden_move(c, 1, move.x, move.y)
+                     : gamma_move(c, 1, move.x, move.y));
+  gamma_delete(c);
+  assert(gamma_busy_fields(g, 1) == 0);
+  // w jednym wątku ruch zależy tylko od gry, liczby rozgrywek i ziarna
+  gamma_bot_move again;
+  assert(gamma_bot_suggest(g, 1, &options, &again));
+  assert(again.x == move.x && again.y == move.y
+         && again.golden == move.golden);
+  gamma_delete(g);
+
+  // każdy gracz może mieć jeden obszar; ruch gracza 2 na (1, 0) odcina
+  // gracza 1 od wolnych pól, a ruch na (2, 0) pozwala mu wygrać
+  g = gamma_new(3, 1, 2, 1);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, 0, 0));
+  static const uint32_t threads[] = {1, 4};
+  for (size_t k = 0; k < sizeof(threads) / sizeof(threads[0]); k++) {
+    options = (gamma_bot_options){.threads = threads[k], .playouts = 2000};
+    assert(gamma_bot_suggest(g, 2, &options, &move));
+    assert(move.playouts == 2000);
+    assert(!move.golden && move.x == 1 && move.y == 0);
+  }
+  options = (gamma_bot_options){.threads = 2, .time_ms = 20};
+  assert(gamma_bot_suggest(g, 2, &options, &move));
+  assert(move.playouts >= 2);
+  gamma_delete(g);
+}
+
+/** @brief Rozwiązuje grę przeszukując wszystkie rozgrywki.
+ * Gracz @p player maksymalizuje, a pozostali minimalizują jego liczbę pól.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry
+ *                      z włączonym dziennikiem,
+ * @param[in] width   – szerokość planszy,
+ * @param[in] height  – wysokość planszy,
+ * @param[in] players – liczba graczy,
+ * @param[in] player  – gracz, którego wynik jest liczony,
+ * @param[in] to_move – gracz wykonujący następny ruch.
+ * @return Liczba pól gracza @p player na koniec optymalnej gry.
+ */
+static uint32_t paranoid(gamma_t *g, uint32_t width, uint32_t height,
+                         uint32_t players, uint32_t player, uint32_t to_move) {
+  for (uint32_t k = 0; k < players; k++) {
+    uint32_t mover = (to_move - 1 + k) % players + 1;
+    bool any = false;
+    uint32_t best = 0;
+    for (uint32_t i = 0; i < 2 * width * height; i++) {
+      uint32_t x = i / 2 % width, y = i / 2 / width;
+      if (i % 2 == 0 ? !gamma_move(g, mover, x, y)
+                     : !gamma_golden_move(g, mover, x, y))
+        continue;
+      uint32_t value = paranoid(g, width, height, players, player,
+                                mover % players + 1);
+      assert(gamma_undo(g));
+      if (!any || (mover == player ? value > best : value < best))
+        best = value;
+      any = true;
+    }
+    if (any)
+      return best;
+  }
+  return gamma_busy_fields(g, player);
+}
+
+/** @brief Testuje rozwiązywanie gry.
+ * Porównuje wyniki z pełnym przeszukiwaniem w pseudolosowych pozycjach
+ * z kilkoma wolnymi polami i sprawdza, że podany ruch jest pierwszym
+ * ruchem osiągającym wynik, niezależnie od liczby wątków.
+ */
+static void solve_test(void) {
+  gamma_solve_options options = {.threads = 1};
+  gamma_solve_result result;
+  assert(!gamma_solve(NULL, 1, 1, &options, &result));
+
+  gamma_t *g = gamma_new(9, 8, 2, 1);
+  assert(g != NULL);
+  assert(!gamma_solve(g, 1, 1, &options, &result));
+  gamma_delete(g);
+  g = gamma_new(2, 2, 5, 1);
+  assert(g != NULL);
+  assert(!gamma_solve(g, 1, 1, &options, &result));
+  gamma_delete(g);
+
+  g = gamma_new(4, 4, 2, 2);
+  assert(g != NULL);
+  assert(!gamma_solve(g, 0, 1, &options, &result));
+  assert(!gamma_solve(g, 1, 3, &options, &result));
+  assert(!gamma_solve(g, 1, 1, NULL, &result));
+  options.threads = 0;
+  assert(!gamma_solve(g, 1, 1, &options, &result));
+  options = (gamma_solve_options){.threads = 1, .table_bits = 31};
+  assert(!gamma_solve(g, 1, 1, &options, &result));
+  options = (gamma_solve_options){.threads = 2, .max_nodes = 1000};
+  assert(gamma_solve(g, 1, 1, &options, &result));
+  assert(!result.solved);
+  options.max_nodes = 0;
+  assert(gamma_solve(g, 1, 1, &options, &result));
+  assert(result.solved && result.has_move && result.player == 1
+         && result.busy == 8);
+  assert(gamma_busy_fields(g, 1) == 0);
+  gamma_delete(g);
+
+  g = gamma_new(2, 1, 2, 1);
+  assert(g != NULL);
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_golden_move(g, 2, 0, 0));
+  assert(gamma_move(g, 1, 1, 0));
+  assert(gamma_golden_move(g, 1, 0, 0));
+  assert(gamma_solve(g, 2, 1, &options, &result));
+  assert(result.solved && !result.has_move && result.busy == 0);
+  gamma_delete(g);
+
+  static const uint32_t sizes[][4] = {
+    {3, 3, 2, 2}, {3, 2, 3, 1}, {4, 2, 2, 1}, {2, 4, 4, 1}, {4, 3, 3, 2}
+  };
+  uint64_t seed = 17;
+  for (uint32_t round = 0; round < 40; round++) {
+    const uint32_t *size = sizes[round % 5];
+    uint32_t width = size[0], height = size[1], players = size[2];
+    g = gamma_new(width, height, players, size[3]);
+    assert(g != NULL);
+    assert(gamma_journal_enable(g, true));
+    for (uint32_t player = 1; total_busy(g, players) + 5 < width * height;
+         player = player % players + 1) {
+      uint32_t x, y;
+      if (gamma_random_legal_move(g, player, &seed, &x, &y))
+        assert(gamma_move(g, player, x, y));
+      else if (seed % 3 == 0)
+        gamma_golden_move(g, player, seed / 3 % width, seed / 7 % height);
+      if (seed % 17 == 0)
+        gamma_golden_move(g, player, seed / 5 % width, seed / 11 % height);
+    }
+    uint32_t player = round % players + 1;
+    uint32_t to_move = round / 2 % players + 1;
+    uint32_t expected = paranoid(g, width, height, players, player, to_move);
+    for (uint32_t threads = 1; threads <= 4; threads += 3) {
+      options = (gamma_solve_options){.threads = threads,
+                                      .table_bits = round % 2 ? 8 : 0};
+      assert(gamma_solve(g, player, to_move, &options, &result));
+      assert(result.solved && result.busy == expected);
+      if (!result.has_move)
+        continue;
+      // z optymalnych ruchów wybierany jest pierwszy: zwykłe przed złotymi,
+      // a w każdym rodzaju według indeksu pola
+      bool found = false;
+      for (uint32_t golden = 0; golden < 2 && !found; golden++)
+        for (uint32_t i = 0; i < width * height && !found; i++) {
+          uint32_t x = i % width, y = i / width;
+          if (!(golden ? gamma_golden_move(g, result.player, x, y)
+                       : gamma_move(g, result.player, x, y)))
+            continue;
+          found = paranoid(g, width, height, players, player,
+                           result.player % players + 1) == expected;
+          assert(gamma_undo(g));
+          if (found)
+            assert(result.x == x && result.y == y
+                   && result.golden == (golden == 1));
+        }
+      assert(found);
+    }
+    gamma_delete(g);
+  }
+}
+
+/** @brief Testuje wybór kolejnego gracza, który może wykonać ruch.
+ * Sprawdza kolejność cykliczną z pomijaniem zablokowanych graczy, także
+ * ostatniego, oraz zmiany po zwykłych i złotych ruchach, cofnięciu ruchu,
+ * skopiowaniu gry i ponownym użyciu gry z puli.
+ */
+static void active_players_test(void) {
+  assert(gamma_next_active_player(NULL, 0) == 0);
+  assert(gamma_game_over(NULL));
+
+  gamma_t *g = gamma_new(3, 1, 3, 1);
+  assert(g != NULL);
+  assert(gamma_journal_enable(g, true));
+  assert(gamma_next_active_player(g, 4) == 0);
+  assert(gamma_next_active_player(g, 0) == 1);
+  assert(gamma_next_active_player(g, 3) == 1);
+  assert(gamma_move(g, 1, 0, 0));
+  assert(gamma_move(g, 2, 1, 0));
+  assert(gamma_move(g, 3, 2, 0));
+  // plansza jest pełna, ale każdy gracz ma złoty ruch
+  assert(!gamma_game_over(g));
+  for (uint32_t player = 0; player <= 3; player++)
+    assert(gamma_next_active_player(g, player) == player % 3 + 1);
+
+  assert(gamma_golden_move(g, 1, 1, 0));
+  assert(gamma_next_active_player(g, 0) == 2);
+  assert(gamma_next_active_player(g, 1) == 2);
+  assert(gamma_next_active_player(g, 2) == 3);
+  assert(gamma_next_active_player(g, 3) == 2);
+  assert(gamma_golden_move(g, 2, 0, 0));
+  // ruch może wykonać tylko ostatni gracz
+  for (uint32_t player = 0; player <= 3; player++)
+    assert(gamma_next_active_player(g, player) == 3);
+  gamma_t *c = gamma_clone(g);
+  assert(c != NULL);
+  assert(gamma_golden_move(g, 3, 1, 0));
+  assert(gamma_game_over(g));
+  for (uint32_t player = 0; player <= 3; player++)
+    assert(gamma_next_active_player(g, player) == 0);
+  assert(gamma_next_active_player(c, 1) == 3);
+  gamma_delete(c);
+
+  // cofnięcie złotego ruchu przywraca graczy
+  assert(gamma_undo(g));
+  assert(!gamma_game_over(g));
+  assert(gamma_next_active_player(g, 3) == 3);
+  assert(gamma_undo(g));
+  assert(gamma_next_active_player(g, 3) == 2);
+  assert(gamma_undo(g));
+  assert(gamma_next_active_player(g, 3) == 1);
+  assert(gamma_redo(g));
+  assert(gamma_next_active_player(g, 3) == 2);
+  gamma_delete(g);
+
+  // przedłużenie obszaru odbiera złote ruchy sąsiadowi
+  gamma_pool *pool = gamma_pool_new(3, 3, 2, 1);
+  assert(pool != NULL);
+  for (int round = 0; round < 2; round++) {
+    g = gamma_pool_acquire(pool);
+    assert(g != NULL);
+    assert(gamma_next_active_player(g, 2) == 1);
+    assert(gamma_move(g, 1, 0, 0));
+    assert(gamma_move(g, 2, 1, 0));
+    assert(gamma_move(g, 2, 1, 1));
+    assert(gamma_move(g, 2, 0, 1));
+    assert(gamma_next_active_player(g, 2) == 1);
+    assert(gamma_move(g, 2, 2, 0));
+    assert(gamma_next_active_player(g, 2) == 1);
+    assert(gamma_move(g, 2, 0, 2));
+    assert(!gamma_golden_possible(g, 1));
+    assert(gamma_next_active_player(g, 0) == 2);
+    assert(gamma_next_active_player(g, 2) == 2);
+    gamma_pool_release(g);
+  }
+  gamma_pool_delete(pool);
+}
+
+/** @brief Wczytuje linie napisu @p text czytnikiem trybu wsadowego.
+ * @param[in] text      – wejście trybu wsadowego,
+ * @param[out] kinds    – rodzaje kolejnych linii, bez końca wejścia,
+ * @param[out] command  – ostatnia wczytana komenda.
+ * @return Liczba wczytanych linii.
+ */
+static int read_lines(const char *text, enum line_kind *kinds,
+                      batch_command *command) {
+  int descriptors[2];
+  assert(pipe(descriptors) == 0);
+  size_t length = strlen(text);
+  assert(write(descriptors[1], text, length) == (ssize_t)length);
+  assert(close(descriptors[1]) == 0);
+
+  batch_input *input = malloc(sizeof(batch_input));
+  assert(input != NULL);
+  input->descriptor = descriptors[0];
+  input->position = 0;
+  input->size = 0;
+  int count = 0;
+  enum line_kind kind;
+  while ((kind = ReadLine(input, command, MAX_COMMAND)) != LINE_END)
+    kinds[count++] = kind;
+  free(input);
+  assert(close(descriptors[0]) == 0);
+  return count;
+}
+
+/** @brief Testuje czytnik linii trybu wsadowego.
+ * Ostatnia linia bez znaku końca linii z niedozwolonym znakiem jest
+ * błędem, tak jak w pierwotnym trybie wsadowym, a znaki nazwy pliku są
+ * dozwolone tylko w argumencie komend 's' i 'l'.
+ */
+static void read_line_test(void) {
+  InitCharClasses();
+  enum line_kind kinds[8];
+  batch_command command;
+
+  assert(read_lines("g -1 5 3", kinds, &command) == 1);
+  assert(kinds[0] == LINE_ERROR);
+  assert(read_lines("m 1 1 1\nb 1.", kinds, &command) == 2);
+  assert(kinds[0] == LINE_COMMAND && kinds[1] == LINE_ERROR);
+  assert(read_lines("m 1 1 1\nm 1 1 2 ", kinds, &command) == 2);
+  assert(kinds[1] == LINE_ERROR);
+  // poprawna ostatnia linia bez znaku końca linii jest pomijana
+  assert(read_lines("m 1 1 1\nm 1 1 2", kinds, &command) == 1);
+  assert(kinds[0] == LINE_COMMAND);
+  assert(read_lines("# a.b\n", kinds, &command) == 1);
+  assert(kinds[0] == LINE_EMPTY);
+
+  assert(read_lines("m 1. 1 1\nl x y-z\nsl a.b\nm ./a\n", kinds,
+                    &command) == 4);
+  for (int k = 0; k < 4; k++)
+    assert(kinds[k] == LINE_ERROR);
+  assert(read_lines("s  ../gamma-1.sav\n", kinds, &command) == 1);
+  assert(kinds[0] == LINE_COMMAND && command.count == 2);
+  assert(strcmp(command.words[1], "../gamma-1.sav") == 0);
+}
+
 /** @brief Testuje silnik gry gamma.
  * Przeprowadza przykładowe testy silnika gry gamma.
  * @return Zero, gdy wszystkie testy przebiegły poprawnie,
@@ -94,5 +1204,21 @@ int main() {
   free(p);
 
   gamma_delete(g);
+
+  journal_test();
+  clone_test();
+  save_test();
+  board_stream_test();
+  arena_test();
+  pool_test();
+  owners_test();
+  scan_levels_test();
+  query_threads_test();
+  legal_moves_test();
+  bot_test();
+  solve_test();
+  active_players_test();
+  read_line_test();
+  stats_test();
   return 0;
 }
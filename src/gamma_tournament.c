@@ -0,0 +1,494 @@
+/** @file
+ * Turniej wielu gier gamma rozgrywanych równolegle
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include "gamma.h"
+#include "utilities.h"
+
+/** @brief Największa liczba graczy w turnieju. */
+#define TOURNAMENT_MAX_PLAYERS 64
+
+/** @brief Największa liczba wątków turnieju. */
+#define TOURNAMENT_MAX_THREADS 256
+
+/** @brief Maska końca przedziału gier w @ref tournament_worker::range. */
+#define RANGE_END 0xFFFFFFFFULL
+
+/**
+ * @brief Ustawienia turnieju.
+ */
+typedef struct tournament_options {
+    uint64_t games;     /**< liczba gier */
+    uint64_t width;     /**< szerokość planszy */
+    uint64_t height;    /**< wysokość planszy */
+    uint64_t players;   /**< liczba graczy */
+    uint64_t areas;     /**< maksymalna liczba obszarów gracza */
+    uint64_t threads;   /**< liczba wątków */
+    uint64_t seed;      /**< ziarno turnieju */
+    uint64_t golden;    /**< szansa w procentach, że losowy gracz spróbuje
+                          *  złotego ruchu, choć może wykonać zwykły */
+    uint64_t bots;      /**< gracze 1..bots wybierają ruchy botem */
+    uint64_t playouts;  /**< liczba rozgrywek bota na ruch */
+} tournament_options;
+
+/**
+ * @brief Wyniki części turnieju.
+ */
+typedef struct tournament_stats {
+    uint64_t games;                           /**< rozegrane gry */
+    uint64_t failed;                          /**< gry, dla których zabrakło
+                                                *  pamięci */
+    uint64_t moves;                           /**< wszystkie ruchy */
+    uint64_t min_length;                      /**< najkrótsza gra */
+    uint64_t max_length;                      /**< najdłuższa gra */
+    uint64_t draws;                           /**< gry bez jednego
+                                                *  zwycięzcy */
+    uint64_t wins[TOURNAMENT_MAX_PLAYERS];    /**< wygrane graczy */
+    uint64_t busy[TOURNAMENT_MAX_PLAYERS];    /**< suma pól graczy na
+                                                *  koniec gier */
+    uint64_t golden[TOURNAMENT_MAX_PLAYERS];  /**< złote ruchy graczy */
+} tournament_stats;
+
+/**
+ * @brief Wątek turnieju.
+ * Gry mają numery od 0; wątek rozgrywa gry ze swojego przedziału,
+ * zabierając je od początku, a gdy przedział się wyczerpie, kradnie drugą
+ * połowę przedziału innego wątku. Przedział jest jedną liczbą, więc
+ * właściciel i złodzieje zmieniają go tą samą operacją compare-and-swap.
+ */
+typedef struct tournament_worker {
+    _Alignas(64) _Atomic uint64_t range;  /**< przedział gier, początek
+                                            *  w starszych 32 bitach,
+                                            *  koniec w młodszych */
+    uint32_t index;                       /**< numer wątku */
+    struct tournament_worker *workers;    /**< wszystkie wątki */
+    const tournament_options *options;    /**< ustawienia turnieju */
+    gamma_pool *pool;                     /**< pula gier wątku */
+    tournament_stats stats;               /**< wyniki gier wątku */
+} tournament_worker;
+
+/** @brief Losuje kolejną liczbę generatorem splitmix64.
+ * @param[in,out] state – stan generatora, dowolna liczba.
+ * @return Liczba pseudolosowa.
+ */
+static uint64_t Random(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** @brief Podaje aktualny czas w sekundach.
+ * @return Czas zegara monotonicznego w sekundach.
+ */
+static double Now(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/** @brief Wykonuje złoty ruch na jednym z kolejnych pól, zaczynając od
+ * losowego.
+ * @param[in,out] g    – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] o        – ustawienia turnieju,
+ * @param[in] player   – numer gracza,
+ * @param[in,out] rng  – stan generatora liczb pseudolosowych,
+ * @param[in] attempts – liczba sprawdzanych pól.
+ * @return Wartość @p true, jeśli ruch został wykonany.
+ */
+static bool RandomGolden(gamma_t *g, const tournament_options *o,
+                         uint32_t player, uint64_t *rng, uint64_t attempts) {
+    uint64_t fields = o->width * o->height;
+    uint64_t start = Random(rng) % fields;
+    for(uint64_t k = 0; k < attempts && k < fields; k++) {
+        uint64_t i = (start + k) % fields;
+        if(gamma_golden_move(g, player, i % o->width, i / o->width)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Wykonuje ruch gracza.
+ * Bot wybiera ruch przez @ref gamma_bot_suggest. Pozostali gracze wykonują
+ * losowy zwykły ruch, a z szansą @ref tournament_options::golden złoty
+ * ruch na losowym polu; gracz bez zwykłego ruchu szuka złotego ruchu na
+ * całej planszy. Gracz musi móc wykonać ruch
+ * (@ref gamma_next_active_player).
+ * @param[in,out] g      – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] o          – ustawienia turnieju,
+ * @param[in] player     – numer gracza,
+ * @param[in,out] rng    – stan generatora liczb pseudolosowych,
+ * @param[out] golden    – czy wykonany ruch był złoty.
+ * @return Wartość @p true, jeśli gracz wykonał ruch.
+ */
+static bool Turn(gamma_t *g, const tournament_options *o, uint32_t player,
+                 uint64_t *rng, bool *golden) {
+    if(player <= o->bots) {
+        gamma_bot_options bot = {
+            .threads = 1,
+            .playouts = o->playouts,
+            .seed = Random(rng)
+        };
+        gamma_bot_move move;
+        if(!gamma_bot_suggest(g, player, &bot, &move)) {
+            return false;
+        }
+        *golden = move.golden;
+        return move.golden ? gamma_golden_move(g, player, move.x, move.y)
+                           : gamma_move(g, player, move.x, move.y);
+    }
+
+    uint32_t x, y;
+    if(!gamma_random_legal_move(g, player, rng, &x, &y)) {
+        // gracz może wykonać ruch, więc jest pole na złoty ruch
+        *golden = RandomGolden(g, o, player, rng, UINT64_MAX);
+        return *golden;
+    }
+    // przeglądanie planszy przez gamma_golden_possible jest drogie, więc
+    // najpierw losujemy, czy gracz spróbuje złotego ruchu
+    if(Random(rng) % 100 < o->golden && gamma_golden_possible(g, player)
+       && RandomGolden(g, o, player, rng, 1)) {
+        *golden = true;
+        return true;
+    }
+    *golden = false;
+    return gamma_move(g, player, x, y);
+}
+
+/** @brief Rozgrywa grę o podanym numerze.
+ * Generator gry jest wyznaczony przez ziarno turnieju i numer gry, więc
+ * wynik nie zależy od tego, który wątek ją rozegrał. Gry zaczynają kolejni
+ * gracze. Gracz, który nie może wykonać ruchu, jest pomijany
+ * (@ref gamma_next_active_player), a gra kończy się, gdy nikt nie może
+ * wykonać ruchu.
+ * @param[in,out] w   – wątek rozgrywający grę,
+ * @param[in] game    – numer gry.
+ */
+static void PlayGame(tournament_worker *w, uint64_t game) {
+    const tournament_options *o = w->options;
+    tournament_stats *stats = &w->stats;
+    gamma_t *g = gamma_pool_acquire(w->pool);
+    if(g == NULL) {
+        stats->failed++;
+        return;
+    }
+
+    uint64_t rng = o->seed ^ game * 0xD1B54A32D192ED03ULL;
+    uint32_t players = o->players;
+    uint64_t length = 0;
+    for(uint32_t player = gamma_next_active_player(g, game % players);
+        player != 0; player = gamma_next_active_player(g, player)) {
+        bool golden = false;
+        if(!Turn(g, o, player, &rng, &golden)) {
+            // gracz może wykonać ruch, więc zabrakło pamięci
+            stats->failed++;
+            gamma_pool_release(g);
+            return;
+        }
+        length++;
+        stats->golden[player - 1] += golden;
+    }
+
+    uint64_t best = 0, winners = 0;
+    uint32_t winner = 0;
+    for(uint32_t p = 1; p <= players; p++) {
+        uint64_t busy = gamma_busy_fields(g, p);
+        stats->busy[p - 1] += busy;
+        if(busy > best || p == 1) {
+            best = busy;
+            winner = p;
+            winners = 1;
+        } else if(busy == best) {
+            winners++;
+        }
+    }
+    if(winners == 1) {
+        stats->wins[winner - 1]++;
+    } else {
+        stats->draws++;
+    }
+    stats->games++;
+    stats->moves += length;
+    if(length < stats->min_length) {
+        stats->min_length = length;
+    }
+    if(length > stats->max_length) {
+        stats->max_length = length;
+    }
+    gamma_pool_release(g);
+}
+
+/** @brief Zabiera pierwszą grę z przedziału wątku.
+ * @param[in,out] w   – wątek,
+ * @param[out] game   – numer gry.
+ * @return Wartość @p true, jeśli przedział nie był pusty.
+ */
+static bool TakeOwn(tournament_worker *w, uint64_t *game) {
+    uint64_t range = atomic_load(&w->range);
+    while((range >> 32) < (range & RANGE_END)) {
+        if(atomic_compare_exchange_weak(&w->range, &range,
+                                        range + (1ULL << 32))) {
+            *game = range >> 32;
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Kradnie drugą połowę przedziału gier innego wątku, zaczynając
+ * od następnego. Pierwszą ukradzioną grę wątek rozgrywa od razu,
+ * a pozostałe stają się jego przedziałem.
+ * @param[in,out] w   – wątek z pustym przedziałem,
+ * @param[out] game   – numer pierwszej ukradzionej gry.
+ * @return Wartość @p true, jeśli udało się coś ukraść, a @p false, gdy
+ * wszystkie przedziały są puste.
+ */
+static bool Steal(tournament_worker *w, uint64_t *game) {
+    uint32_t threads = w->options->threads;
+    for(uint32_t k = 1; k < threads; k++) {
+        tournament_worker *victim = &w->workers[(w->index + k) % threads];
+        uint64_t range = atomic_load(&victim->range);
+        while(true) {
+            uint64_t begin = range >> 32, end = range & RANGE_END;
+            if(begin >= end) {
+                break;
+            }
+            uint64_t middle = begin + (end - begin) / 2;
+            if(atomic_compare_exchange_weak(&victim->range, &range,
+                                            begin << 32 | middle)) {
+                atomic_store(&w->range, (middle + 1) << 32 | end);
+                *game = middle;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/** @brief Rozgrywa gry z przedziału wątku i kradzione od innych wątków,
+ * dopóki wszystkie przedziały nie są puste.
+ * @param[in,out] arg – wątek, @ref tournament_worker.
+ * @return NULL.
+ */
+static void* Work(void *arg) {
+    tournament_worker *w = arg;
+    uint64_t game;
+    while(TakeOwn(w, &game) || Steal(w, &game)) {
+        PlayGame(w, game);
+    }
+    return NULL;
+}
+
+/** @brief Rozgrywa turniej i sumuje wyniki wątków.
+ * @param[in] o       – ustawienia turnieju,
+ * @param[out] total  – wyniki wszystkich gier.
+ * @return Wartość @p true, jeśli udało się utworzyć pule gier.
+ */
+static bool RunTournament(const tournament_options *o,
+                          tournament_stats *total) {
+    uint32_t threads = o->threads;
+    tournament_worker *workers = aligned_alloc(64,
+        sizeof(tournament_worker) * threads);
+    if(workers == NULL) {
+        return false;
+    }
+    bool created = true;
+    for(uint32_t k = 0; k < threads; k++) {
+        tournament_worker *w = &workers[k];
+        // gry są dzielone na równe, kolejne przedziały
+        atomic_init(&w->range, o->games * k / threads << 32
+                               | o->games * (k + 1) / threads);
+        w->index = k;
+        w->workers = workers;
+        w->options = o;
+        w->pool = gamma_pool_new(o->width, o->height, o->players, o->areas);
+        memset(&w->stats, 0, sizeof(w->stats));
+        w->stats.min_length = UINT64_MAX;
+        created = created && w->pool != NULL;
+    }
+
+    if(created) {
+        pthread_t thread[TOURNAMENT_MAX_THREADS];
+        bool started[TOURNAMENT_MAX_THREADS];
+        for(uint32_t k = 1; k < threads; k++) {
+            started[k] = pthread_create(&thread[k], NULL, Work,
+                                        &workers[k]) == 0;
+        }
+        Work(&workers[0]);
+        for(uint32_t k = 1; k < threads; k++) {
+            if(started[k]) {
+                pthread_join(thread[k], NULL);
+            } else {
+                Work(&workers[k]);
+            }
+        }
+    }
+
+    memset(total, 0, sizeof(*total));
+    total->min_length = UINT64_MAX;
+    for(uint32_t k = 0; k < threads; k++) {
+        const tournament_stats *s = &workers[k].stats;
+        total->games += s->games;
+        total->failed += s->failed;
+        total->moves += s->moves;
+        total->draws += s->draws;
+        if(s->min_length < total->min_length) {
+            total->min_length = s->min_length;
+        }
+        if(s->max_length > total->max_length) {
+            total->max_length = s->max_length;
+        }
+        for(uint32_t p = 0; p < o->players; p++) {
+            total->wins[p] += s->wins[p];
+            total->busy[p] += s->busy[p];
+            total->golden[p] += s->golden[p];
+        }
+        gamma_pool_delete(workers[k].pool);
+    }
+    free(workers);
+    return created;
+}
+
+/** @brief Wypisuje wyniki turnieju.
+ * @param[in] o       – ustawienia turnieju,
+ * @param[in] total   – wyniki wszystkich gier,
+ * @param[in] seconds – czas turnieju.
+ */
+static void Report(const tournament_options *o, const tournament_stats *total,
+                   double seconds) {
+    uint64_t games = total->games > 0 ? total->games : 1;
+    uint64_t golden = 0;
+    for(uint32_t p = 0; p < o->players; p++) {
+        golden += total->golden[p];
+    }
+    printf("games: %lu on %lux%lu, %lu players, %lu areas, seed %lu\n",
+           total->games, o->width, o->height, o->players, o->areas, o->seed);
+    printf("speed: %.1f games/s, %.3f s, %lu threads\n",
+           total->games / (seconds > 0 ? seconds : 1e-9), seconds,
+           o->threads);
+    printf("length: %.2f moves on average, min %lu, max %lu\n",
+           (double)total->moves / games,
+           total->games > 0 ? total->min_length : 0, total->max_length);
+    printf("golden: %.3f moves per game\n", (double)golden / games);
+    printf("draws: %lu (%.2f%%)\n", total->draws,
+           100.0 * total->draws / games);
+    for(uint32_t p = 0; p < o->players; p++) {
+        printf("player %u%s: wins %lu (%.2f%%), %.2f fields, "
+               "%.3f golden moves per game\n",
+               p + 1, p < o->bots ? " (bot)" : "", total->wins[p],
+               100.0 * total->wins[p] / games,
+               (double)total->busy[p] / games,
+               (double)total->golden[p] / games);
+    }
+    if(total->failed > 0) {
+        printf("failed: %lu games, out of memory\n", total->failed);
+    }
+}
+
+/** @brief Odczytuje liczbę dziesiętną z argumentu programu.
+ * @param[in] text    – argument,
+ * @param[out] value  – odczytana liczba.
+ * @return Wartość @p true, jeśli argument był liczbą mieszczącą się
+ * w uint64_t.
+ */
+static bool ParseNumber(const char *text, uint64_t *value) {
+    *value = 0;
+    if(text == NULL || *text == '\0') {
+        return false;
+    }
+    for(; *text != '\0'; text++) {
+        if(*text < '0' || *text > '9'
+           || *value > (UINT64_MAX - (*text - '0')) / 10) {
+            return false;
+        }
+        *value = *value * 10 + (*text - '0');
+    }
+    return true;
+}
+
+/** @brief Odczytuje ustawienia turnieju z argumentów programu.
+ * @param[in] argc    – liczba argumentów programu,
+ * @param[in] argv    – argumenty programu,
+ * @param[out] o      – ustawienia turnieju.
+ * @return Wartość @p true, jeśli argumenty są poprawne.
+ */
+static bool GetOptions(int argc, char *argv[], tournament_options *o) {
+    *o = (tournament_options){
+        .games = 10000, .width = 10, .height = 10, .players = 2,
+        .areas = 4, .threads = Processors(TOURNAMENT_MAX_THREADS),
+        .seed = 1, .golden = 5, .bots = 0, .playouts = 100
+    };
+    static const char *names[] = {
+        "--games", "--width", "--height", "--players", "--areas",
+        "--threads", "--seed", "--golden", "--bots", "--playouts"
+    };
+    uint64_t *values[] = {
+        &o->games, &o->width, &o->height, &o->players, &o->areas,
+        &o->threads, &o->seed, &o->golden, &o->bots, &o->playouts
+    };
+    for(int k = 1; k < argc; k += 2) {
+        size_t n = 0;
+        while(n < sizeof(names) / sizeof(names[0])
+              && strcmp(argv[k], names[n]) != 0) {
+            n++;
+        }
+        if(n == sizeof(names) / sizeof(names[0]) || k + 1 >= argc
+           || !ParseNumber(argv[k + 1], values[n])) {
+            return false;
+        }
+    }
+    return o->games > 0 && o->games < RANGE_END
+           && o->width > 0 && o->width <= UINT32_MAX
+           && o->height > 0 && o->height <= UINT32_MAX
+           && o->players > 0 && o->players <= TOURNAMENT_MAX_PLAYERS
+           && o->areas > 0 && o->areas <= UINT32_MAX
+           && o->threads > 0 && o->threads <= TOURNAMENT_MAX_THREADS
+           && o->golden <= 100 && o->bots <= o->players
+           && o->playouts > 0;
+}
+
+/** @brief Rozgrywa turniej losowych graczy i botów i wypisuje łączne
+ * wyniki. Opcje (liczby, w nawiasach wartości domyślne): "--games" (10000),
+ * "--width" (10), "--height" (10), "--players" (2), "--areas" (4),
+ * "--threads" (liczba procesorów), "--seed" (1), "--golden" (szansa złotego
+ * ruchu w procentach, 5), "--bots" (gracze 1..N używają bota, 0)
+ * i "--playouts" (rozgrywki bota na ruch, 100). Wyniki zależą tylko od
+ * ustawień, nie od liczby wątków.
+ * @param[in] argc – liczba argumentów programu,
+ * @param[in] argv – argumenty programu.
+ * @return Zero, gdy wszystkie gry zostały rozegrane, 1 gdy zabrakło
+ * pamięci, a 2 gdy argumenty są niepoprawne.
+ */
+int main(int argc, char *argv[]) {
+    tournament_options options;
+    if(!GetOptions(argc, argv, &options)) {
+        fprintf(stderr, "Użycie: %s [--games N] [--width N] [--height N] "
+                "[--players N] [--areas N] [--threads N] [--seed N] "
+                "[--golden PROCENT] [--bots N] [--playouts N]\n", argv[0]);
+        return 2;
+    }
+
+    tournament_stats total;
+    double start = Now();
+    bool created = RunTournament(&options, &total);
+    double seconds = Now() - start;
+    if(!created) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+    Report(&options, &total, seconds);
+    return total.failed > 0;
+}
@@ -0,0 +1,461 @@
+/** @file
+ * Implementacja sprawdzania możliwości wykonania złotego ruchu
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "golden_gamma.h"
+#include "union_find_gamma.h"
+#include "gamma_structures.h"
+#include "arena_gamma.h"
+#include "scan_gamma.h"
+#include "stats_gamma.h"
+
+/** @brief Najmniejsza liczba pól planszy, od której opłaca się przeglądać
+ * ją kilkoma wątkami. */
+#define GOLDEN_PARALLEL_FIELDS (1 << 20)
+
+/** @brief Sprawdza czy pole (@p x,@p y) leży na planszy i należy do gracza
+ * @p player.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny, dowolna liczba całkowita,
+ * @param[in] y       – numer wiersza, dowolna liczba całkowita,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli pole leży na planszy i należy do gracza
+ * @p player, a @p false w przeciwnym przypadku.
+ */
+static bool OwnedBy(const gamma_t *g, int64_t x, int64_t y, uint32_t player) {
+    return x >= 0 && y >= 0 && x < g->width && y < g->height
+           && Owner(g,y * g->width + x) == player;
+}
+
+int LocalSplits(const gamma_t *g, uint32_t x, uint32_t y) {
+    // pola otaczające (x,y) zgodnie z ruchem wskazówek zegara:
+    // na parzystych pozycjach sąsiedzi, na nieparzystych pola narożne
+    static const int dx[8] = {0, 1, 1, 1, 0, -1, -1, -1};
+    static const int dy[8] = {1, 1, 0, -1, -1, -1, 0, 1};
+
+    uint32_t owner = Owner(g,BoardIndex(g,x,y));
+    bool ring[8];
+
+    for(int k = 0; k < 8; k++) {
+        ring[k] = OwnedBy(g,(int64_t)x + dx[k],(int64_t)y + dy[k],owner);
+    }
+
+    int neighbours = 0;
+    int links = 0;
+    for(int k = 0; k < 8; k += 2) {
+        if(ring[k]) {
+            neighbours++;
+            if(ring[k + 1] && ring[(k + 2) % 8]) {
+                links++;
+            }
+        }
+    }
+
+    if(neighbours == 0) {
+        return 0;
+    }
+    // wszyscy czterej sąsiedzi połączeni w pierścień tworzą jeden obszar
+    return neighbours > links ? neighbours - links : 1;
+}
+
+/** @brief Sprawdza czy gracz @p player może postawić pionek na polu
+ * o indeksie @p i, nie przekraczając maksymalnej liczby obszarów.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] i       – indeks pola.
+ * @return Wartość @p true, jeśli gracz ma mniej niż maksymalną liczbę
+ * obszarów lub pole sąsiaduje z jego polem.
+ */
+static bool CanPlace(const gamma_t *g, uint32_t player, uint32_t i) {
+    if(g->players[player - 1].number_of_areas < g->max_areas) {
+        return true;
+    }
+
+    uint32_t neighbours[4];
+    int count = Neighbours(g,i % g->width,i / g->width,neighbours);
+    for(int k = 0; k < count; k++) {
+        if(Owner(g,neighbours[k]) == player) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Podaje największą liczbę obszarów, na które może rozpaść się
+ * obszar gracza @p owner po złotym ruchu na jednym z jego pól.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] owner   – numer gracza mającego co najmniej jeden obszar.
+ * @return Dopuszczalna liczba obszarów.
+ */
+static uint64_t AllowedSplits(const gamma_t *g, uint32_t owner) {
+    return (uint64_t)g->max_areas + 1 - g->players[owner - 1].number_of_areas;
+}
+
+/** @brief Alokuje bufory potrzebne do wyznaczania punktów artykulacji,
+ * jeśli nie zostały jeszcze zaalokowane.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p false, gdy nie udało się zaalokować pamięci,
+ * a @p true w przeciwnym przypadku.
+ */
+static bool AllocateArticulation(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+
+    if(g->discovery == NULL) {
+        g->discovery = GammaAlloc(g->arena, sizeof(uint32_t) * fields);
+    }
+    if(g->low == NULL) {
+        g->low = GammaAlloc(g->arena, sizeof(uint32_t) * fields);
+    }
+    if(g->dfs_state == NULL) {
+        g->dfs_state = GammaAlloc(g->arena, sizeof(uint8_t) * fields);
+    }
+    return g->discovery != NULL && g->low != NULL && g->dfs_state != NULL;
+}
+
+/** @brief Przechodzi w głąb obszar zawierający pole @p start i szuka w nim
+ * pola, na którym gracz @p player może wykonać złoty ruch.
+ * Dla każdego pola wyznacza (algorytmem Tarjana) liczbę obszarów, na które
+ * rozpadnie się obszar po usunięciu tego pola. Stos przechowywany jest
+ * w @p g->queue, a w @p g->dfs_state górne cztery bity oznaczają kierunek
+ * następnego sąsiada do zbadania, a dolne liczbę powstających obszarów.
+ * Wszystkie odwiedzone pola zostają oznaczone jako odwiedzone.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza wykonującego złoty ruch,
+ * @param[in] start   – indeks nieodwiedzonego pola innego gracza.
+ * @return Wartość @p true, jeśli w obszarze jest pole, na którym gracz
+ * @p player może wykonać złoty ruch, a @p false w przeciwnym przypadku.
+ */
+static bool AreaHasTarget(gamma_t *g, uint32_t player, uint32_t start) {
+    uint32_t owner = Owner(g,start);
+    uint64_t allowed = AllowedSplits(g,owner);
+    uint32_t *stack = g->queue;
+    uint32_t top = 0;
+    uint32_t time = 0;
+
+    SetVisited(g,start);
+    g->discovery[start] = g->low[start] = ++time;
+    // korzeń drzewa przeszukiwania nie ma obszaru "od strony ojca"
+    g->dfs_state[start] = 0;
+    stack[top++] = start;
+
+    while(top > 0) {
+        uint32_t u = stack[top - 1];
+        uint32_t direction = g->dfs_state[u] >> 4;
+
+        if(direction < 4) {
+            g->dfs_state[u] += 1 << 4;
+
+            uint32_t x = u % g->width;
+            uint32_t v;
+            if(direction == 0 && x > 0) {
+                v = u - 1;
+            } else if(direction == 1 && x + 1 < g->width) {
+                v = u + 1;
+            } else if(direction == 2 && u >= g->width) {
+                v = u - g->width;
+            } else if(direction == 3 && u < g->width * (g->height - 1)) {
+                v = u + g->width;
+            } else {
+                continue;
+            }
+
+            if(Owner(g,v) != owner
+               || (top > 1 && v == stack[top - 2])) {
+                continue;
+            }
+            if(IsVisited(g,v)) {
+                if(g->discovery[v] < g->low[u]) {
+                    g->low[u] = g->discovery[v];
+                }
+            } else {
+                SetVisited(g,v);
+                g->discovery[v] = g->low[v] = ++time;
+                g->dfs_state[v] = 1;
+                stack[top++] = v;
+            }
+        } else {
+            top--;
+            if((uint64_t)(g->dfs_state[u] & 15) <= allowed
+               && CanPlace(g,player,u)) {
+                return true;
+            }
+            if(top > 0) {
+                uint32_t parent = stack[top - 1];
+                if(g->low[u] < g->low[parent]) {
+                    g->low[parent] = g->low[u];
+                }
+                if(g->low[u] >= g->discovery[parent]) {
+                    g->dfs_state[parent]++;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/** @brief Sprawdza kandydatów na pole złotego ruchu gracza @p player
+ * w jednym słowie maski wiersza, w kolejności od lewej.
+ * @param[in,out] g         – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player        – numer gracza wykonującego złoty ruch,
+ * @param[in] y             – numer wiersza,
+ * @param[in] first         – numer kolumny pola opisywanego przez najniższy
+ *                            bit maski,
+ * @param[in] candidates    – maska pól innych graczy, na których gracz może
+ *                            postawić pionek,
+ * @param[in,out] searching – czy rozpoczęło się przechodzenie obszarów.
+ * @return Wartość 1, jeśli znaleziono pole złotego ruchu, 0, jeśli go nie
+ * ma wśród kandydatów, i -1, gdy nie udało się zaalokować pamięci.
+ */
+static int CheckCandidates(gamma_t *g, uint32_t player, uint32_t y,
+                           uint32_t first, uint64_t candidates,
+                           bool *searching) {
+    while(candidates != 0) {
+        uint32_t x = first + __builtin_ctzll(candidates);
+        uint32_t i = BoardIndex(g,x,y);
+        candidates &= candidates - 1;
+
+        // pole z numerem gracza spoza zakresu, możliwe tylko w uszkodzonym
+        // wczytanym pliku, jest traktowane jak wolne
+        if(Owner(g,i) == 0) {
+            continue;
+        }
+        if(*searching && IsVisited(g,i)) {
+            // obszar tego pola został już w całości sprawdzony
+            continue;
+        }
+
+        int splits = LocalSplits(g,x,y);
+        if(splits <= 1
+           || (uint64_t)splits <= AllowedSplits(g,Owner(g,i))) {
+            return 1;
+        }
+
+        if(!*searching) {
+            if(!NewVisitGeneration(g) || !AllocateArticulation(g)) {
+                return -1;
+            }
+            *searching = true;
+        }
+        if(AreaHasTarget(g,player,i)) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/** @brief Podaje kandydatów na pole złotego ruchu w słowie @p w maski
+ * ostatnio przejrzanego wiersza: pola innych graczy, a gdy gracz ma już
+ * wszystkie obszary, tylko te sąsiadujące z nim.
+ * @param[in] scan      – stan przeglądania planszy,
+ * @param[in] w         – numer słowa maski,
+ * @param[in] saturated – czy gracz ma maksymalną liczbę obszarów.
+ * @return Maska kandydatów.
+ */
+static uint64_t Candidates(const row_scan *scan, uint32_t w, bool saturated) {
+    return saturated ? scan->other[w] & scan->adjacent[w] : scan->other[w];
+}
+
+/** @brief Sprawdza czy gracz @p player ma maksymalną liczbę obszarów.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli gracz nie może utworzyć nowego obszaru.
+ */
+static bool Saturated(const gamma_t *g, uint32_t player) {
+    return g->players[player - 1].number_of_areas >= g->max_areas;
+}
+
+/** @brief Szuka pola złotego ruchu gracza @p player, przeglądając planszę
+ * wierszami od pola (@p first_column, @p first_row).
+ * @param[in,out] g        – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player       – numer gracza wykonującego złoty ruch,
+ * @param[in,out] scan     – stan przeglądania planszy przez gracza @p player,
+ * @param[in] first_row    – numer wiersza pierwszego pola,
+ * @param[in] first_column – numer kolumny pierwszego pola.
+ * @return Wartość @p true, jeśli istnieje pole złotego ruchu, a @p false
+ * w przeciwnym przypadku (również gdy nie udało się zaalokować pamięci).
+ */
+static bool SweepRows(gamma_t *g, uint32_t player, row_scan *scan,
+                      uint32_t first_row, uint32_t first_column) {
+    bool saturated = Saturated(g,player);
+    bool searching = false;
+    int found = 0;
+
+    for(uint32_t y = first_row; y < g->height && found == 0; y++) {
+        STATS_ADD(STATS_GOLDEN_ROWS, 1);
+        ScanRow(scan,y);
+        uint32_t w = y == first_row ? first_column / SCAN_WORD_BITS : 0;
+        for(; w < scan->words && found == 0; w++) {
+            uint64_t candidates = Candidates(scan,w,saturated);
+            if(y == first_row && w == first_column / SCAN_WORD_BITS) {
+                candidates &= ~(uint64_t)0 << (first_column % SCAN_WORD_BITS);
+            }
+            found = CheckCandidates(g,player,y,w * SCAN_WORD_BITS,
+                                   candidates,&searching);
+        }
+    }
+    return found > 0;
+}
+
+/**
+ * @brief Pas wierszy planszy przeglądany przez jeden wątek przy szukaniu
+ * pola złotego ruchu.
+ */
+typedef struct golden_band {
+    const gamma_t *g;     /**< przeglądana gra */
+    uint32_t player;      /**< numer gracza wykonującego złoty ruch */
+    uint32_t first_row;   /**< pierwszy wiersz pasa */
+    uint32_t end_row;     /**< wiersz za ostatnim wierszem pasa */
+    atomic_bool *found;   /**< czy któryś wątek znalazł pole złotego ruchu */
+    bool hard;            /**< czy w pasie jest pole wymagające przejścia
+                            *  obszaru algorytmem Tarjana */
+    uint32_t hard_x;      /**< kolumna pierwszego takiego pola */
+    uint32_t hard_y;      /**< wiersz pierwszego takiego pola */
+    row_scan scan;        /**< stan przeglądania pasa */
+    pthread_t thread;     /**< wątek przeglądający pas */
+    bool started;         /**< czy udało się uruchomić wątek */
+} golden_band;
+
+/** @brief Przegląda pas wierszy, szukając pola, na którym złoty ruch
+ * rozstrzyga @ref LocalSplits. Nie zmienia stanu gry, więc pasy mogą być
+ * przeglądane równolegle. Zapamiętuje pierwsze pole, którego nie da się
+ * tak rozstrzygnąć, i kończy pracę, gdy inny wątek znajdzie pole złotego
+ * ruchu.
+ * @param[in,out] argument – wskaźnik na pas typu @ref golden_band.
+ * @return NULL.
+ */
+static void *SweepBand(void *argument) {
+    golden_band *band = argument;
+    const gamma_t *g = band->g;
+    bool saturated = Saturated(g,band->player);
+
+    for(uint32_t y = band->first_row; y < band->end_row; y++) {
+        if(atomic_load_explicit(band->found, memory_order_relaxed)) {
+            return NULL;
+        }
+        STATS_ADD(STATS_GOLDEN_ROWS, 1);
+        ScanRow(&band->scan,y);
+        for(uint32_t w = 0; w < band->scan.words; w++) {
+            uint64_t candidates = Candidates(&band->scan,w,saturated);
+            while(candidates != 0) {
+                uint32_t x = w * SCAN_WORD_BITS + __builtin_ctzll(candidates);
+                uint32_t owner = Owner(g,BoardIndex(g,x,y));
+                candidates &= candidates - 1;
+                if(owner == 0) {
+                    continue;
+                }
+
+                int splits = LocalSplits(g,x,y);
+                if(splits <= 1 || (uint64_t)splits <= AllowedSplits(g,owner)) {
+                    atomic_store_explicit(band->found, true,
+                                          memory_order_relaxed);
+                    return NULL;
+                }
+                if(!band->hard) {
+                    band->hard = true;
+                    band->hard_x = x;
+                    band->hard_y = y;
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+/** @brief Szuka pola złotego ruchu, przeglądając pasy wierszy planszy
+ * w @p threads wątkach. Gdy żaden wątek nie rozstrzygnie sprawy testem
+ * @ref LocalSplits, obszary są przechodzone jednym wątkiem od pierwszego
+ * pola, które tego wymaga, tak jak przy przeglądaniu jednowątkowym.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza wykonującego złoty ruch,
+ * @param[in] threads – liczba wątków, liczba większa od 1 niewiększa od
+ *                      wysokości planszy.
+ * @return Wartość 1, jeśli istnieje pole złotego ruchu, 0, jeśli go nie ma,
+ * i -1, gdy nie udało się przygotować wątków (wtedy należy przejrzeć
+ * planszę jednym wątkiem).
+ */
+static int ParallelTargetExists(gamma_t *g, uint32_t player,
+                                uint32_t threads) {
+    golden_band *bands = GammaAlloc(g->arena, sizeof(golden_band) * threads);
+    if(bands == NULL) {
+        return -1;
+    }
+    atomic_bool found;
+    atomic_init(&found, false);
+
+    uint32_t ready = 0;
+    while(ready < threads && BeginScan(&bands[ready].scan,g,player)) {
+        golden_band *band = &bands[ready];
+        band->g = g;
+        band->player = player;
+        band->first_row = (uint64_t)g->height * ready / threads;
+        band->end_row = (uint64_t)g->height * (ready + 1) / threads;
+        band->found = &found;
+        band->hard = false;
+        ready++;
+    }
+
+    int result = -1;
+    if(ready == threads) {
+        for(uint32_t k = 1; k < threads; k++) {
+            bands[k].started = pthread_create(&bands[k].thread, NULL,
+                                              SweepBand, &bands[k]) == 0;
+        }
+        SweepBand(&bands[0]);
+        for(uint32_t k = 1; k < threads; k++) {
+            if(bands[k].started) {
+                pthread_join(bands[k].thread, NULL);
+            } else {
+                SweepBand(&bands[k]);
+            }
+        }
+
+        result = atomic_load(&found);
+        for(uint32_t k = 0; k < threads && result == 0; k++) {
+            if(bands[k].hard) {
+                result = SweepRows(g,player,&bands[0].scan,bands[k].hard_y,
+                                   bands[k].hard_x);
+            }
+        }
+    }
+
+    for(uint32_t k = 0; k < ready; k++) {
+        EndScan(&bands[k].scan);
+    }
+    GammaFree(g->arena, bands);
+    return result;
+}
+
+bool GoldenTargetExists(gamma_t *g, uint32_t player) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint64_t others = fields - g->free_fields_under_max_areas
+                      - g->players[player - 1].busy_fields;
+
+    if(others == 0) {
+        return false;
+    }
+    STATS_ADD(STATS_GOLDEN_SWEEPS, 1);
+
+    uint32_t threads = g->query_threads < g->height ? g->query_threads
+                                                    : g->height;
+    if(threads > 1 && fields >= GOLDEN_PARALLEL_FIELDS) {
+        int found = ParallelTargetExists(g,player,threads);
+        if(found >= 0) {
+            return found > 0;
+        }
+    }
+
+    row_scan scan;
+    if(!BeginScan(&scan,g,player)) {
+        return false;
+    }
+    bool found = SweepRows(g,player,&scan,0,0);
+    EndScan(&scan);
+    return found;
+}
@@ -0,0 +1,44 @@
+/** @file
+ * Interfejs sprawdzania możliwości wykonania złotego ruchu
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef GOLDENGAMMA_H
+#define GOLDENGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma_structures.h"
+
+/** @brief Szacuje na ile obszarów rozpadnie się obszar zawierający pole
+ * (@p x,@p y) po usunięciu z niego tego pola.
+ * Bada jedynie osiem pól otaczających (@p x,@p y): sąsiedzi należący do
+ * właściciela pola, połączeni przez wspólne pole narożne, na pewno pozostaną
+ * w jednym obszarze.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] x       – numer kolumny zajętego pola, liczba nieujemna mniejsza
+ *                      od wartości @p width z funkcji @ref gamma_new,
+ * @param[in] y       – numer wiersza zajętego pola, liczba nieujemna mniejsza
+ *                      od wartości @p height z funkcji @ref gamma_new.
+ * @return Górne ograniczenie liczby powstałych obszarów. Wynik 0 lub 1 jest
+ * dokładny.
+ */
+int LocalSplits(const gamma_t *g, uint32_t x, uint32_t y);
+
+/** @brief Sprawdza czy gracz @p player może wykonać złoty ruch na
+ * jakimkolwiek polu, nie zmieniając stanu planszy.
+ * Pola, dla których nie wystarcza test @ref LocalSplits, są rozstrzygane
+ * przez wyznaczenie punktów artykulacji ich obszaru (algorytm Tarjana),
+ * każdy obszar jest przechodzony co najwyżej raz.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od wartości
+ *                      @p players z funkcji @ref gamma_new, który nie
+ *                      wykonał jeszcze złotego ruchu.
+ * @return Wartość @p true, jeśli istnieje pole, na którym gracz @p player
+ * może wykonać złoty ruch, a @p false w przeciwnym przypadku (również gdy
+ * nie udało się zaalokować pamięci).
+ */
+bool GoldenTargetExists(gamma_t *g, uint32_t player);
+
+#endif /* GOLDENGAMMA_H */
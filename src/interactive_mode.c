@@ -12,32 +12,8 @@
 #include <stdio.h>
 #include "utilities.h"
 
-/** @brief Sprawdza czy jakikolwiek z graczy może wykonać ruch.
- * @param[in,out] g   – wskaźnik na struktrurę przechowującą aktualny stan gry
- *                      różny od NULL.
- * @return  true - istnieje gracz który może wykonać ruch
- *          false - nie istnieje taki gracz.
- */
-bool CanAnyPlayerMakeAMove(gamma_t *g) {
-    for(uint32_t i = 1; i < g->number_of_players ; i++) {
-        if(gamma_free_fields(g,i) > 0 || gamma_golden_possible(g,i)) {
-            return true;
-        }
-    }
-
-    return false;
-}
-
-/** @brief Sprawdza czy dany gracz może wykonać ruch.
- * @param[in,out] g   – wskaźnik na struktrurę przechowującą aktualny stan gry
- *                      różny od NULL.
- * @param[in] player  - numer gracza, liczba dodatnia.
- * @return  true - gracz może wykonać ruch
- *          false - gracz nie może wykonać ruchu.
- */
-bool CanPlayerMakeAMove(gamma_t *g, uint32_t player) {
-    return (gamma_free_fields(g,player) > 0) || gamma_golden_possible(g,player);
-}
+/** @brief Czas w milisekundach, przez jaki bot wybiera ruch gracza. */
+#define COMPUTER_TIME_MS 500
 
 /** @brief Zmienna przechowująca orginalny stan terminala
  */
@@ -230,7 +206,57 @@ bool CheckForMove(gamma_t *g, int c, uint32_t player_number, uint32_t cursor_x,
     return false;
 }
 
-void InteractiveMode(gamma_t *g) {
+/** @brief Sprawdza czy ruchy gracza wykonuje bot.
+ * @param[in] player_number  - numer gracza, liczba dodatnia.
+ * @param[in] computer       - numery graczy, których ruchy wykonuje bot,
+ * @param[in] computer_count - liczba elementów tablicy @p computer.
+ * @return  true - ruchy gracza wykonuje bot
+ *          false - gracz wykonuje ruchy sam.
+ */
+bool IsComputer(uint32_t player_number, const uint32_t *computer,
+                uint32_t computer_count) {
+    for(uint32_t i = 0; i < computer_count; i++) {
+        if(computer[i] == player_number) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Wykonuje ruch gracza wybrany przez bota i ustawia kursor na polu
+ * ruchu. Jeśli bot nie wybierze ruchu, gracz rezygnuje z ruchu.
+ * @param[in,out] g         – wskaźnik na struktrurę przechowującą aktualny
+ *                            stan gry różny od NULL.
+ * @param[in] player_number - numer gracza który wykonuje ruch, liczba dodatnia.
+ * @param[in,out] cursor_x  - współrzędna x gracza, liczba nieujemna.
+ * @param[in,out] cursor_y  - współrzędna y gracza, liczba nieujemna.
+ * @param[in] width_of_player - szerokość numeru gracza, liczba dodatnia.
+ */
+void ComputerMove(gamma_t *g, uint32_t player_number, uint32_t *cursor_x,
+                  uint32_t *cursor_y, uint32_t width_of_player) {
+    gamma_bot_options options = {
+        .threads = Processors(GAMMA_BOT_MAX_THREADS),
+        .time_ms = COMPUTER_TIME_MS,
+        .seed = player_number
+    };
+    gamma_bot_move move;
+
+    // status gracza jest widoczny, gdy bot wybiera ruch
+    fflush(stdout);
+    if(!gamma_bot_suggest(g, player_number, &options, &move)) {
+        return;
+    }
+
+    *cursor_x = move.x;
+    *cursor_y = move.y;
+    WritePlayerStatus(g, player_number, *cursor_x, *cursor_y);
+    CheckForMove(g, move.golden ? 'g' : ' ', player_number, *cursor_x,
+                 *cursor_y, width_of_player);
+    fflush(stdout);
+}
+
+void InteractiveMode(gamma_t *g, const uint32_t *computer,
+                     uint32_t computer_count) {
 
     uint32_t width_of_player = NumberOfDigits(g->number_of_players);
     if(width_of_player == 1) {
@@ -241,7 +267,8 @@ void InteractiveMode(gamma_t *g) {
     uint32_t cursor_x = 0;
     uint32_t cursor_y = 0;
 
-    uint32_t player_number = 1;
+    // gracze, którzy nie mogą wykonać ruchu, są pomijani
+    uint32_t player_number = gamma_next_active_player(g, 0);
 
     // zmienna informująca o zakończeniu gry
     bool exit = false;
@@ -259,91 +286,91 @@ void InteractiveMode(gamma_t *g) {
     // przesunięcie kursora na pozycje (0,0) planszy
     printf("%c[A", 0x1B);
 
-    while(CanAnyPlayerMakeAMove(g) && !exit) {
-        for(player_number = 1;
-            player_number <= g->number_of_players && !exit; player_number++) {
+    for(; player_number != 0 && !exit;
+        player_number = gamma_next_active_player(g, player_number)) {
 
-            if (CanPlayerMakeAMove(g, player_number)) {
-                
-                WritePlayerStatus(g,player_number,cursor_x,cursor_y);
+        WritePlayerStatus(g,player_number,cursor_x,cursor_y);
 
-                bool end_move = false;
+        if(IsComputer(player_number, computer, computer_count)) {
+            ComputerMove(g, player_number, &cursor_x, &cursor_y,
+                         width_of_player);
+            continue;
+        }
 
-                int c = (int)getchar();
-                while (!exit && !end_move) {
-                    switch (c) {
-                        case (4): {
-                            exit = true;
-                            end_move = true;
-                            break;
-                        }
-                        case 'C':
-                        case 'c': {
-                            end_move = true;
-                            break;
-                        }
-                        case ('\033'): {
-                            c = getchar();
+        bool end_move = false;
+
+        int c = (int)getchar();
+        while (!exit && !end_move) {
+            switch (c) {
+                case (4): {
+                    exit = true;
+                    end_move = true;
+                    break;
+                }
+                case 'C':
+                case 'c': {
+                    end_move = true;
+                    break;
+                }
+                case ('\033'): {
+                    c = getchar();
+
+                    while(c == '\033') {
+                        c = getchar();
+                    }
+                    if(c != '[') {
+                        continue;
+                    }
+
+                    int temp = getchar();
 
-                            while(c == '\033') {
-                                c = getchar();
+                    switch (temp) {
+                        case 'A':
+                            if (cursor_y < g->height - 1) {
+                                printf("%c[A", 0x1B);
+                                cursor_y++;
                             }
-                            if(c != '[') {
-                                continue;
+                            break;
+                        case 'B':
+                            if (cursor_y >= 1) {
+                                printf("%c[B", 0x1B);
+                                cursor_y--;
                             }
-
-                            int temp = getchar();
-
-                            switch (temp) {
-                                case 'A':
-                                    if (cursor_y < g->height - 1) {
-                                        printf("%c[A", 0x1B);
-                                        cursor_y++;
-                                    }
-                                    break;
-                                case 'B':
-                                    if (cursor_y >= 1) {
-                                        printf("%c[B", 0x1B);
-                                        cursor_y--;
-                                    }
-                                    break;
-                                case 'C':
-                                    if (cursor_x < g->width - 1) {
-                                        printf("%c[%dC", 0x1B,
-                                                width_of_player + 1);
-                                        cursor_x++;
-                                    }
-                                    break;
-                                case 'D':
-                                    if (cursor_x >= 1) {
-                                        printf("%c[%dD", 0x1B,
-                                                width_of_player + 1);
-                                        cursor_x--;
-                                    }
-                                    break;
-
-                                default: {
-                                    end_move = CheckForMove(g,temp,
-                                            player_number,cursor_x,
-                                            cursor_y,width_of_player);
-                                    break;
-                                }
+                            break;
+                        case 'C':
+                            if (cursor_x < g->width - 1) {
+                                printf("%c[%dC", 0x1B,
+                                        width_of_player + 1);
+                                cursor_x++;
                             }
-
                             break;
-                        }
+                        case 'D':
+                            if (cursor_x >= 1) {
+                                printf("%c[%dD", 0x1B,
+                                        width_of_player + 1);
+                                cursor_x--;
+                            }
+                            break;
+
                         default: {
-                            end_move = CheckForMove(g,c,player_number,cursor_x,
-                                                    cursor_y,width_of_player);
+                            end_move = CheckForMove(g,temp,
+                                    player_number,cursor_x,
+                                    cursor_y,width_of_player);
                             break;
                         }
                     }
 
-                    if(!end_move) {
-                        c = (int) getchar();
-                    }
+                    break;
                 }
+                default: {
+                    end_move = CheckForMove(g,c,player_number,cursor_x,
+                                            cursor_y,width_of_player);
+                    break;
+                }
+            }
 
+            if(!end_move) {
+                c = (int) getchar();
             }
         }
     }
@@ -12,9 +12,13 @@
 /** @brief Uruchamia gre w trybie "interactive mode".
  *  Dodano kolory graczy na planszy, kolory nie powtarzają się dla
  *  gry z iloscią graczy mniejszą lub rónwą 13.
- * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- *                      róźny od NULL.
+ *  Ruchy graczy z tablicy @p computer wykonuje bot (@ref gamma_bot_suggest).
+ * @param[in,out] g          – wskiaźnik na strukturę przechowującą stan gry,
+ *                             róźny od NULL.
+ * @param[in] computer       - numery graczy, których ruchy wykonuje bot,
+ * @param[in] computer_count - liczba elementów tablicy @p computer.
  */
-void InteractiveMode(gamma_t *g);
+void InteractiveMode(gamma_t *g, const uint32_t *computer,
+                     uint32_t computer_count);
 
 #endif //GAMMA_INTERACTIVE_MODE_H
@@ -0,0 +1,215 @@
+/** @file
+ * Implementacja dziennika zmian stanu gry
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "gamma.h"
+#include "journal_gamma.h"
+#include "tiles_gamma.h"
+#include "arena_gamma.h"
+#include "legal_gamma.h"
+#include "active_gamma.h"
+
+/** @brief Powiększa tablicę @p array tak, aby zmieścił się w niej jeszcze
+ * jeden element.
+ * @param[in,out] arena    – arena, z której pochodzi pamięć gry,
+ * @param[in,out] array    – wskaźnik na tablicę,
+ * @param[in,out] capacity – rozmiar tablicy,
+ * @param[in] count        – liczba elementów w tablicy,
+ * @param[in] size         – rozmiar jednego elementu.
+ * @return Wartość @p false, gdy nie udało się zaalokować pamięci,
+ * a @p true w przeciwnym przypadku.
+ */
+static bool Reserve(gamma_arena *arena, void **array, uint64_t *capacity,
+                    uint64_t count, size_t size) {
+    if(count < *capacity) {
+        return true;
+    }
+
+    uint64_t new_capacity = *capacity == 0 ? 64 : *capacity * 2;
+    void *new_array = GammaRealloc(arena, *array, size * new_capacity);
+    if(new_array == NULL) {
+        return false;
+    }
+    *array = new_array;
+    *capacity = new_capacity;
+    return true;
+}
+
+void FreeJournal(gamma_arena *arena, journal *j) {
+    if(j == NULL) {
+        return;
+    }
+    GammaFree(arena, j->fields);
+    GammaFree(arena, j->players);
+    GammaFree(arena, j->moves);
+    GammaFree(arena, j);
+}
+
+/** @brief Usuwa dziennik, którego nie da się dalej prowadzić.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+static void DropJournal(gamma_t *g) {
+    FreeJournal(g->arena, g->journal);
+    g->journal = NULL;
+}
+
+void RecordField(gamma_t *g, uint32_t i) {
+    journal *j = g->journal;
+
+    if(!Reserve(g->arena, (void **)&j->fields, &j->fields_capacity, j->fields_count,
+                sizeof(journal_field))) {
+        DropJournal(g);
+        return;
+    }
+    j->fields[j->fields_count].index = i;
+    j->fields[j->fields_count].owner = Owner(g,i);
+    j->fields[j->fields_count].old = *Element(g,i);
+    j->fields_count++;
+}
+
+void RecordPlayer(gamma_t *g, uint32_t player) {
+    journal *j = g->journal;
+
+    if(!Reserve(g->arena, (void **)&j->players, &j->players_capacity, j->players_count,
+                sizeof(journal_player))) {
+        DropJournal(g);
+        return;
+    }
+    j->players[j->players_count].player = player;
+    j->players[j->players_count].old = g->players[player - 1];
+    j->players_count++;
+}
+
+void JournalBeginMove(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                      bool golden) {
+    journal *j = g->journal;
+
+    if(j == NULL) {
+        return;
+    }
+    if(!j->replaying) {
+        // nowy ruch unieważnia cofnięte ruchy
+        j->undone_count = 0;
+    }
+    if(!Reserve(g->arena, (void **)&j->moves, &j->moves_capacity, j->moves_count,
+                sizeof(journal_move))) {
+        DropJournal(g);
+        return;
+    }
+
+    journal_move *move = &j->moves[j->moves_count++];
+    move->player = player;
+    move->x = x;
+    move->y = y;
+    move->golden = golden;
+    move->first_field = j->fields_count;
+    move->first_player = j->players_count;
+    move->free_fields = g->free_fields_under_max_areas;
+}
+
+/** @brief Przywraca stan gry sprzed ruchu @p move, ostatniego w dzienniku,
+ * i usuwa jego wpisy pól i graczy.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry
+ *                      z włączonym dziennikiem,
+ * @param[in] move    – ostatni ruch dziennika.
+ * @return Wartość @p false, gdy nie udało się skopiować współdzielonego
+ * kafelka (wtedy gra nie jest zmieniana), a @p true w przeciwnym przypadku.
+ */
+static bool RevertMove(gamma_t *g, const journal_move *move) {
+    journal *j = g->journal;
+
+    // pola współdzielone z kopiami gry kopiujemy przed pierwszą zmianą
+    for(uint64_t k = move->first_field; k < j->fields_count; k++) {
+        if(!UnshareField(g,j->fields[k].index)) {
+            return false;
+        }
+    }
+
+    // przywracamy zapisane stany od najnowszego do najstarszego
+    while(j->players_count > move->first_player) {
+        j->players_count--;
+        g->players[j->players[j->players_count].player - 1] =
+                j->players[j->players_count].old;
+    }
+    while(j->fields_count > move->first_field) {
+        j->fields_count--;
+        const journal_field *field = &j->fields[j->fields_count];
+        uint32_t owner = Owner(g,field->index);
+        SetOwner(g,field->index,field->owner);
+        if(owner != field->owner) {
+            LegalField(g,field->index,owner,field->owner);
+        }
+        *WritableElement(g,field->index) = field->old;
+    }
+    g->free_fields_under_max_areas = move->free_fields;
+    return true;
+}
+
+void JournalCancelMove(gamma_t *g) {
+    journal *j = g->journal;
+
+    if(j == NULL) {
+        return;
+    }
+    // zmienione pola leżą w kafelkach skopiowanych przed zmianą, więc
+    // przywrócenie się udaje; wraca ono dokładnie ten sam stan planszy,
+    // więc zapamiętane wyniki zbioru graczy pozostają ważne
+    if(!RevertMove(g, &j->moves[j->moves_count - 1])) {
+        DropJournal(g);
+        return;
+    }
+    j->moves_count--;
+}
+
+bool gamma_journal_enable(gamma_t *g, bool enable) {
+    if(g == NULL) {
+        return false;
+    }
+    if(!enable) {
+        DropJournal(g);
+        return true;
+    }
+    if(g->journal == NULL) {
+        g->journal = GammaCalloc(g->arena, 1, sizeof(journal));
+    }
+    return g->journal != NULL;
+}
+
+bool gamma_undo(gamma_t *g) {
+    if(g == NULL || g->journal == NULL || g->journal->moves_count == 0) {
+        return false;
+    }
+
+    journal *j = g->journal;
+    if(!RevertMove(g, &j->moves[j->moves_count - 1])) {
+        return false;
+    }
+    ActiveChanged(g);
+
+    j->moves_count--;
+    j->undone_count++;
+    return true;
+}
+
+bool gamma_redo(gamma_t *g) {
+    if(g == NULL || g->journal == NULL || g->journal->undone_count == 0) {
+        return false;
+    }
+
+    journal *j = g->journal;
+    journal_move move = j->moves[j->moves_count];
+    uint64_t undone_count = j->undone_count;
+
+    j->replaying = true;
+    bool done = move.golden ? gamma_golden_move(g,move.player,move.x,move.y)
+                            : gamma_move(g,move.player,move.x,move.y);
+    if(g->journal != NULL) {
+        g->journal->replaying = false;
+        g->journal->undone_count = undone_count - 1;
+    }
+    return done;
+}
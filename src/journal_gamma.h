@@ -0,0 +1,134 @@
+/** @file
+ * Interfejs dziennika zmian stanu gry
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef JOURNALGAMMA_H
+#define JOURNALGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma_structures.h"
+
+/**
+ * @brief Wpis dziennika przechowujący stan pola planszy sprzed zmiany.
+ */
+typedef struct journal_field {
+    uint32_t index;      /**< indeks pola */
+    uint32_t owner;      /**< numer gracza zajmującego pole przed zmianą */
+    board_element old;   /**< stan pola Union-Find sprzed zmiany */
+} journal_field;
+
+/**
+ * @brief Wpis dziennika przechowujący stan gracza sprzed zmiany.
+ */
+typedef struct journal_player {
+    uint32_t player;     /**< numer gracza */
+    one_player old;      /**< stan gracza sprzed zmiany */
+} journal_player;
+
+/**
+ * @brief Ruch zapisany w dzienniku.
+ * Ruch obejmuje wszystkie wpisy pól i graczy od @p first_field
+ * i @p first_player do początku następnego ruchu.
+ */
+typedef struct journal_move {
+    uint32_t player;       /**< numer gracza wykonującego ruch */
+    uint32_t x;            /**< numer kolumny pola */
+    uint32_t y;            /**< numer wiersza pola */
+    bool golden;           /**< czy ruch był złotym ruchem */
+    uint64_t first_field;  /**< indeks pierwszego wpisu pola ruchu */
+    uint64_t first_player; /**< indeks pierwszego wpisu gracza ruchu */
+    uint64_t free_fields;  /**< wartość @p free_fields_under_max_areas
+                             *  sprzed ruchu */
+} journal_move;
+
+/**
+ * @brief Dziennik zmian stanu gry pozwalający cofać i powtarzać ruchy.
+ * Ruchy cofnięte przez @ref gamma_undo pozostają w tablicy @p moves
+ * za ostatnim wykonanym ruchem, dopóki nie zostanie wykonany nowy ruch.
+ */
+typedef struct journal {
+    journal_field *fields;     /**< wpisy pól planszy */
+    uint64_t fields_count;     /**< liczba wpisów pól */
+    uint64_t fields_capacity;  /**< rozmiar tablicy @p fields */
+
+    journal_player *players;   /**< wpisy graczy */
+    uint64_t players_count;    /**< liczba wpisów graczy */
+    uint64_t players_capacity; /**< rozmiar tablicy @p players */
+
+    journal_move *moves;       /**< wykonane i cofnięte ruchy */
+    uint64_t moves_count;      /**< liczba wykonanych ruchów */
+    uint64_t moves_capacity;   /**< rozmiar tablicy @p moves */
+    uint64_t undone_count;     /**< liczba cofniętych ruchów, które można
+                                 *  powtórzyć */
+    bool replaying;            /**< czy właśnie powtarzany jest ruch */
+} journal;
+
+/** @brief Zapisuje w dzienniku stan pola o indeksie @p i.
+ * Gdy nie uda się zaalokować pamięci, dziennik jest usuwany.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry
+ *                      z włączonym dziennikiem,
+ * @param[in] i       – indeks pola.
+ */
+void RecordField(gamma_t *g, uint32_t i);
+
+/** @brief Zapisuje w dzienniku stan gracza @p player.
+ * Gdy nie uda się zaalokować pamięci, dziennik jest usuwany.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry
+ *                      z włączonym dziennikiem,
+ * @param[in] player  – numer gracza.
+ */
+void RecordPlayer(gamma_t *g, uint32_t player);
+
+/** @brief Zapisuje stan pola o indeksie @p i przed jego zmianą,
+ * jeśli dziennik jest włączony.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ */
+static inline void JournalField(gamma_t *g, uint32_t i) {
+    if(g->journal != NULL) {
+        RecordField(g, i);
+    }
+}
+
+/** @brief Zapisuje stan gracza @p player przed jego zmianą,
+ * jeśli dziennik jest włączony.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza.
+ */
+static inline void JournalPlayer(gamma_t *g, uint32_t player) {
+    if(g->journal != NULL) {
+        RecordPlayer(g, player);
+    }
+}
+
+/** @brief Rozpoczyna zapisywanie ruchu w dzienniku, jeśli jest włączony.
+ * Wszystkie kolejne zmiany pól i graczy należą do tego ruchu.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza wykonującego ruch,
+ * @param[in] x       – numer kolumny pola,
+ * @param[in] y       – numer wiersza pola,
+ * @param[in] golden  – czy ruch jest złotym ruchem.
+ */
+void JournalBeginMove(gamma_t *g, uint32_t player, uint32_t x, uint32_t y,
+                      bool golden);
+
+/** @brief Usuwa z dziennika ruch rozpoczęty przez @ref JournalBeginMove,
+ * który okazał się nielegalny. Zmiany zapisane w czasie jego sprawdzania
+ * (np. skracanie ścieżek w Union-Find albo odłączenie i ponowne dołączenie
+ * pola przy złotym ruchu) są cofane, więc cofnięcie poprzedniego ruchu
+ * obejmuje tylko jego własne zmiany.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+void JournalCancelMove(gamma_t *g);
+
+/** @brief Zwalnia pamięć zajmowaną przez dziennik.
+ * Nic nie robi, jeśli wskaźnik ma wartość NULL.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry,
+ * @param[in] j         – wskiaźnik na dziennik.
+ */
+void FreeJournal(struct gamma_arena *arena, journal *j);
+
+#endif /* JOURNALGAMMA_H */
@@ -0,0 +1,400 @@
+/** @file
+ * Implementacja indeksu pól, na których gracze mogą wykonać ruch
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "legal_gamma.h"
+#include "arena_gamma.h"
+
+/** @brief Podaje sąsiada pola @p i w kierunku @p direction.
+ * @param[in] g         – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i         – indeks pola,
+ * @param[in] direction – kierunek: 0 lewy, 1 prawy, 2 dolny, 3 górny.
+ * @return Indeks sąsiada lub @ref LEGAL_NONE, gdy leżałby poza planszą.
+ */
+static inline uint32_t Neighbour(const gamma_t *g, uint32_t i,
+                                 int direction) {
+    uint32_t x = i % g->width;
+    switch(direction) {
+        case 0:
+            return x > 0 ? i - 1 : LEGAL_NONE;
+        case 1:
+            return x + 1 < g->width ? i + 1 : LEGAL_NONE;
+        case 2:
+            return i >= g->width ? i - g->width : LEGAL_NONE;
+        default:
+            return i / g->width + 1 < g->height ? i + g->width : LEGAL_NONE;
+    }
+}
+
+/** @brief Sprawdza, czy sąsiad pola @p i w kierunku @p direction należy do
+ * gracza @p player.
+ * @param[in] g         – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i         – indeks pola,
+ * @param[in] direction – kierunek sąsiada,
+ * @param[in] player    – numer gracza, liczba dodatnia.
+ * @return Wartość @p true, jeśli sąsiad istnieje i należy do gracza.
+ */
+static inline bool NeighbourOwnedBy(const gamma_t *g, uint32_t i,
+                                    int direction, uint32_t player) {
+    uint32_t n = Neighbour(g, i, direction);
+    return n != LEGAL_NONE && Owner(g, n) == player;
+}
+
+/** @brief Sprawdza, czy wolne pole leży na liście gracza.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks wolnego pola,
+ * @param[in] player  – numer gracza, liczba dodatnia.
+ * @return Wartość @p true, jeśli pole leży na liście gracza @p player.
+ */
+static bool Listed(const gamma_t *g, uint32_t i, uint32_t player) {
+    for(int d = 0; d < 4; d++) {
+        if(g->legal->slots[i][d] != LEGAL_NONE
+           && NeighbourOwnedBy(g, i, d, player)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Dopisuje wolne pole do listy gracza.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i         – indeks wolnego pola,
+ * @param[in] direction – kierunek sąsiada pola należącego do gracza,
+ * @param[in] player    – numer gracza, liczba dodatnia.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool AddAdjacent(gamma_t *g, uint32_t i, int direction,
+                        uint32_t player) {
+    legal_list *list = &g->legal->adjacent[player - 1];
+    if(list->count == list->capacity) {
+        uint64_t capacity = list->capacity == 0 ? 16 : list->capacity * 2;
+        legal_entry *entries = GammaRealloc(g->arena, list->entries,
+                                            sizeof(legal_entry) * capacity);
+        if(entries == NULL) {
+            return false;
+        }
+        list->entries = entries;
+        list->capacity = capacity;
+    }
+    list->entries[list->count] = (legal_entry){i, (uint32_t)direction};
+    g->legal->slots[i][direction] = list->count++;
+    return true;
+}
+
+/** @brief Usuwa wolne pole z listy gracza, przenosząc na jego miejsce
+ * ostatni wpis listy.
+ * @param[in,out] g     – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i         – indeks wolnego pola,
+ * @param[in] direction – kierunek, w którego miejscu zapamiętana jest
+ *                        pozycja pola,
+ * @param[in] player    – numer gracza, liczba dodatnia.
+ */
+static void RemoveAdjacent(gamma_t *g, uint32_t i, int direction,
+                           uint32_t player) {
+    legal_index *index = g->legal;
+    legal_list *list = &index->adjacent[player - 1];
+    uint32_t position = index->slots[i][direction];
+    legal_entry last = list->entries[--list->count];
+    if(position != list->count) {
+        list->entries[position] = last;
+        index->slots[last.field][last.direction] = position;
+    }
+    index->slots[i][direction] = LEGAL_NONE;
+}
+
+/** @brief Dopisuje wolne pole do list graczy zajmujących jego sąsiadów.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks wolnego pola, niewystępującego na listach.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool ListEmpty(gamma_t *g, uint32_t i) {
+    legal_index *index = g->legal;
+    index->empty[index->empty_count] = i;
+    index->empty_position[i] = index->empty_count++;
+
+    for(int d = 0; d < 4; d++) {
+        uint32_t n = Neighbour(g, i, d);
+        uint32_t owner = n == LEGAL_NONE ? 0 : Owner(g, n);
+        if(owner != 0 && !Listed(g, i, owner) && !AddAdjacent(g, i, d, owner)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Usuwa pole, które przestało być wolne, z tablicy wolnych pól
+ * i z list graczy.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ */
+static void UnlistEmpty(gamma_t *g, uint32_t i) {
+    legal_index *index = g->legal;
+    for(int d = 0; d < 4; d++) {
+        if(index->slots[i][d] != LEGAL_NONE) {
+            RemoveAdjacent(g, i, d, Owner(g, Neighbour(g, i, d)));
+        }
+    }
+
+    uint32_t position = index->empty_position[i];
+    uint32_t last = index->empty[--index->empty_count];
+    index->empty[position] = last;
+    index->empty_position[last] = position;
+}
+
+/** @brief Zwalnia pamięć zajmowaną przez indeks.
+ * @param[in,out] arena – arena, z której pochodzi pamięć gry,
+ * @param[in] index     – indeks lub NULL,
+ * @param[in] players   – liczba graczy.
+ */
+static void FreeLegal(gamma_arena *arena, legal_index *index,
+                      uint32_t players) {
+    if(index == NULL) {
+        return;
+    }
+    if(index->adjacent != NULL) {
+        for(uint32_t p = 0; p < players; p++) {
+            GammaFree(arena, index->adjacent[p].entries);
+        }
+    }
+    GammaFree(arena, index->adjacent);
+    GammaFree(arena, index->slots);
+    GammaFree(arena, index->empty_position);
+    GammaFree(arena, index->empty);
+    GammaFree(arena, index);
+}
+
+void DropLegal(gamma_t *g) {
+    FreeLegal(g->arena, g->legal, g->number_of_players);
+    g->legal = NULL;
+}
+
+/** @brief Buduje indeks gry, przeglądając całą planszę.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool BuildLegal(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    legal_index *index = GammaCalloc(g->arena, 1, sizeof(legal_index));
+    if(index == NULL) {
+        return false;
+    }
+    g->legal = index;
+    index->empty = GammaAlloc(g->arena, sizeof(uint32_t) * fields);
+    index->empty_position = GammaAlloc(g->arena, sizeof(uint32_t) * fields);
+    index->slots = GammaAlloc(g->arena, sizeof(uint32_t[4]) * fields);
+    index->adjacent = GammaCalloc(g->arena, g->number_of_players,
+                                  sizeof(legal_list));
+    if(index->empty == NULL || index->empty_position == NULL
+       || index->slots == NULL || index->adjacent == NULL) {
+        DropLegal(g);
+        return false;
+    }
+    memset(index->slots, 0xFF, sizeof(uint32_t[4]) * fields);
+
+    for(uint32_t i = 0; i < fields; i++) {
+        if(Owner(g, i) == 0 && !ListEmpty(g, i)) {
+            DropLegal(g);
+            return false;
+        }
+    }
+    return true;
+}
+
+void UpdateLegal(gamma_t *g, uint32_t i, uint32_t before, uint32_t after) {
+    legal_index *index = g->legal;
+
+    if(before != 0) {
+        // wolni sąsiedzi pola mogli sąsiadować z graczem before tylko przez
+        // to pole; jeśli nie, ich pozycja przenosi się do innego sąsiada
+        for(int d = 0; d < 4; d++) {
+            uint32_t n = Neighbour(g, i, d);
+            int toward = d ^ 1;
+            if(n == LEGAL_NONE || Owner(g, n) != 0
+               || index->slots[n][toward] == LEGAL_NONE) {
+                continue;
+            }
+            int other;
+            for(other = 0; other < 4; other++) {
+                if(other != toward && NeighbourOwnedBy(g, n, other, before)) {
+                    break;
+                }
+            }
+            if(other < 4) {
+                uint32_t position = index->slots[n][toward];
+                index->slots[n][other] = position;
+                index->slots[n][toward] = LEGAL_NONE;
+                index->adjacent[before - 1].entries[position].direction = other;
+            } else {
+                RemoveAdjacent(g, n, toward, before);
+            }
+        }
+        if(after == 0 && !ListEmpty(g, i)) {
+            DropLegal(g);
+            return;
+        }
+    }
+
+    if(after != 0) {
+        if(before == 0) {
+            UnlistEmpty(g, i);
+        }
+        for(int d = 0; d < 4; d++) {
+            uint32_t n = Neighbour(g, i, d);
+            if(n != LEGAL_NONE && Owner(g, n) == 0 && !Listed(g, n, after)
+               && !AddAdjacent(g, n, d ^ 1, after)) {
+                DropLegal(g);
+                return;
+            }
+        }
+    }
+}
+
+/** @brief Zapewnia, że gra ma indeks.
+ * @param[in,out] g   – wskaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p true, jeśli gra ma indeks.
+ */
+static bool EnsureLegal(gamma_t *g) {
+    return g->legal != NULL || BuildLegal(g);
+}
+
+/** @brief Sprawdza, czy gracz może zająć każde wolne pole.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od liczby
+ *                      graczy.
+ * @return Wartość @p true, jeśli gracz ma mniej obszarów niż maksymalnie.
+ */
+static inline bool Anywhere(const gamma_t *g, uint32_t player) {
+    return g->players[player - 1].number_of_areas < g->max_areas;
+}
+
+/** @brief Sprawdza bez indeksu, czy gracz może zająć wolne pole.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] i       – indeks pola.
+ * @return Wartość @p true, jeśli ruch na pole jest poprawny.
+ */
+static bool LegalWithoutIndex(const gamma_t *g, uint32_t player, uint32_t i) {
+    if(Owner(g, i) != 0) {
+        return false;
+    }
+    if(Anywhere(g, player)) {
+        return true;
+    }
+    for(int d = 0; d < 4; d++) {
+        if(NeighbourOwnedBy(g, i, d, player)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Podaje pole o numerze @p k na liście pól, na których gracz może
+ * wykonać ruch.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry
+ *                      z indeksem,
+ * @param[in] player  – numer gracza,
+ * @param[in] k       – numer pola, mniejszy od liczby pól na liście.
+ * @return Indeks pola.
+ */
+static inline uint32_t LegalAt(const gamma_t *g, uint32_t player,
+                               uint64_t k) {
+    return Anywhere(g, player) ? g->legal->empty[k]
+                               : g->legal->adjacent[player - 1].entries[k].field;
+}
+
+/** @brief Podaje liczbę pól na liście pól, na których gracz może wykonać
+ * ruch.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry
+ *                      z indeksem,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól.
+ */
+static inline uint64_t LegalCount(const gamma_t *g, uint32_t player) {
+    return Anywhere(g, player) ? g->legal->empty_count
+                               : g->legal->adjacent[player - 1].count;
+}
+
+uint64_t gamma_legal_moves(gamma_t *g, uint32_t player, gamma_field *moves,
+                           uint64_t capacity) {
+    if(g == NULL || player == 0 || player > g->number_of_players
+       || (moves == NULL && capacity > 0)) {
+        return 0;
+    }
+
+    uint64_t count = 0;
+    if(EnsureLegal(g)) {
+        count = LegalCount(g, player);
+        for(uint64_t k = 0; k < count && k < capacity; k++) {
+            uint32_t i = LegalAt(g, player, k);
+            moves[k] = (gamma_field){i % g->width, i / g->width};
+        }
+        return count;
+    }
+
+    // bez pamięci na indeks przeglądamy planszę
+    uint64_t fields = (uint64_t)g->width * g->height;
+    for(uint32_t i = 0; i < fields; i++) {
+        if(LegalWithoutIndex(g, player, i)) {
+            if(count < capacity) {
+                moves[count] = (gamma_field){i % g->width, i / g->width};
+            }
+            count++;
+        }
+    }
+    return count;
+}
+
+/** @brief Losuje kolejną liczbę generatorem splitmix64.
+ * @param[in,out] state – stan generatora, dowolna liczba.
+ * @return Liczba pseudolosowa.
+ */
+static uint64_t SplitMix(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** @brief Losuje liczbę z przedziału [0, @p bound).
+ * @param[in,out] state – stan generatora,
+ * @param[in] bound     – liczba dodatnia.
+ * @return Liczba pseudolosowa.
+ */
+static uint64_t RandomBelow(uint64_t *state, uint64_t bound) {
+    return (uint64_t)(((unsigned __int128)SplitMix(state) * bound) >> 64);
+}
+
+bool gamma_random_legal_move(gamma_t *g, uint32_t player, uint64_t *rng,
+                             uint32_t *x, uint32_t *y) {
+    if(g == NULL || player == 0 || player > g->number_of_players
+       || rng == NULL || x == NULL || y == NULL) {
+        return false;
+    }
+
+    uint32_t i;
+    if(EnsureLegal(g)) {
+        uint64_t count = LegalCount(g, player);
+        if(count == 0) {
+            return false;
+        }
+        i = LegalAt(g, player, RandomBelow(rng, count));
+    } else {
+        uint64_t count = gamma_legal_moves(g, player, NULL, 0);
+        if(count == 0) {
+            return false;
+        }
+        uint64_t k = RandomBelow(rng, count);
+        for(i = 0; !LegalWithoutIndex(g, player, i) || k-- > 0; i++) {
+        }
+    }
+    *x = i % g->width;
+    *y = i / g->width;
+    return true;
+}
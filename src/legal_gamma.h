@@ -0,0 +1,92 @@
+/** @file
+ * Interfejs indeksu pól, na których gracze mogą wykonać ruch
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef LEGALGAMMA_H
+#define LEGALGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma_structures.h"
+
+/** @brief Brak pozycji pola na liście. */
+#define LEGAL_NONE UINT32_MAX
+
+/**
+ * @brief Wpis listy wolnych pól sąsiadujących z graczem.
+ */
+typedef struct legal_entry {
+    uint32_t field;      /**< indeks wolnego pola */
+    uint32_t direction;  /**< kierunek sąsiada gracza, w którego miejscu
+                           *  @ref legal_index::slots pamięta pozycję wpisu */
+} legal_entry;
+
+/**
+ * @brief Lista wolnych pól sąsiadujących z jednym graczem, z której pola
+ * usuwa się, przenosząc na ich miejsce ostatni wpis.
+ */
+typedef struct legal_list {
+    legal_entry *entries;   /**< wpisy listy */
+    uint64_t count;         /**< liczba wpisów */
+    uint64_t capacity;      /**< rozmiar tablicy @p entries */
+} legal_list;
+
+/**
+ * @brief Indeks pól, na których gracze mogą wykonać ruch, aktualizowany
+ * przy każdej zmianie właściciela pola.
+ * Gracz, który ma mniej obszarów niż maksymalnie, może zająć każde wolne
+ * pole; pozostali tylko wolne pola sąsiadujące z ich polami. Oba zbiory
+ * są tablicami, z których można w czasie stałym wylosować pole lub usunąć
+ * dowolne pole.
+ * Kierunki sąsiadów to kolejno: lewy, prawy, dolny i górny. Wolne pole
+ * sąsiadujące z graczem leży na jego liście raz, a jego pozycja jest
+ * zapamiętana w @p slots w miejscu jednego z sąsiadów należących do tego
+ * gracza; pozostałe miejsca mają wartość @ref LEGAL_NONE.
+ */
+typedef struct legal_index {
+    uint32_t *empty;            /**< wolne pola */
+    uint32_t *empty_position;   /**< pozycje wolnych pól w @p empty */
+    uint64_t empty_count;       /**< liczba wolnych pól */
+    uint32_t (*slots)[4];       /**< pozycje wolnego pola na listach graczy
+                                  *  zajmujących jego sąsiadów */
+    legal_list *adjacent;       /**< listy wolnych pól sąsiadujących
+                                  *  z graczami, gracz @p i ma listę
+                                  *  o indeksie @p i - 1 */
+} legal_index;
+
+/** @brief Aktualizuje indeks po zmianie właściciela pola @p i z @p before
+ * na @p after. Gdy nie uda się zaalokować pamięci, indeks jest usuwany
+ * i zostanie zbudowany od nowa przy następnym zapytaniu.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry
+ *                      z indeksem, z już zmienionym właścicielem pola,
+ * @param[in] i       – indeks pola,
+ * @param[in] before  – poprzedni właściciel pola lub 0,
+ * @param[in] after   – nowy właściciel pola lub 0.
+ */
+void UpdateLegal(gamma_t *g, uint32_t i, uint32_t before, uint32_t after);
+
+/** @brief Aktualizuje indeks po zmianie właściciela pola, jeśli gra ma
+ * indeks.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ *                      z już zmienionym właścicielem pola,
+ * @param[in] i       – indeks pola,
+ * @param[in] before  – poprzedni właściciel pola lub 0,
+ * @param[in] after   – nowy właściciel pola lub 0.
+ */
+static inline void LegalField(gamma_t *g, uint32_t i, uint32_t before,
+                              uint32_t after) {
+    if(g->legal != NULL) {
+        UpdateLegal(g, i, before, after);
+    }
+}
+
+/** @brief Usuwa indeks gry, na przykład gdy plansza zmieniła się bez
+ * aktualizacji indeksu. Zostanie zbudowany od nowa przy następnym
+ * zapytaniu.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+void DropLegal(gamma_t *g);
+
+#endif /* LEGALGAMMA_H */
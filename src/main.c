@@ -12,8 +12,10 @@
 #include <stdbool.h>
 #include <string.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 #include "gamma.h"
 #include "batch_mode.h"
+#include "session_mode.h"
 #include "interactive_mode.h"
 #include "errno.h"
 #include "utilities.h"
@@ -134,13 +136,150 @@ bool WillItFit(uint32_t width, uint32_t height,uint32_t players,gamma_t *g) {
     }
 }
 
+/** @brief Odczytuje z reszty linii "S" liczbę wątków trybu wielu gier.
+ * Bez argumentu liczba wątków równa jest liczbie procesorów, ale nie
+ * większa od @ref SESSION_MAX_WORKERS.
+ * @param[out] workers - liczba wątków.
+ * @return true - argument był poprawny.
+ *         false - argument nie był poprawny.
+ */
+bool GetWorkers(uint32_t *workers) {
+    char avoid[] = " \t\v\f\r\n";
+    char *buffor = strtok(NULL, avoid);
+
+    if(buffor == NULL) {
+        *workers = Processors(SESSION_MAX_WORKERS);
+        return true;
+    }
+
+    uint32_t value = 0;
+    for(const char *digit = buffor; *digit != '\0'; digit++) {
+        if(!isNumber(*digit)) {
+            return false;
+        }
+        value = value * 10 + (*digit - '0');
+        if(value > SESSION_MAX_WORKERS) {
+            return false;
+        }
+    }
+    if(value == 0 || strtok(NULL, avoid) != NULL) {
+        return false;
+    }
+
+    *workers = value;
+    return true;
+}
+
+/** @brief Odczytuje dodatnią liczbę dziesiętną mieszczącą się w uint32_t
+ * z argumentu programu.
+ * @param[in] text   - argument,
+ * @param[out] value - odczytana liczba.
+ * @return true - argument był poprawny.
+ *         false - argument nie był poprawny.
+ */
+bool GetPositive(const char *text, uint32_t *value) {
+    uint64_t result = 0;
+    for(const char *digit = text; *digit != '\0'; digit++) {
+        if(!isNumber(*digit)) {
+            return false;
+        }
+        result = result * 10 + (*digit - '0');
+        if(result > UINT32_MAX) {
+            return false;
+        }
+    }
+    if(text[0] == '\0' || result == 0) {
+        return false;
+    }
+
+    *value = result;
+    return true;
+}
+
+/** @brief Odczytuje opcje programu. Opcja "--flush-every N" każe w trybie
+ * wsadowym wypisywać odpowiedzi co @p N linii wejścia lub rekordów trybu
+ * binarnego. Bez niej odpowiedzi są wypisywane po każdej linii, jeśli stdout
+ * jest terminalem, a w przeciwnym przypadku po zapełnieniu bufora.
+ * Opcja "--computer P", którą można podać wiele razy, każe w trybie
+ * interaktywnym wykonywać ruchy gracza @p P botowi.
+ * @param[in] argc            - liczba argumentów programu,
+ * @param[in] argv            - argumenty programu,
+ * @param[out] flush_every    - co ile linii wypisywać odpowiedzi, 0 gdy tylko
+ *                              po zapełnieniu bufora,
+ * @param[out] computer       - tablica na numery graczy bota, o rozmiarze
+ *                              co najmniej @p argc,
+ * @param[out] computer_count - liczba graczy bota.
+ * @return true - opcje były poprawne.
+ *         false - opcje nie były poprawne.
+ */
+bool GetOptions(int argc, char *argv[], uint32_t *flush_every,
+                uint32_t *computer, uint32_t *computer_count) {
+    *flush_every = isatty(STDOUT_FILENO) ? 1 : 0;
+    *computer_count = 0;
+
+    for(int k = 1; k < argc; k += 2) {
+        if(k + 1 == argc) {
+            return false;
+        }
+        if(strcmp(argv[k], "--flush-every") == 0) {
+            if(!GetPositive(argv[k + 1], flush_every)) {
+                return false;
+            }
+        } else if(strcmp(argv[k], "--computer") == 0) {
+            if(!GetPositive(argv[k + 1], &computer[*computer_count])) {
+                return false;
+            }
+            (*computer_count)++;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+/** @brief Wyłącza buforowanie stdin przed trybami wsadowymi, które czytają
+ * dalszą część wejścia bezpośrednio z deskryptora, aby stdio nie mogło
+ * wczytać jej z wyprzedzeniem. Tryb interaktywny zachowuje buforowanie.
+ * Nagłówki trybów są czytane przez @ref getline2 z pominięciem stdio, więc
+ * strumień nie był jeszcze używany.
+ */
+static void UnbufferStdin(void) {
+    setvbuf(stdin, NULL, _IONBF, 0);
+}
+
+#ifdef GAMMA_STATS
+/** @brief Wypisuje liczniki i histogramy pracy silnika na stderr.
+ * Wywoływana przy zakończeniu programu skompilowanego z GAMMA_STATS.
+ */
+static void DumpStats(void) {
+    gamma_stats_write(stderr);
+}
+#endif
+
 /** @brief Główna funkcja programu, zbiera wejście z stdin i jeśli parametry
  * wejściowe są poprawne i pozwalają (pamięciowo) na stworzenie nowej gry gamma
- * to wywołuje grę w "batch mode" lub "interactive mode".
+ * to wywołuje grę w "batch mode", binarnym trybie wsadowym (nagłówek "X")
+ * lub "interactive mode". Nagłówek "S" uruchamia tryb wielu gier.
  * w innym wypadku wypisuje na stderr "ERROR \a numer a\ wiersza".
- * @return 0.
+ * @param[in] argc - liczba argumentów programu,
+ * @param[in] argv - argumenty programu, opisane przy @ref GetOptions.
+ * @return 0, a 1 gdy argumenty programu były niepoprawne.
  */
-int main() {
+int main(int argc, char *argv[]) {
+    uint32_t flush_every;
+    uint32_t computer_count;
+    uint32_t *computer = malloc(sizeof(uint32_t) * argc);
+    if(computer == NULL
+       || !GetOptions(argc, argv, &flush_every, computer, &computer_count)) {
+        fprintf(stderr, "Użycie: %s [--flush-every N] [--computer P]...\n",
+                argv[0]);
+        free(computer);
+        return 1;
+    }
+#ifdef GAMMA_STATS
+    atexit(DumpStats);
+#endif
+
     // zmienna do wczytywania linii z getline
     // jest zaalokowana pesymistycznie ponieważ poprawne wejście nigdy nie
     // przekroczy 50 znaków.
@@ -185,12 +324,59 @@ int main() {
 
                         line_number++;
 
-                        BatchMode(new_game, line_number);
+                        UnbufferStdin();
+                        new_game = BatchMode(new_game, line_number, flush_every);
 
                         gamma_delete(new_game);
                         free(input);
                         //free(buffor);
                         free(newline);
+                        free(computer);
+
+                        return 0;
+
+                    } else {
+                        fprintf(stderr,"ERROR %d\n", line_number);
+                    }
+                } else {
+                    fprintf(stderr,"ERROR %d\n", line_number);
+                }
+                free(input);
+            } else if (strcmp("S", buffor) == 0) {
+
+                uint32_t workers;
+
+                bool started = GetWorkers(&workers);
+                if (started) {
+                    UnbufferStdin();
+                    started = SessionMode(line_number, workers);
+                }
+                if (started) {
+                    free(newline);
+                    free(computer);
+
+                    return 0;
+                } else {
+                    fprintf(stderr,"ERROR %d\n", line_number);
+                }
+            } else if (strcmp("X", buffor) == 0) {
+
+                uint32_t *input = malloc(sizeof(uint32_t) * 4);
+
+                if (GetInput(&input)) {
+                    gamma_t *new_game = gamma_new(input[0], input[1],
+                                                  input[2], input[3]);
+
+                    if(new_game != NULL) {
+                        printf("OK %d\n",line_number);
+
+                        UnbufferStdin();
+                        new_game = BinaryMode(new_game, flush_every);
+
+                        gamma_delete(new_game);
+                        free(input);
+                        free(newline);
+                        free(computer);
 
                         return 0;
 
@@ -217,12 +403,14 @@ int main() {
                                        " i sprobować ponownie.\n");
                             } else {
 
-                                InteractiveMode(new_game);
+                                InteractiveMode(new_game, computer,
+                                                computer_count);
 
                                 gamma_delete(new_game);
                                 free(input);
                                 //free(buffor);
                                 free(newline);
+                                free(computer);
 
                                 return 0;
                             }
@@ -246,6 +434,7 @@ int main() {
 
 
     free(newline);
+    free(computer);
 
     return 0;
 }
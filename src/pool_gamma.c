@@ -0,0 +1,239 @@
+/** @file
+ * Implementacja puli gier o jednakowych parametrach
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "tiles_gamma.h"
+#include "journal_gamma.h"
+#include "legal_gamma.h"
+#include "active_gamma.h"
+#include "pool_gamma.h"
+
+/** @brief Przybliżony rozmiar bloku pamięci puli, dzielonego na miejsca
+ * gier. Blok ma co najmniej jedno miejsce. */
+#define POOL_SLAB 1048576
+
+/**
+ * @brief Nagłówek miejsca gry w bloku puli, wskazujący następne wolne
+ * miejsce. Gra leży za nagłówkiem, więc jej stan nie jest zmieniany przez
+ * listę wolnych miejsc.
+ */
+typedef union pool_slot {
+    union pool_slot *next;   /**< następne wolne miejsce */
+    max_align_t alignment;   /**< wyrównanie gry za nagłówkiem */
+} pool_slot;
+
+/**
+ * @brief Nagłówek bloku pamięci puli.
+ */
+typedef union pool_slab {
+    union pool_slab *next;   /**< następny blok puli */
+    max_align_t alignment;   /**< wyrównanie miejsc za nagłówkiem */
+} pool_slab;
+
+/**
+ * @brief Struktura przechowująca stan puli.
+ * Miejsce gry zawiera kolejno nagłówek, strukturę gry, opis obszaru
+ * @ref board_mapping, stany graczy, wskaźniki kafelków, kafelki i bufory
+ * przechodzenia planszy; pola @p *_offset to ich położenia w miejscu.
+ * Dziennik ruchów, indeks legalnych ruchów i zbiór graczy, którzy mogą
+ * wykonać ruch, są alokowane poza miejscem przy pierwszym użyciu.
+ */
+struct gamma_pool {
+    uint32_t width;             /**< szerokość planszy */
+    uint32_t height;            /**< wysokość planszy */
+    uint32_t players;           /**< liczba graczy */
+    uint32_t areas;             /**< maksymalna liczba obszarów */
+    size_t game_offset;         /**< położenie struktury gry */
+    size_t mapping_offset;      /**< położenie opisu obszaru */
+    size_t players_offset;      /**< położenie stanów graczy */
+    size_t tiles_offset;        /**< położenie wskaźników kafelków */
+    size_t board_offset;        /**< położenie kafelków */
+    size_t visited_offset;      /**< położenie znaczników odwiedzenia */
+    size_t queue_offset;        /**< położenie kolejki pól */
+    size_t discovery_offset;    /**< położenie czasów odwiedzenia */
+    size_t low_offset;          /**< położenie wartości low */
+    size_t dfs_state_offset;    /**< położenie stanów przeszukiwania */
+    size_t slot_size;           /**< rozmiar miejsca gry */
+    size_t slots_per_slab;      /**< liczba miejsc w bloku */
+    pool_slot *free;            /**< wolne miejsca */
+    pool_slab *slabs;           /**< bloki pamięci puli */
+};
+
+/** @brief Rezerwuje w miejscu gry @p size bajtów wyrównanych do
+ * @p alignment.
+ * @param[in,out] end      – koniec zajętej części miejsca,
+ * @param[in] size         – liczba bajtów,
+ * @param[in] alignment    – wyrównanie, potęga dwójki.
+ * @return Położenie zarezerwowanej części.
+ */
+static uint64_t Place(uint64_t *end, uint64_t size, size_t alignment) {
+    uint64_t offset = (*end + alignment - 1) & ~(uint64_t)(alignment - 1);
+    *end = offset + size;
+    return offset;
+}
+
+/** @brief Dokłada do puli blok wolnych miejsc.
+ * Blok jest zerowany, więc znaczniki odwiedzenia nowych gier są zgodne
+ * z zerowym numerem przechodzenia.
+ * @param[in,out] pool – wskaźnik na pulę.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static bool AddSlab(gamma_pool *pool) {
+    pool_slab *slab = calloc(1, sizeof(pool_slab)
+                                + pool->slot_size * pool->slots_per_slab);
+    if(slab == NULL) {
+        return false;
+    }
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+
+    char *first = (char *)(slab + 1);
+    for(size_t k = pool->slots_per_slab; k-- > 0;) {
+        ReturnSlot(pool, first + k * pool->slot_size);
+    }
+    return true;
+}
+
+void ReturnSlot(gamma_pool *pool, void *slot) {
+    pool_slot *free_slot = slot;
+    free_slot->next = pool->free;
+    pool->free = free_slot;
+}
+
+gamma_pool* gamma_pool_new(uint32_t width, uint32_t height,
+                           uint32_t players, uint32_t areas) {
+    uint64_t fields = (uint64_t)width * height;
+    if(width == 0 || height == 0 || areas == 0 || players == 0
+       || fields > UINT32_MAX) {
+        return NULL;
+    }
+
+    gamma_pool *pool = malloc(sizeof(gamma_pool));
+    if(pool == NULL) {
+        return NULL;
+    }
+    pool->width = width;
+    pool->height = height;
+    pool->players = players;
+    pool->areas = areas;
+    pool->free = NULL;
+    pool->slabs = NULL;
+
+    uint64_t tiles = (fields + TILE_FIELDS - 1) >> TILE_BITS;
+    gamma_t shape = {.width = width, .height = height,
+                     .number_of_players = players};
+    BoardShape(&shape);
+    uint64_t end = sizeof(pool_slot);
+    pool->game_offset = Place(&end, sizeof(gamma_t), _Alignof(gamma_t));
+    pool->mapping_offset = Place(&end, sizeof(board_mapping),
+                                 _Alignof(board_mapping));
+    pool->players_offset = Place(&end, sizeof(one_player) * players,
+                                 _Alignof(one_player));
+    pool->tiles_offset = Place(&end, sizeof(board_tile *) * tiles,
+                               _Alignof(board_tile *));
+    pool->board_offset = Place(&end, BoardBytes(&shape),
+                               _Alignof(board_tile));
+    pool->visited_offset = Place(&end, sizeof(uint32_t) * fields,
+                                 _Alignof(uint32_t));
+    pool->queue_offset = Place(&end, sizeof(uint32_t) * fields,
+                               _Alignof(uint32_t));
+    pool->discovery_offset = Place(&end, sizeof(uint32_t) * fields,
+                                   _Alignof(uint32_t));
+    pool->low_offset = Place(&end, sizeof(uint32_t) * fields,
+                             _Alignof(uint32_t));
+    pool->dfs_state_offset = Place(&end, sizeof(uint8_t) * fields,
+                                   _Alignof(uint8_t));
+    uint64_t slot_size = Place(&end, 0, _Alignof(pool_slot));
+    if(slot_size > SIZE_MAX - sizeof(pool_slab) - POOL_SLAB) {
+        free(pool);
+        return NULL;
+    }
+    pool->slot_size = slot_size;
+    pool->slots_per_slab = POOL_SLAB / slot_size > 0 ? POOL_SLAB / slot_size
+                                                     : 1;
+    return pool;
+}
+
+gamma_t* gamma_pool_acquire(gamma_pool *pool) {
+    if(pool == NULL || (pool->free == NULL && !AddSlab(pool))) {
+        return NULL;
+    }
+    char *slot = (char *)pool->free;
+    pool->free = pool->free->next;
+
+    gamma_t *g = (gamma_t *)(slot + pool->game_offset);
+    board_mapping *mapping = (board_mapping *)(slot + pool->mapping_offset);
+    atomic_init(&mapping->references, 1);
+    mapping->address = slot;
+    mapping->length = pool->slot_size;
+    mapping->pool = pool;
+    mapping->tile_references = NULL;
+
+    // znaczniki odwiedzenia i numer przechodzenia zostają z poprzedniej gry,
+    // więc nie trzeba ich czyścić
+    g->visited = (uint32_t *)(slot + pool->visited_offset);
+    g->queue = (uint32_t *)(slot + pool->queue_offset);
+    g->discovery = (uint32_t *)(slot + pool->discovery_offset);
+    g->low = (uint32_t *)(slot + pool->low_offset);
+    g->dfs_state = (uint8_t *)(slot + pool->dfs_state_offset);
+    g->journal = NULL;
+    g->legal = NULL;
+    g->active = NULL;
+    g->arena = NULL;
+    g->pool = pool;
+    g->query_threads = 1;
+    g->mapping = mapping;
+    g->width = pool->width;
+    g->height = pool->height;
+    g->number_of_players = pool->players;
+    g->max_areas = pool->areas;
+    g->free_fields_under_max_areas = (uint64_t)pool->width * pool->height;
+
+    g->players = (one_player *)(slot + pool->players_offset);
+    for(uint32_t i = 0; i < pool->players; i++) {
+        g->players[i].number_of_areas = 0;
+        g->players[i].busy_fields = 0;
+        g->players[i].adjacent_free_fields = 0;
+        g->players[i].gold_possible = true;
+    }
+
+    PlaceBoard(g, (board_tile **)(slot + pool->tiles_offset),
+               slot + pool->board_offset);
+    return g;
+}
+
+void gamma_pool_release(gamma_t *g) {
+    if(g == NULL) {
+        return;
+    }
+    if(g->pool == NULL) {
+        gamma_delete(g);
+        return;
+    }
+    // struktury tworzone przy pierwszym użyciu leżą poza miejscem gry
+    FreeJournal(g->arena, g->journal);
+    g->journal = NULL;
+    DropLegal(g);
+    DropActive(g);
+    // miejsce wraca do puli, gdy nie używa go już żadna kopia gry
+    FreeBoard(g);
+}
+
+void gamma_pool_delete(gamma_pool *pool) {
+    if(pool == NULL) {
+        return;
+    }
+    while(pool->slabs != NULL) {
+        pool_slab *slab = pool->slabs;
+        pool->slabs = slab->next;
+        free(slab);
+    }
+    free(pool);
+}
@@ -0,0 +1,19 @@
+/** @file
+ * Interfejs puli gier o jednakowych parametrach
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef POOLGAMMA_H
+#define POOLGAMMA_H
+
+#include "gamma.h"
+
+/** @brief Oddaje do puli miejsce gry, którego nie używa już ani gra,
+ * ani żadna jej kopia.
+ * @param[in,out] pool – wskaźnik na pulę,
+ * @param[in] slot     – początek miejsca gry.
+ */
+void ReturnSlot(gamma_pool *pool, void *slot);
+
+#endif /* POOLGAMMA_H */
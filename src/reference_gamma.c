@@ -0,0 +1,251 @@
+/** @file
+ * Implementacja wzorcowego silnika gry gamma
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "reference_gamma.h"
+
+reference_gamma* ReferenceNew(uint32_t width, uint32_t height,
+                              uint32_t players, uint32_t areas) {
+    uint64_t fields = (uint64_t)width * height;
+    if(width == 0 || height == 0 || players == 0 || areas == 0
+       || fields > UINT32_MAX) {
+        return NULL;
+    }
+
+    reference_gamma *r = malloc(sizeof(reference_gamma));
+    if(r == NULL) {
+        return NULL;
+    }
+    r->width = width;
+    r->height = height;
+    r->players = players;
+    r->areas = areas;
+    r->owners = calloc(fields, sizeof(uint32_t));
+    r->golden_used = calloc((uint64_t)players + 1, sizeof(bool));
+    r->seen = calloc(fields, sizeof(bool));
+    r->queue = malloc(sizeof(uint32_t) * fields);
+    if(r->owners == NULL || r->golden_used == NULL || r->seen == NULL
+       || r->queue == NULL) {
+        ReferenceDelete(r);
+        return NULL;
+    }
+    return r;
+}
+
+void ReferenceDelete(reference_gamma *r) {
+    if(r == NULL) {
+        return;
+    }
+    free(r->owners);
+    free(r->golden_used);
+    free(r->seen);
+    free(r->queue);
+    free(r);
+}
+
+/** @brief Wyznacza sąsiadów pola leżących na planszy.
+ * @param[in] r           – wskaźnik na stan gry,
+ * @param[in] i           – indeks pola,
+ * @param[out] neighbours – indeksy sąsiadów.
+ * @return Liczba sąsiadów.
+ */
+static int Neighbours(const reference_gamma *r, uint32_t i,
+                      uint32_t neighbours[4]) {
+    uint32_t x = i % r->width, y = i / r->width;
+    int n = 0;
+    if(x > 0) {
+        neighbours[n++] = i - 1;
+    }
+    if(x + 1 < r->width) {
+        neighbours[n++] = i + 1;
+    }
+    if(y > 0) {
+        neighbours[n++] = i - r->width;
+    }
+    if(y + 1 < r->height) {
+        neighbours[n++] = i + r->width;
+    }
+    return n;
+}
+
+/** @brief Sprawdza, czy pole sąsiaduje z polem gracza.
+ * @param[in] r       – wskaźnik na stan gry,
+ * @param[in] i       – indeks pola,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli któryś sąsiad należy do gracza.
+ */
+static bool Touches(const reference_gamma *r, uint32_t i, uint32_t player) {
+    uint32_t neighbours[4];
+    int n = Neighbours(r, i, neighbours);
+    for(int k = 0; k < n; k++) {
+        if(r->owners[neighbours[k]] == player) {
+            return true;
+        }
+    }
+    return false;
+}
+
+uint32_t ReferenceAreas(reference_gamma *r, uint32_t player) {
+    uint32_t fields = r->width * r->height;
+    memset(r->seen, 0, sizeof(bool) * fields);
+
+    uint32_t areas = 0;
+    for(uint32_t start = 0; start < fields; start++) {
+        if(r->owners[start] != player || r->seen[start]) {
+            continue;
+        }
+        areas++;
+        uint32_t head = 0, tail = 0;
+        r->queue[tail++] = start;
+        r->seen[start] = true;
+        while(head < tail) {
+            uint32_t neighbours[4];
+            int n = Neighbours(r, r->queue[head++], neighbours);
+            for(int k = 0; k < n; k++) {
+                uint32_t j = neighbours[k];
+                if(r->owners[j] == player && !r->seen[j]) {
+                    r->seen[j] = true;
+                    r->queue[tail++] = j;
+                }
+            }
+        }
+    }
+    return areas;
+}
+
+/** @brief Sprawdza, czy gracz i pole są poprawne.
+ * @param[in] r       – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Wartość @p true, jeśli gracz istnieje, a pole leży na planszy.
+ */
+static bool Valid(const reference_gamma *r, uint32_t player, uint32_t x,
+                  uint32_t y) {
+    return r != NULL && player >= 1 && player <= r->players
+           && x < r->width && y < r->height;
+}
+
+bool ReferenceMove(reference_gamma *r, uint32_t player, uint32_t x,
+                   uint32_t y) {
+    if(!Valid(r, player, x, y)) {
+        return false;
+    }
+    uint32_t i = y * r->width + x;
+    if(r->owners[i] != 0) {
+        return false;
+    }
+    r->owners[i] = player;
+    if(ReferenceAreas(r, player) > r->areas) {
+        r->owners[i] = 0;
+        return false;
+    }
+    return true;
+}
+
+/** @brief Sprawdza złoty ruch i wykonuje go, jeśli @p commit jest równe
+ * @p true.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza,
+ * @param[in] commit  – czy wykonać poprawny ruch.
+ * @return Wartość @p true, jeśli ruch jest poprawny.
+ */
+static bool TryGoldenMove(reference_gamma *r, uint32_t player, uint32_t x,
+                          uint32_t y, bool commit) {
+    if(!Valid(r, player, x, y) || r->golden_used[player]) {
+        return false;
+    }
+    uint32_t i = y * r->width + x;
+    uint32_t previous = r->owners[i];
+    if(previous == 0 || previous == player) {
+        return false;
+    }
+    r->owners[i] = player;
+    bool legal = ReferenceAreas(r, player) <= r->areas
+                 && ReferenceAreas(r, previous) <= r->areas;
+    if(!legal || !commit) {
+        r->owners[i] = previous;
+    } else {
+        r->golden_used[player] = true;
+    }
+    return legal;
+}
+
+bool ReferenceGoldenMove(reference_gamma *r, uint32_t player, uint32_t x,
+                         uint32_t y) {
+    return TryGoldenMove(r, player, x, y, true);
+}
+
+uint64_t ReferenceBusyFields(reference_gamma *r, uint32_t player) {
+    if(r == NULL || player == 0 || player > r->players) {
+        return 0;
+    }
+    uint64_t busy = 0;
+    for(uint32_t i = 0; i < r->width * r->height; i++) {
+        busy += r->owners[i] == player;
+    }
+    return busy;
+}
+
+uint64_t ReferenceFreeFields(reference_gamma *r, uint32_t player) {
+    if(r == NULL || player == 0 || player > r->players) {
+        return 0;
+    }
+    bool anywhere = ReferenceAreas(r, player) < r->areas;
+    uint64_t free_fields = 0;
+    for(uint32_t i = 0; i < r->width * r->height; i++) {
+        free_fields += r->owners[i] == 0 && (anywhere
+                                             || Touches(r, i, player));
+    }
+    return free_fields;
+}
+
+bool ReferenceGoldenPossible(reference_gamma *r, uint32_t player) {
+    if(r == NULL || player == 0 || player > r->players) {
+        return false;
+    }
+    for(uint32_t y = 0; y < r->height; y++) {
+        for(uint32_t x = 0; x < r->width; x++) {
+            if(TryGoldenMove(r, player, x, y, false)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+char* ReferenceBoard(reference_gamma *r) {
+    if(r == NULL) {
+        return NULL;
+    }
+    // najdłuższy opis pola to 10 cyfr otoczonych znakami '|'
+    size_t capacity = (size_t)r->width * r->height * 12 + r->height + 1;
+    char *board = malloc(capacity);
+    if(board == NULL) {
+        return NULL;
+    }
+
+    size_t length = 0;
+    for(uint32_t y = r->height; y-- > 0;) {
+        for(uint32_t x = 0; x < r->width; x++) {
+            uint32_t player = r->owners[y * r->width + x];
+            if(player == 0) {
+                board[length++] = '.';
+            } else {
+                length += sprintf(board + length,
+                                  player < 1000000000 ? "%u" : "|%u|",
+                                  player);
+            }
+        }
+        board[length++] = '\n';
+    }
+    board[length] = '\0';
+    return board;
+}
@@ -0,0 +1,109 @@
+/** @file
+ * Interfejs wzorcowego silnika gry gamma
+ *
+ * Wzorcowy silnik przechowuje tylko właścicieli pól i po każdej zmianie
+ * wyznacza obszary graczy od nowa, przechodząc planszę wszerz. Jest wolny,
+ * ale nie ma liczników aktualizowanych przyrostowo, więc służy do
+ * sprawdzania wyników właściwego silnika.
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef REFERENCEGAMMA_H
+#define REFERENCEGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Stan gry we wzorcowym silniku.
+ */
+typedef struct reference_gamma {
+    uint32_t width;       /**< szerokość planszy */
+    uint32_t height;      /**< wysokość planszy */
+    uint32_t players;     /**< liczba graczy */
+    uint32_t areas;       /**< maksymalna liczba obszarów gracza */
+    uint32_t *owners;     /**< numery graczy zajmujących pola, 0 dla
+                            *  wolnego pola; pole (x, y) ma indeks
+                            *  y * width + x */
+    bool *golden_used;    /**< czy gracz wykonał już złoty ruch, indeksowane
+                            *  numerem gracza */
+    bool *seen;           /**< znaczniki odwiedzenia przy liczeniu obszarów */
+    uint32_t *queue;      /**< kolejka pól przy liczeniu obszarów */
+} reference_gamma;
+
+/** @brief Tworzy stan gry o takich samych parametrach jak @ref gamma_new.
+ * @param[in] width   – szerokość planszy, liczba dodatnia,
+ * @param[in] height  – wysokość planszy, liczba dodatnia,
+ * @param[in] players – liczba graczy, liczba dodatnia,
+ * @param[in] areas   – maksymalna liczba obszarów, liczba dodatnia.
+ * @return Wskaźnik na stan gry lub NULL, gdy parametry są niepoprawne lub
+ * nie udało się zaalokować pamięci.
+ */
+reference_gamma* ReferenceNew(uint32_t width, uint32_t height,
+                              uint32_t players, uint32_t areas);
+
+/** @brief Usuwa stan gry.
+ * @param[in] r       – wskaźnik na stan gry lub NULL.
+ */
+void ReferenceDelete(reference_gamma *r);
+
+/** @brief Wykonuje ruch tak jak @ref gamma_move.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany.
+ */
+bool ReferenceMove(reference_gamma *r, uint32_t player, uint32_t x,
+                   uint32_t y);
+
+/** @brief Wykonuje złoty ruch tak jak @ref gamma_golden_move.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza,
+ * @param[in] x       – numer kolumny,
+ * @param[in] y       – numer wiersza.
+ * @return Wartość @p true, jeśli ruch został wykonany.
+ */
+bool ReferenceGoldenMove(reference_gamma *r, uint32_t player, uint32_t x,
+                         uint32_t y);
+
+/** @brief Liczy obszary gracza, przechodząc całą planszę.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia.
+ * @return Liczba obszarów gracza @p player.
+ */
+uint32_t ReferenceAreas(reference_gamma *r, uint32_t player);
+
+/** @brief Podaje liczbę pól zajętych przez gracza, tak jak
+ * @ref gamma_busy_fields.
+ * @param[in] r       – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól lub 0, gdy numer gracza jest niepoprawny.
+ */
+uint64_t ReferenceBusyFields(reference_gamma *r, uint32_t player);
+
+/** @brief Podaje liczbę pól, które gracz może zająć w jednym ruchu, tak
+ * jak @ref gamma_free_fields.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Liczba pól lub 0, gdy numer gracza jest niepoprawny.
+ */
+uint64_t ReferenceFreeFields(reference_gamma *r, uint32_t player);
+
+/** @brief Sprawdza, czy gracz może wykonać złoty ruch, tak jak
+ * @ref gamma_golden_possible, próbując go na każdym polu.
+ * @param[in,out] r   – wskaźnik na stan gry,
+ * @param[in] player  – numer gracza.
+ * @return Wartość @p true, jeśli złoty ruch jest możliwy.
+ */
+bool ReferenceGoldenPossible(reference_gamma *r, uint32_t player);
+
+/** @brief Tworzy napis opisujący planszę w formacie @ref gamma_board.
+ * @param[in] r       – wskaźnik na stan gry.
+ * @return Wskaźnik na zaalokowany napis lub NULL, gdy nie udało się
+ * zaalokować pamięci.
+ */
+char* ReferenceBoard(reference_gamma *r);
+
+#endif /* REFERENCEGAMMA_H */
@@ -0,0 +1,261 @@
+/** @file
+ * Implementacja zapisywania i wczytywania stanu gry
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "gamma.h"
+#include "tiles_gamma.h"
+
+/** @brief Napis rozpoczynający plik z zapisanym stanem gry. */
+#define SAVE_MAGIC "GAMMASAV"
+/** @brief Wersja formatu pliku. */
+#define SAVE_VERSION 2
+/** @brief Liczba zapisywana w pliku do sprawdzenia kolejności bajtów. */
+#define SAVE_BYTE_ORDER 0x01020304u
+/** @brief Wyrównanie pierwszego kafelka w pliku, równe rozmiarowi strony
+ * pamięci na typowych systemach. */
+#define SAVE_ALIGNMENT 4096
+
+/**
+ * @brief Nagłówek pliku z zapisanym stanem gry.
+ * Po nim zapisane są stany graczy, a od pozycji @p tiles_offset kafelki
+ * planszy w takim układzie, w jakim leżą w pamięci.
+ */
+typedef struct save_header {
+    char magic[8];          /**< napis @ref SAVE_MAGIC */
+    uint32_t version;       /**< wersja formatu */
+    uint32_t byte_order;    /**< liczba @ref SAVE_BYTE_ORDER */
+    uint32_t tile_bits;     /**< wartość @ref TILE_BITS */
+    uint32_t element_size;  /**< rozmiar struktury @ref board_element */
+    uint32_t tile_header;   /**< położenie tablicy właścicieli w strukturze
+                              *  @ref board_tile */
+    uint32_t width;         /**< szerokość planszy */
+    uint32_t height;        /**< wysokość planszy */
+    uint32_t players;       /**< liczba graczy */
+    uint32_t areas;         /**< maksymalna liczba obszarów */
+    uint32_t owner_bytes;   /**< liczba bajtów numeru gracza w tablicy
+                              *  właścicieli kafelka */
+    uint64_t free_fields_under_max_areas; /**< wartość pola gry o tej
+                                            *  samej nazwie */
+    uint64_t tiles_offset;  /**< położenie pierwszego kafelka w pliku */
+    uint64_t file_size;     /**< rozmiar całego pliku */
+} save_header;
+
+/**
+ * @brief Zapisany stan jednego gracza, niezależny od wyrównania
+ * struktury @ref one_player.
+ */
+typedef struct saved_player {
+    uint64_t busy_fields;          /**< ilość pól zajmowanych przez gracza */
+    uint64_t adjacent_free_fields; /**< ilość wolnych pól sąsiadujących
+                                     *  z polami gracza */
+    uint32_t number_of_areas;      /**< aktualna liczba obszarów */
+    uint32_t gold_possible;        /**< czy gracz może wykonać złoty ruch */
+} saved_player;
+
+/** @brief Wypełnia nagłówek pliku dla gry @p g.
+ * @param[in] g        – wskaźnik na strukturę przechowującą stan gry,
+ * @param[out] header  – wypełniany nagłówek.
+ */
+static void FillHeader(const gamma_t *g, save_header *header) {
+    uint64_t players_end = sizeof(save_header)
+                           + sizeof(saved_player) * g->number_of_players;
+
+    memset(header, 0, sizeof(save_header));
+    memcpy(header->magic, SAVE_MAGIC, sizeof(header->magic));
+    header->version = SAVE_VERSION;
+    header->byte_order = SAVE_BYTE_ORDER;
+    header->tile_bits = TILE_BITS;
+    header->element_size = sizeof(board_element);
+    header->tile_header = offsetof(board_tile, owners);
+    header->width = g->width;
+    header->height = g->height;
+    header->players = g->number_of_players;
+    header->areas = g->max_areas;
+    header->owner_bytes = g->owner_bytes;
+    header->free_fields_under_max_areas = g->free_fields_under_max_areas;
+    header->tiles_offset = (players_end + SAVE_ALIGNMENT - 1)
+                           / SAVE_ALIGNMENT * SAVE_ALIGNMENT;
+    header->file_size = header->tiles_offset + BoardBytes(g);
+}
+
+/** @brief Zapisuje stan gry do otwartego pliku.
+ * @param[in] g       – wskaźnik na strukturę przechowującą stan gry,
+ * @param[in] file    – plik otwarty do zapisu.
+ * @return Wartość @p true, jeśli udało się zapisać cały stan.
+ */
+static bool WriteGame(const gamma_t *g, FILE *file) {
+    save_header header;
+    FillHeader(g, &header);
+    if(fwrite(&header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+
+    for(uint32_t p = 0; p < g->number_of_players; p++) {
+        saved_player player = {
+            .busy_fields = g->players[p].busy_fields,
+            .adjacent_free_fields = g->players[p].adjacent_free_fields,
+            .number_of_areas = g->players[p].number_of_areas,
+            .gold_possible = g->players[p].gold_possible
+        };
+        if(fwrite(&player, sizeof(player), 1, file) != 1) {
+            return false;
+        }
+    }
+
+    static const char zeros[SAVE_ALIGNMENT];
+    long position = ftell(file);
+    if(position < 0 || fwrite(zeros, 1, header.tiles_offset - position, file)
+                       != header.tiles_offset - position) {
+        return false;
+    }
+
+    // liczniki użyć wczytanych kafelków są trzymane poza plikiem,
+    // a zapisany nagłówek kafelka tylko zachowuje układ pamięci
+    board_tile tile_header;
+    atomic_init(&tile_header.references, 1);
+    size_t body = TileBytes(g) - offsetof(board_tile, owners);
+    for(uint32_t t = 0; t < g->tiles_count; t++) {
+        if(fwrite(&tile_header, offsetof(board_tile, owners), 1, file) != 1
+           || fwrite(g->tiles[t]->owners, 1, body, file) != body) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool gamma_save(gamma_t *g, const char *path) {
+    if(g == NULL || path == NULL) {
+        return false;
+    }
+
+    // piszemy do pliku tymczasowego i podmieniamy go, aby nie zmieniać
+    // pliku, który może być odwzorowany w pamięci przez wczytaną grę
+    size_t length = strlen(path);
+    char *temporary = malloc(length + sizeof(".tmp"));
+    if(temporary == NULL) {
+        return false;
+    }
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+
+    FILE *file = fopen(temporary, "wb");
+    if(file == NULL) {
+        free(temporary);
+        return false;
+    }
+    bool written = WriteGame(g, file);
+    written = fclose(file) == 0 && written;
+    written = written && rename(temporary, path) == 0;
+    if(!written) {
+        remove(temporary);
+    }
+    free(temporary);
+    return written;
+}
+
+/** @brief Sprawdza czy nagłówek opisuje plik zapisany przez
+ * @ref gamma_save w tej samej wersji i na takiej samej architekturze.
+ * @param[in] header  – nagłówek wczytywanego pliku,
+ * @param[in] size    – rozmiar wczytywanego pliku.
+ * @return Wartość @p true, jeśli plik można wczytać.
+ */
+static bool ValidHeader(const save_header *header, uint64_t size) {
+    if(memcmp(header->magic, SAVE_MAGIC, sizeof(header->magic)) != 0
+       || header->version != SAVE_VERSION
+       || header->byte_order != SAVE_BYTE_ORDER
+       || header->tile_bits != TILE_BITS
+       || header->element_size != sizeof(board_element)
+       || header->tile_header != offsetof(board_tile, owners)) {
+        return false;
+    }
+    if(header->width == 0 || header->height == 0 || header->players == 0
+       || header->areas == 0
+       || (uint64_t)header->width * header->height > UINT32_MAX) {
+        return false;
+    }
+
+    gamma_t shape = {.width = header->width, .height = header->height,
+                     .number_of_players = header->players};
+    BoardShape(&shape);
+    save_header expected;
+    FillHeader(&shape, &expected);
+    return header->owner_bytes == expected.owner_bytes
+           && header->tiles_offset == expected.tiles_offset
+           && header->file_size == expected.file_size
+           && header->file_size == size;
+}
+
+gamma_t* gamma_load(const char *path) {
+    if(path == NULL) {
+        return NULL;
+    }
+
+    int descriptor = open(path, O_RDONLY);
+    if(descriptor < 0) {
+        return NULL;
+    }
+    struct stat status;
+    if(fstat(descriptor, &status) != 0
+       || (uint64_t)status.st_size < sizeof(save_header)) {
+        close(descriptor);
+        return NULL;
+    }
+    size_t length = status.st_size;
+    // prywatne odwzorowanie: zmiany wczytanej gry nie trafiają do pliku,
+    // a plansza nie jest kopiowana ani czytana - strony kafelków są
+    // wczytywane dopiero przy pierwszym użyciu pól
+    void *address = mmap(NULL, length, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                         descriptor, 0);
+    close(descriptor);
+    if(address == MAP_FAILED) {
+        return NULL;
+    }
+
+    const save_header *header = address;
+    gamma_t *g = NULL;
+    if(ValidHeader(header, length)) {
+        g = calloc(1, sizeof(gamma_t));
+    }
+    if(g == NULL) {
+        munmap(address, length);
+        return NULL;
+    }
+
+    g->width = header->width;
+    g->height = header->height;
+    g->number_of_players = header->players;
+    g->max_areas = header->areas;
+    g->free_fields_under_max_areas = header->free_fields_under_max_areas;
+    g->query_threads = 1;
+    g->players = malloc(sizeof(one_player) * g->number_of_players);
+    if(g->players == NULL
+       || !MapBoard(g, address, length, header->tiles_offset)) {
+        munmap(address, length);
+        free(g->players);
+        free(g);
+        return NULL;
+    }
+
+    const saved_player *saved =
+            (const saved_player *)((const char *)address + sizeof(save_header));
+    for(uint32_t p = 0; p < g->number_of_players; p++) {
+        g->players[p].busy_fields = saved[p].busy_fields;
+        g->players[p].adjacent_free_fields = saved[p].adjacent_free_fields;
+        g->players[p].number_of_areas = saved[p].number_of_areas;
+        g->players[p].gold_possible = saved[p].gold_possible != 0;
+    }
+    return g;
+}
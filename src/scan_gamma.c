@@ -0,0 +1,468 @@
+/** @file
+ * Implementacja przeglądania planszy całymi wierszami
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include "scan_gamma.h"
+#include "gamma_structures.h"
+#include "arena_gamma.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+/** @brief Czy dostępne są wersje funkcji używające instrukcji SSE2
+ * i AVX2. */
+#define SCAN_X86
+#include <immintrin.h>
+#endif
+
+/** @brief Wyznacza maski kolejnych słów wiersza.
+ * @param[in] above     – kopia wiersza nad przeglądanym wierszem,
+ * @param[in] row       – kopia przeglądanego wiersza,
+ * @param[in] below     – kopia wiersza pod przeglądanym wierszem,
+ * @param[in] words     – liczba słów maski,
+ * @param[in] code      – bajt oznaczający pole gracza,
+ * @param[out] adjacent – maska pól sąsiadujących z polem gracza,
+ * @param[out] empty    – maska wolnych pól,
+ * @param[out] other    – maska pól innych graczy.
+ */
+typedef void row_kernel(const uint8_t *above, const uint8_t *row,
+                        const uint8_t *below, uint32_t words, uint8_t code,
+                        uint64_t *adjacent, uint64_t *empty, uint64_t *other);
+
+/** @brief Wpisuje opisy pól o jednocyfrowych numerach graczy.
+ * @param[in] owners  – jednobajtowe numery graczy zajmujących pola,
+ * @param[in] count   – liczba pól,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+typedef void render_kernel(const unsigned char *owners, uint32_t count,
+                           char *out);
+
+/**
+ * @brief Wersje funkcji przeglądających planszę dla jednego zestawu
+ * instrukcji.
+ */
+typedef struct scan_kernels {
+    row_kernel *rows;        /**< wyznaczanie masek wiersza */
+    render_kernel *render;   /**< wypisywanie pól */
+} scan_kernels;
+
+/** @brief Wyznacza maski kolejnych słów wiersza pole po polu.
+ * @param[in] above     – kopia wiersza nad przeglądanym wierszem,
+ * @param[in] row       – kopia przeglądanego wiersza,
+ * @param[in] below     – kopia wiersza pod przeglądanym wierszem,
+ * @param[in] words     – liczba słów maski,
+ * @param[in] code      – bajt oznaczający pole gracza,
+ * @param[out] adjacent – maska pól sąsiadujących z polem gracza,
+ * @param[out] empty    – maska wolnych pól,
+ * @param[out] other    – maska pól innych graczy.
+ */
+static void RowMasksScalar(const uint8_t *above, const uint8_t *row,
+                           const uint8_t *below, uint32_t words, uint8_t code,
+                           uint64_t *adjacent, uint64_t *empty,
+                           uint64_t *other) {
+    for(uint32_t w = 0; w < words; w++) {
+        uint64_t near = 0, free_fields = 0, others = 0;
+
+        for(uint32_t b = 0; b < SCAN_WORD_BITS; b++) {
+            size_t k = (size_t)w * SCAN_WORD_BITS + b;
+            uint64_t bit = (uint64_t)1 << b;
+            if(row[k - 1] == code || row[k + 1] == code
+               || above[k] == code || below[k] == code) {
+                near |= bit;
+            }
+            if(row[k] == 0) {
+                free_fields |= bit;
+            } else if(row[k] != code) {
+                others |= bit;
+            }
+        }
+        adjacent[w] = near;
+        empty[w] = free_fields;
+        other[w] = others;
+    }
+}
+
+/** @brief Wpisuje opisy pól o jednocyfrowych numerach graczy pole po polu.
+ * @param[in] owners  – jednobajtowe numery graczy zajmujących pola,
+ * @param[in] count   – liczba pól,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+static void RenderScalar(const unsigned char *owners, uint32_t count,
+                         char *out) {
+    for(uint32_t k = 0; k < count; k++) {
+        out[k] = owners[k] == 0 ? '.' : (char)('0' + owners[k]);
+    }
+}
+
+#ifdef SCAN_X86
+
+/** @brief Wyznacza maski kolejnych słów wiersza po 16 pól naraz.
+ * @param[in] above     – kopia wiersza nad przeglądanym wierszem,
+ * @param[in] row       – kopia przeglądanego wiersza,
+ * @param[in] below     – kopia wiersza pod przeglądanym wierszem,
+ * @param[in] words     – liczba słów maski,
+ * @param[in] code      – bajt oznaczający pole gracza,
+ * @param[out] adjacent – maska pól sąsiadujących z polem gracza,
+ * @param[out] empty    – maska wolnych pól,
+ * @param[out] other    – maska pól innych graczy.
+ */
+__attribute__((target("sse2")))
+static void RowMasksSse2(const uint8_t *above, const uint8_t *row,
+                         const uint8_t *below, uint32_t words, uint8_t code,
+                         uint64_t *adjacent, uint64_t *empty,
+                         uint64_t *other) {
+    const __m128i player = _mm_set1_epi8((char)code);
+    const __m128i zero = _mm_setzero_si128();
+
+    for(uint32_t w = 0; w < words; w++) {
+        uint64_t near = 0, free_fields = 0, others = 0;
+
+        for(uint32_t part = 0; part < SCAN_WORD_BITS; part += 16) {
+            size_t k = (size_t)w * SCAN_WORD_BITS + part;
+            __m128i field = _mm_loadu_si128((const __m128i *)(row + k));
+            __m128i left = _mm_loadu_si128((const __m128i *)(row + k - 1));
+            __m128i right = _mm_loadu_si128((const __m128i *)(row + k + 1));
+            __m128i up = _mm_loadu_si128((const __m128i *)(above + k));
+            __m128i down = _mm_loadu_si128((const __m128i *)(below + k));
+
+            __m128i mine = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(left, player),
+                                 _mm_cmpeq_epi8(right, player)),
+                    _mm_or_si128(_mm_cmpeq_epi8(up, player),
+                                 _mm_cmpeq_epi8(down, player)));
+            __m128i vacant = _mm_cmpeq_epi8(field, zero);
+            __m128i taken = _mm_or_si128(vacant,
+                                         _mm_cmpeq_epi8(field, player));
+
+            near |= (uint64_t)(uint16_t)_mm_movemask_epi8(mine) << part;
+            free_fields |= (uint64_t)(uint16_t)_mm_movemask_epi8(vacant)
+                           << part;
+            others |= (uint64_t)(uint16_t)~_mm_movemask_epi8(taken) << part;
+        }
+        adjacent[w] = near;
+        empty[w] = free_fields;
+        other[w] = others;
+    }
+}
+
+/** @brief Wpisuje opisy pól o jednocyfrowych numerach graczy po 16 pól
+ * naraz.
+ * @param[in] owners  – jednobajtowe numery graczy zajmujących pola,
+ * @param[in] count   – liczba pól,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+__attribute__((target("sse2")))
+static void RenderSse2(const unsigned char *owners, uint32_t count,
+                       char *out) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i dot = _mm_set1_epi8('.');
+    const __m128i digit = _mm_set1_epi8('0');
+    uint32_t k = 0;
+
+    for(; k + 16 <= count; k += 16) {
+        __m128i field = _mm_loadu_si128((const __m128i *)(owners + k));
+        __m128i vacant = _mm_cmpeq_epi8(field, zero);
+        __m128i text = _mm_or_si128(
+                _mm_and_si128(vacant, dot),
+                _mm_andnot_si128(vacant, _mm_add_epi8(field, digit)));
+        _mm_storeu_si128((__m128i *)(out + k), text);
+    }
+    RenderScalar(owners + k, count - k, out + k);
+}
+
+/** @brief Wyznacza maski kolejnych słów wiersza po 32 pola naraz.
+ * @param[in] above     – kopia wiersza nad przeglądanym wierszem,
+ * @param[in] row       – kopia przeglądanego wiersza,
+ * @param[in] below     – kopia wiersza pod przeglądanym wierszem,
+ * @param[in] words     – liczba słów maski,
+ * @param[in] code      – bajt oznaczający pole gracza,
+ * @param[out] adjacent – maska pól sąsiadujących z polem gracza,
+ * @param[out] empty    – maska wolnych pól,
+ * @param[out] other    – maska pól innych graczy.
+ */
+__attribute__((target("avx2")))
+static void RowMasksAvx2(const uint8_t *above, const uint8_t *row,
+                         const uint8_t *below, uint32_t words, uint8_t code,
+                         uint64_t *adjacent, uint64_t *empty,
+                         uint64_t *other) {
+    const __m256i player = _mm256_set1_epi8((char)code);
+    const __m256i zero = _mm256_setzero_si256();
+
+    for(uint32_t w = 0; w < words; w++) {
+        uint64_t near = 0, free_fields = 0, others = 0;
+
+        for(uint32_t part = 0; part < SCAN_WORD_BITS; part += 32) {
+            size_t k = (size_t)w * SCAN_WORD_BITS + part;
+            __m256i field = _mm256_loadu_si256((const __m256i *)(row + k));
+            __m256i left = _mm256_loadu_si256((const __m256i *)(row + k - 1));
+            __m256i right = _mm256_loadu_si256((const __m256i *)(row + k + 1));
+            __m256i up = _mm256_loadu_si256((const __m256i *)(above + k));
+            __m256i down = _mm256_loadu_si256((const __m256i *)(below + k));
+
+            __m256i mine = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(left, player),
+                                    _mm256_cmpeq_epi8(right, player)),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(up, player),
+                                    _mm256_cmpeq_epi8(down, player)));
+            __m256i vacant = _mm256_cmpeq_epi8(field, zero);
+            __m256i taken = _mm256_or_si256(vacant,
+                                            _mm256_cmpeq_epi8(field, player));
+
+            near |= (uint64_t)(uint32_t)_mm256_movemask_epi8(mine) << part;
+            free_fields |= (uint64_t)(uint32_t)_mm256_movemask_epi8(vacant)
+                           << part;
+            others |= (uint64_t)(uint32_t)~_mm256_movemask_epi8(taken)
+                      << part;
+        }
+        adjacent[w] = near;
+        empty[w] = free_fields;
+        other[w] = others;
+    }
+}
+
+/** @brief Wpisuje opisy pól o jednocyfrowych numerach graczy po 32 pola
+ * naraz.
+ * @param[in] owners  – jednobajtowe numery graczy zajmujących pola,
+ * @param[in] count   – liczba pól,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+__attribute__((target("avx2")))
+static void RenderAvx2(const unsigned char *owners, uint32_t count,
+                       char *out) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i dot = _mm256_set1_epi8('.');
+    const __m256i digit = _mm256_set1_epi8('0');
+    uint32_t k = 0;
+
+    for(; k + 32 <= count; k += 32) {
+        __m256i field = _mm256_loadu_si256((const __m256i *)(owners + k));
+        __m256i vacant = _mm256_cmpeq_epi8(field, zero);
+        __m256i text = _mm256_or_si256(
+                _mm256_and_si256(vacant, dot),
+                _mm256_andnot_si256(vacant, _mm256_add_epi8(field, digit)));
+        _mm256_storeu_si256((__m256i *)(out + k), text);
+    }
+    RenderScalar(owners + k, count - k, out + k);
+}
+
+#endif /* SCAN_X86 */
+
+/** @brief Wersje funkcji dla kolejnych zestawów instrukcji; brakujące
+ * zestawy nie są obsługiwane na tej architekturze. */
+static const scan_kernels kernels[] = {
+    [SCAN_SCALAR] = {RowMasksScalar, RenderScalar},
+#ifdef SCAN_X86
+    [SCAN_SSE2] = {RowMasksSse2, RenderSse2},
+    [SCAN_AVX2] = {RowMasksAvx2, RenderAvx2},
+#else
+    [SCAN_SSE2] = {NULL, NULL},
+    [SCAN_AVX2] = {NULL, NULL},
+#endif
+};
+
+/** @brief Używany zestaw instrukcji, -1 dopóki nie został wybrany. */
+static atomic_int selected_level = -1;
+
+/** @brief Sprawdza czy procesor obsługuje zestaw instrukcji @p level.
+ * @param[in] level   – zestaw instrukcji.
+ * @return Wartość @p true, jeśli zestaw jest obsługiwany.
+ */
+static bool Supported(scan_level level) {
+    if(level == SCAN_SCALAR) {
+        return true;
+    }
+#ifdef SCAN_X86
+    __builtin_cpu_init();
+    if(level == SCAN_SSE2) {
+        return __builtin_cpu_supports("sse2");
+    }
+    if(level == SCAN_AVX2) {
+        return __builtin_cpu_supports("avx2");
+    }
+#endif
+    return false;
+}
+
+scan_level ScanLevel(void) {
+    int level = atomic_load_explicit(&selected_level, memory_order_relaxed);
+    if(level < 0) {
+        level = Supported(SCAN_AVX2) ? SCAN_AVX2
+                : Supported(SCAN_SSE2) ? SCAN_SSE2 : SCAN_SCALAR;
+        // kilka wątków może wybierać naraz, ale wybiorą to samo
+        atomic_store_explicit(&selected_level, level, memory_order_relaxed);
+    }
+    return (scan_level)level;
+}
+
+bool SetScanLevel(scan_level level) {
+    if(!Supported(level)) {
+        return false;
+    }
+    atomic_store_explicit(&selected_level, level, memory_order_relaxed);
+    return true;
+}
+
+/** @brief Podaje wersje funkcji dla używanego zestawu instrukcji.
+ * @return Wskaźnik na wersje funkcji.
+ */
+static const scan_kernels *Kernels(void) {
+    return &kernels[ScanLevel()];
+}
+
+/** @brief Kopiuje do @p out wiersz planszy o wielobajtowych numerach
+ * graczy, zamieniając numery na bajty: 0 dla wolnego pola, 1 dla pola
+ * gracza @p player i 2 dla pól pozostałych graczy.
+ * @param[in] owners  – numery graczy zajmujących kolejne pola,
+ * @param[in] count   – liczba pól,
+ * @param[in] player  – numer gracza,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+static void ClassifyWide16(const uint16_t *owners, uint32_t count,
+                           uint32_t player, uint8_t *out) {
+    for(uint32_t k = 0; k < count; k++) {
+        out[k] = owners[k] == 0 ? 0 : owners[k] == player ? 1 : 2;
+    }
+}
+
+/** @brief Kopiuje do @p out wiersz planszy o czterobajtowych numerach
+ * graczy, zamieniając numery tak jak @ref ClassifyWide16.
+ * @param[in] owners  – numery graczy zajmujących kolejne pola,
+ * @param[in] count   – liczba pól,
+ * @param[in] player  – numer gracza,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+static void ClassifyWide32(const uint32_t *owners, uint32_t count,
+                           uint32_t player, uint8_t *out) {
+    for(uint32_t k = 0; k < count; k++) {
+        out[k] = owners[k] == 0 ? 0 : owners[k] == player ? 1 : 2;
+    }
+}
+
+/** @brief Kopiuje wiersz @p y planszy do bufora @p out.
+ * Wiersz może leżeć w kilku kafelkach.
+ * @param[in] scan    – stan przeglądania,
+ * @param[in] y       – numer wiersza,
+ * @param[out] out    – bufor o rozmiarze co najmniej szerokości planszy.
+ */
+static void LoadRow(const row_scan *scan, uint32_t y, uint8_t *out) {
+    const gamma_t *g = scan->g;
+    uint32_t i = BoardIndex(g,0,y);
+
+    for(uint32_t x = 0; x < g->width;) {
+        uint32_t k = i & (TILE_FIELDS - 1);
+        uint32_t run = g->width - x < TILE_FIELDS - k ? g->width - x
+                                                      : TILE_FIELDS - k;
+        const unsigned char *owners = g->tiles[i >> TILE_BITS]->owners;
+
+        if(g->owner_bytes == 1) {
+            memcpy(out + x, owners + k, run);
+        } else if(g->owner_bytes == 2) {
+            ClassifyWide16((const uint16_t *)owners + k, run, scan->player,
+                           out + x);
+        } else {
+            ClassifyWide32((const uint32_t *)owners + k, run, scan->player,
+                           out + x);
+        }
+        x += run;
+        i += run;
+    }
+}
+
+bool BeginScan(row_scan *scan, const gamma_t *g, uint32_t player) {
+    if((uint64_t)g->width + 2 * SCAN_MARGIN + 7 > SIZE_MAX / 8) {
+        return false;
+    }
+    size_t stride = ((size_t)g->width + 2 * SCAN_MARGIN + 7) / 8 * 8;
+    scan->words = (g->width + SCAN_WORD_BITS - 1) / SCAN_WORD_BITS;
+
+    char *memory;
+    if(g->width <= SCAN_SMALL_WIDTH) {
+        memory = (char *)scan->small;
+        scan->memory = NULL;
+    } else {
+        memory = GammaAlloc(g->arena, 4 * stride
+                                      + 3 * sizeof(uint64_t) * scan->words);
+        if(memory == NULL) {
+            return false;
+        }
+        scan->memory = memory;
+    }
+
+    // marginesy i wiersz zer nie są później zmieniane
+    memset(memory, 0, 4 * stride);
+    for(int k = 0; k < 3; k++) {
+        scan->rows[k] = (uint8_t *)memory + k * stride + SCAN_MARGIN;
+    }
+    scan->zeros = (uint8_t *)memory + 3 * stride + SCAN_MARGIN;
+    scan->adjacent = (uint64_t *)(memory + 4 * stride);
+    scan->empty = scan->adjacent + scan->words;
+    scan->other = scan->empty + scan->words;
+
+    scan->g = g;
+    scan->player = player;
+    scan->code = g->owner_bytes == 1 ? (uint8_t)player : 1;
+    scan->loaded_from = 0;
+    scan->loaded_to = 0;
+    return true;
+}
+
+void ScanRow(row_scan *scan, uint32_t y) {
+    const gamma_t *g = scan->g;
+    uint32_t from = y > 0 ? y - 1 : 0;
+    uint32_t to = (uint64_t)y + 2 < g->height ? y + 2 : g->height;
+
+    for(uint32_t r = from; r < to; r++) {
+        if(r < scan->loaded_from || r >= scan->loaded_to) {
+            LoadRow(scan,r,scan->rows[r % 3]);
+        }
+    }
+    scan->loaded_from = from;
+    scan->loaded_to = to;
+
+    const uint8_t *above = y > 0 ? scan->rows[(y - 1) % 3] : scan->zeros;
+    const uint8_t *below = y + 1 < g->height ? scan->rows[(y + 1) % 3]
+                                             : scan->zeros;
+    Kernels()->rows(above,scan->rows[y % 3],below,scan->words,scan->code,
+                    scan->adjacent,scan->empty,scan->other);
+
+    // bajty za końcem wiersza są zerami, więc ich bity trzeba wyczyścić
+    uint32_t tail = g->width % SCAN_WORD_BITS;
+    if(tail != 0) {
+        uint64_t mask = ((uint64_t)1 << tail) - 1;
+        scan->adjacent[scan->words - 1] &= mask;
+        scan->empty[scan->words - 1] &= mask;
+        scan->other[scan->words - 1] &= mask;
+    }
+}
+
+void EndScan(row_scan *scan) {
+    if(scan->memory != NULL) {
+        GammaFree(scan->g->arena, scan->memory);
+        scan->memory = NULL;
+    }
+}
+
+uint64_t CountAdjacentFree(const gamma_t *g, uint32_t player) {
+    row_scan scan;
+    if(!BeginScan(&scan,g,player)) {
+        return UINT64_MAX;
+    }
+
+    uint64_t count = 0;
+    for(uint32_t y = 0; y < g->height; y++) {
+        ScanRow(&scan,y);
+        for(uint32_t w = 0; w < scan.words; w++) {
+            count += __builtin_popcountll(scan.empty[w] & scan.adjacent[w]);
+        }
+    }
+    EndScan(&scan);
+    return count;
+}
+
+void RenderDigits(const unsigned char *owners, uint32_t count, char *out) {
+    Kernels()->render(owners,count,out);
+}
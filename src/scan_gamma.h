@@ -0,0 +1,119 @@
+/** @file
+ * Interfejs przeglądania planszy całymi wierszami
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef SCANGAMMA_H
+#define SCANGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "gamma_structures.h"
+
+/** @brief Liczba pól opisywanych przez jedno słowo maski wiersza. */
+#define SCAN_WORD_BITS 64
+/** @brief Liczba zerowych bajtów przed i za kopią wiersza, pozwalająca
+ * czytać sąsiadów pól brzegowych i całe słowa maski bez sprawdzania
+ * granic. */
+#define SCAN_MARGIN 64
+/** @brief Największa szerokość planszy, dla której bufory przeglądania
+ * mieszczą się w strukturze @ref row_scan. */
+#define SCAN_SMALL_WIDTH 512
+
+/**
+ * @brief Zestaw instrukcji używany przez funkcje przeglądające planszę.
+ */
+typedef enum scan_level {
+    SCAN_SCALAR,   /**< zwykły kod, dostępny zawsze */
+    SCAN_SSE2,     /**< instrukcje SSE2, po 16 pól naraz */
+    SCAN_AVX2      /**< instrukcje AVX2, po 32 pola naraz */
+} scan_level;
+
+/**
+ * @brief Stan przeglądania planszy wierszami z punktu widzenia jednego
+ * gracza. Wiersze kopiowane są do buforów jako bajty: 0 dla wolnego pola,
+ * @p code dla pola gracza i inna wartość dla pól pozostałych graczy.
+ * Trzy kolejne wiersze leżą w buforach o numerach równych ich numerom
+ * modulo 3.
+ */
+typedef struct row_scan {
+    const gamma_t *g;         /**< przeglądana gra */
+    uint8_t code;             /**< bajt oznaczający pole gracza */
+    uint32_t player;          /**< numer gracza */
+    uint32_t words;           /**< liczba słów maski jednego wiersza */
+    uint32_t loaded_from;     /**< pierwszy wiersz leżący w buforach */
+    uint32_t loaded_to;       /**< wiersz za ostatnim wierszem w buforach */
+    uint8_t *rows[3];         /**< kopie wierszy, każda z marginesami
+                                *  @ref SCAN_MARGIN */
+    uint8_t *zeros;           /**< wiersz zer zastępujący wiersze spoza
+                                *  planszy */
+    uint64_t *adjacent;       /**< maska pól sąsiadujących z polem gracza */
+    uint64_t *empty;          /**< maska wolnych pól */
+    uint64_t *other;          /**< maska pól innych graczy */
+    void *memory;             /**< zaalokowane bufory, NULL gdy leżą
+                                *  w @p small */
+    /** bufory dla plansz o szerokości niewiększej od
+     *  @ref SCAN_SMALL_WIDTH: cztery wiersze i trzy maski */
+    uint64_t small[(SCAN_SMALL_WIDTH + 2 * SCAN_MARGIN) / 2
+                   + 3 * SCAN_SMALL_WIDTH / SCAN_WORD_BITS];
+} row_scan;
+
+/** @brief Podaje zestaw instrukcji używany przez funkcje przeglądające
+ * planszę. Przy pierwszym wywołaniu wybierany jest najszybszy zestaw
+ * obsługiwany przez procesor.
+ * @return Używany zestaw instrukcji.
+ */
+scan_level ScanLevel(void);
+
+/** @brief Zmienia zestaw instrukcji używany przez funkcje przeglądające
+ * planszę, na przykład aby porównać ich wyniki i szybkość.
+ * @param[in] level   – zestaw instrukcji.
+ * @return Wartość @p true, jeśli procesor obsługuje zestaw @p level.
+ */
+bool SetScanLevel(scan_level level);
+
+/** @brief Przygotowuje przeglądanie planszy gry @p g z punktu widzenia
+ * gracza @p player.
+ * @param[out] scan   – stan przeglądania,
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od liczby
+ *                      graczy.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool BeginScan(row_scan *scan, const gamma_t *g, uint32_t player);
+
+/** @brief Wyznacza maski @p scan->adjacent, @p scan->empty
+ * i @p scan->other wiersza @p y; bit @p x % @ref SCAN_WORD_BITS słowa
+ * @p x / @ref SCAN_WORD_BITS opisuje pole (@p x, @p y). Bity za końcem
+ * wiersza są zerami. Kolejne wiersze najszybciej przeglądać po kolei.
+ * @param[in,out] scan – stan przeglądania,
+ * @param[in] y        – numer wiersza, liczba nieujemna mniejsza od
+ *                       wysokości planszy.
+ */
+void ScanRow(row_scan *scan, uint32_t y);
+
+/** @brief Kończy przeglądanie planszy i zwalnia jego bufory.
+ * @param[in,out] scan – stan przeglądania.
+ */
+void EndScan(row_scan *scan);
+
+/** @brief Zlicza wolne pola sąsiadujące z polami gracza @p player,
+ * przeglądając całą planszę.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] player  – numer gracza, liczba dodatnia niewiększa od liczby
+ *                      graczy.
+ * @return Liczba pól lub UINT64_MAX, gdy nie udało się zaalokować pamięci.
+ */
+uint64_t CountAdjacentFree(const gamma_t *g, uint32_t player);
+
+/** @brief Wpisuje do @p out opisy @p count kolejnych pól planszy, na
+ * której wszystkie numery graczy są jednocyfrowe: '.' dla wolnego pola
+ * i cyfrę gracza dla zajętego.
+ * @param[in] owners  – jednobajtowe numery graczy zajmujących pola,
+ * @param[in] count   – liczba pól,
+ * @param[out] out    – bufor o rozmiarze co najmniej @p count.
+ */
+void RenderDigits(const unsigned char *owners, uint32_t count, char *out);
+
+#endif /* SCANGAMMA_H */
@@ -0,0 +1,545 @@
+/** @file
+ * Implementacja trybu wielu gier prowadzonych w jednym procesie
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "gamma.h"
+#include "utilities.h"
+#include "batch_io.h"
+#include "session_mode.h"
+
+/** @brief Liczba komend, które mogą czekać na jeden wątek. */
+#define SESSION_QUEUE 4096
+
+/** @brief Liczba komend przekazywanych wątkowi naraz. */
+#define SESSION_BATCH 256
+
+/** @brief Początkowy rozmiar tablicy gier wątku, potęga dwójki. */
+#define SESSION_GAMES 16
+
+/** @brief Nazwa komendy oznaczająca niepoprawną linię. */
+#define COMMAND_ERROR '\0'
+
+/**
+ * @brief Komenda przekazywana wątkowi obsługującemu grę.
+ */
+typedef struct session_task {
+    int line_number;      /**< numer linii komendy */
+    uint32_t id;          /**< numer gry */
+    char name;            /**< nazwa komendy lub @ref COMMAND_ERROR */
+    uint32_t numbers[4];  /**< argumenty komendy */
+} session_task;
+
+/**
+ * @brief Kolejka komend czekających na wątek.
+ */
+typedef struct session_queue {
+    pthread_mutex_t mutex;               /**< blokada kolejki */
+    pthread_cond_t not_empty;            /**< sygnał nowych komend */
+    pthread_cond_t not_full;             /**< sygnał wolnego miejsca */
+    session_task tasks[SESSION_QUEUE];   /**< bufor cykliczny komend */
+    size_t head;                         /**< indeks pierwszej komendy */
+    size_t count;                        /**< liczba komend w kolejce */
+    bool closed;                         /**< czy wejście się skończyło */
+} session_queue;
+
+/**
+ * @brief Tablica haszująca gier wątku, z adresowaniem otwartym.
+ */
+typedef struct session_games {
+    uint32_t *ids;        /**< numery gier */
+    gamma_t **games;      /**< gry, NULL oznacza wolne miejsce */
+    uint32_t capacity;    /**< rozmiar tablic, potęga dwójki */
+    uint32_t count;       /**< liczba gier */
+} session_games;
+
+/**
+ * @brief Stan wątku obsługującego część gier.
+ */
+typedef struct session_worker {
+    pthread_t thread;                     /**< wątek */
+    session_queue queue;                  /**< komendy czekające na wątek */
+    session_games games;                  /**< gry wątku */
+    gamma_arena *arena;                   /**< arena gier wątku */
+    batch_session *io;                    /**< odpowiedzi wątku */
+    session_task pending[SESSION_BATCH];  /**< komendy zebrane przez wątek
+                                            *  czytający, jeszcze nie
+                                            *  przekazane do kolejki */
+    size_t pending_count;                 /**< liczba zebranych komend */
+} session_worker;
+
+/** @brief Wyznacza miejsce gry @p id w tablicy: miejsce z tą grą lub
+ * pierwsze wolne miejsce, od którego należy ją wstawić.
+ * @param[in] table   – wskaźnik na tablicę gier,
+ * @param[in] id      – numer gry.
+ * @return Indeks miejsca.
+ */
+
+static uint32_t FindSlot(const session_games *table, uint32_t id) {
+    uint32_t mask = table->capacity - 1;
+    uint32_t slot = (id * 2654435761u) & mask;
+    while(table->games[slot] != NULL && table->ids[slot] != id) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/** @brief Podaje grę o numerze @p id.
+ * @param[in] table   – wskaźnik na tablicę gier,
+ * @param[in] id      – numer gry.
+ * @return Wskaźnik na grę lub NULL, gdy nie ma takiej gry.
+ */
+
+static gamma_t *GetGame(const session_games *table, uint32_t id) {
+    return table->games[FindSlot(table, id)];
+}
+
+/** @brief Zmienia rozmiar tablicy gier, przenosząc do niej wszystkie gry.
+ * @param[in,out] table  – wskaźnik na tablicę gier,
+ * @param[in] capacity   – nowy rozmiar, potęga dwójki większa od liczby
+ *                         gier.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+
+static bool ResizeGames(session_games *table, uint32_t capacity) {
+    session_games resized = {
+        .ids = malloc(sizeof(uint32_t) * capacity),
+        .games = calloc(capacity, sizeof(gamma_t *)),
+        .capacity = capacity,
+        .count = table->count
+    };
+    if(resized.ids == NULL || resized.games == NULL) {
+        free(resized.ids);
+        free(resized.games);
+        return false;
+    }
+
+    for(uint32_t k = 0; k < table->capacity; k++) {
+        if(table->games[k] != NULL) {
+            uint32_t slot = FindSlot(&resized, table->ids[k]);
+            resized.ids[slot] = table->ids[k];
+            resized.games[slot] = table->games[k];
+        }
+    }
+    free(table->ids);
+    free(table->games);
+    *table = resized;
+    return true;
+}
+
+/** @brief Dodaje grę o numerze @p id, którego nie ma jeszcze w tablicy.
+ * @param[in,out] table  – wskaźnik na tablicę gier,
+ * @param[in] id         – numer gry,
+ * @param[in] g          – wskaźnik na grę.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+
+static bool AddGame(session_games *table, uint32_t id, gamma_t *g) {
+    // tablica jest zapełniona co najwyżej w połowie
+    if((uint64_t)(table->count + 1) * 2 > table->capacity
+       && (table->capacity > UINT32_MAX / 2
+           || !ResizeGames(table, table->capacity * 2))) {
+        return false;
+    }
+    uint32_t slot = FindSlot(table, id);
+    table->ids[slot] = id;
+    table->games[slot] = g;
+    table->count++;
+    return true;
+}
+
+/** @brief Usuwa z tablicy grę o numerze @p id, przesuwając wstecz gry,
+ * które w ciągu zajętych miejsc leżą za nią.
+ * @param[in,out] table  – wskaźnik na tablicę gier,
+ * @param[in] id         – numer gry.
+ * @return Wskaźnik na usuniętą grę lub NULL, gdy nie było takiej gry.
+ */
+
+static gamma_t *RemoveGame(session_games *table, uint32_t id) {
+    uint32_t mask = table->capacity - 1;
+    uint32_t hole = FindSlot(table, id);
+    gamma_t *removed = table->games[hole];
+    if(removed == NULL) {
+        return NULL;
+    }
+
+    table->games[hole] = NULL;
+    table->count--;
+    for(uint32_t slot = (hole + 1) & mask; table->games[slot] != NULL;
+        slot = (slot + 1) & mask) {
+        uint32_t home = (table->ids[slot] * 2654435761u) & mask;
+        // gra może zająć dziurę, jeśli jej miejsce docelowe nie leży
+        // cyklicznie w przedziale (hole, slot]
+        if(((slot - home) & mask) >= ((slot - hole) & mask)) {
+            table->ids[hole] = table->ids[slot];
+            table->games[hole] = table->games[slot];
+            table->games[slot] = NULL;
+            hole = slot;
+        }
+    }
+    return removed;
+}
+
+/** @brief Dopisuje odpowiedź "id tekst" do bufora.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi,
+ * @param[in] id          – numer gry,
+ * @param[in] text        – tekst odpowiedzi lub NULL, gdy odpowiedzią jest
+ *                          liczba @p x,
+ * @param[in] x           – liczba będąca odpowiedzią.
+ */
+
+static void Answer(batch_output *output, uint32_t id, const char *text,
+                   uint64_t x) {
+    char *place = Reserve(output, 2 * MAX_ANSWER);
+    int length = FormatNumber(id, place);
+    place[length++] = ' ';
+    if(text != NULL) {
+        memcpy(place + length, text, strlen(text));
+        length += strlen(text);
+    } else {
+        length += FormatNumber(x, place + length);
+    }
+    place[length] = '\n';
+    output->size += length + 1;
+}
+
+/** @brief Dopisuje do bufora linię "id" i planszę gry.
+ * @param[in,out] output  – wskaźnik na bufor odpowiedzi,
+ * @param[in] id          – numer gry,
+ * @param[in] g           – wskaźnik na grę.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć na planszę.
+ */
+
+static bool AnswerBoard(batch_output *output, uint32_t id, gamma_t *g) {
+    char *board = gamma_board(g);
+    if(board == NULL) {
+        return false;
+    }
+    char head[MAX_ANSWER];
+    int length = FormatNumber(id, head);
+    head[length++] = '\n';
+    AppendWhole(output, head, length, board, strlen(board));
+    free(board);
+    return true;
+}
+
+/** @brief Wykonuje komendę w wątku obsługującym jej grę.
+ * @param[in,out] worker  – wskaźnik na stan wątku,
+ * @param[in] task        – komenda.
+ */
+
+static void RunTask(session_worker *worker, const session_task *task) {
+    batch_output *output = &worker->io->output;
+    const uint32_t *numbers = task->numbers;
+    gamma_t *g = GetGame(&worker->games, task->id);
+    bool correct = task->name == 'B' ? g == NULL : g != NULL;
+
+    if(!correct || task->name == COMMAND_ERROR) {
+        correct = false;
+
+    } else if(task->name == 'B') {
+        g = gamma_new_in(worker->arena, numbers[0], numbers[1], numbers[2],
+                         numbers[3]);
+        if(g != NULL && AddGame(&worker->games, task->id, g)) {
+            Answer(output, task->id, "OK", 0);
+        } else {
+            gamma_delete(g);
+            correct = false;
+        }
+
+    } else if(task->name == 'D') {
+        // pamięć gry wraca do areny wątku
+        gamma_delete(RemoveGame(&worker->games, task->id));
+        Answer(output, task->id, "OK", 0);
+
+    } else if(task->name == 'm') {
+        Answer(output, task->id, NULL,
+               gamma_move(g,numbers[0],numbers[1],numbers[2]));
+
+    } else if(task->name == 'g') {
+        Answer(output, task->id, NULL,
+               gamma_golden_move(g,numbers[0],numbers[1],numbers[2]));
+
+    } else if(task->name == 'b') {
+        Answer(output, task->id, NULL, gamma_busy_fields(g,numbers[0]));
+
+    } else if(task->name == 'f') {
+        Answer(output, task->id, NULL, gamma_free_fields(g,numbers[0]));
+
+    } else if(task->name == 'q') {
+        Answer(output, task->id, NULL, gamma_golden_possible(g,numbers[0]));
+
+    } else {
+        correct = AnswerBoard(output, task->id, g);
+    }
+
+    if(!correct) {
+        ReportError(worker->io, task->line_number);
+    }
+}
+
+/** @brief Zabiera z kolejki czekające komendy, czekając na nie, gdy
+ * kolejka jest pusta.
+ * @param[in,out] queue  – wskaźnik na kolejkę,
+ * @param[out] tasks     – tablica na co najmniej @ref SESSION_BATCH komend,
+ * @param[out] drained   – czy w kolejce nie zostały żadne komendy.
+ * @return Liczba zabranych komend, 0 gdy wejście się skończyło.
+ */
+
+static size_t TakeTasks(session_queue *queue, session_task *tasks,
+                        bool *drained) {
+    pthread_mutex_lock(&queue->mutex);
+    while(queue->count == 0 && !queue->closed) {
+        pthread_cond_wait(&queue->not_empty, &queue->mutex);
+    }
+    size_t count = queue->count < SESSION_BATCH ? queue->count
+                                                : SESSION_BATCH;
+    for(size_t k = 0; k < count; k++) {
+        tasks[k] = queue->tasks[(queue->head + k) % SESSION_QUEUE];
+    }
+    queue->head = (queue->head + count) % SESSION_QUEUE;
+    queue->count -= count;
+    *drained = queue->count == 0;
+    pthread_cond_signal(&queue->not_full);
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+/** @brief Wstawia komendy do kolejki, czekając na miejsce, gdy jest pełna.
+ * @param[in,out] queue  – wskaźnik na kolejkę,
+ * @param[in] tasks      – komendy,
+ * @param[in] count      – liczba komend.
+ */
+
+static void PutTasks(session_queue *queue, const session_task *tasks,
+                     size_t count) {
+    pthread_mutex_lock(&queue->mutex);
+    size_t put = 0;
+    while(put < count) {
+        while(queue->count == SESSION_QUEUE) {
+            pthread_cond_wait(&queue->not_full, &queue->mutex);
+        }
+        while(put < count && queue->count < SESSION_QUEUE) {
+            queue->tasks[(queue->head + queue->count) % SESSION_QUEUE] =
+                    tasks[put++];
+            queue->count++;
+        }
+        pthread_cond_signal(&queue->not_empty);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+}
+
+/** @brief Obsługuje komendy wątku aż do końca wejścia, a potem usuwa
+ * jego gry.
+ * @param[in,out] argument – wskaźnik na stan wątku.
+ * @return NULL.
+ */
+
+static void *WorkerLoop(void *argument) {
+    session_worker *worker = argument;
+    session_task tasks[SESSION_BATCH];
+    bool drained;
+    size_t count;
+
+    while((count = TakeTasks(&worker->queue, tasks, &drained)) > 0) {
+        for(size_t k = 0; k < count; k++) {
+            RunTask(worker, &tasks[k]);
+        }
+        if(drained) {
+            Flush(&worker->io->output);
+            Flush(&worker->io->errors);
+        }
+    }
+
+    for(uint32_t k = 0; k < worker->games.capacity; k++) {
+        gamma_delete(worker->games.games[k]);
+    }
+    Flush(&worker->io->output);
+    Flush(&worker->io->errors);
+    return NULL;
+}
+
+/** @brief Przekazuje wątkowi zebrane dla niego komendy.
+ * @param[in,out] worker  – wskaźnik na stan wątku.
+ */
+
+static void SendPending(session_worker *worker) {
+    if(worker->pending_count > 0) {
+        PutTasks(&worker->queue, worker->pending, worker->pending_count);
+        worker->pending_count = 0;
+    }
+}
+
+/** @brief Rozpoznaje komendę linii zaczynającej się numerem gry.
+ * @param[in] command – komenda podzielona na słowa, co najmniej jedno,
+ * @param[out] task   – komenda dla wątku, z nazwą @ref COMMAND_ERROR, gdy
+ *                      linia jest niepoprawna.
+ */
+
+static void ParseTask(const batch_command *command, session_task *task) {
+    task->name = COMMAND_ERROR;
+    if(command->count < 2 || command->lengths[1] != 1) {
+        return;
+    }
+
+    char name = command->words[1][0];
+    bool correct;
+    if(name == 'B') {
+        correct = GetNumbers(command, 2, 4, task->numbers);
+    } else if(name == 'm' || name == 'g') {
+        correct = GetNumbers(command, 2, 3, task->numbers);
+    } else if(name == 'b' || name == 'f' || name == 'q') {
+        correct = GetNumbers(command, 2, 1, task->numbers);
+    } else {
+        correct = (name == 'D' || name == 'p') && command->count == 2;
+    }
+    if(correct) {
+        task->name = name;
+    }
+}
+
+/** @brief Tworzy stan wątku i uruchamia wątek.
+ * @param[in,out] worker  – wskaźnik na niezainicjowany stan wątku.
+ * @param[in] same_file   – czy stdout i stderr to ten sam plik,
+ * @param[in] lock        – blokada wypisywania wspólna dla wątków.
+ * @return Wartość @p true, jeśli wątek został uruchomiony.
+ */
+
+static bool StartWorker(session_worker *worker, bool same_file,
+                        pthread_mutex_t *lock) {
+    worker->pending_count = 0;
+    worker->queue.head = 0;
+    worker->queue.count = 0;
+    worker->queue.closed = false;
+    worker->games.capacity = SESSION_GAMES;
+    worker->games.count = 0;
+    worker->games.ids = malloc(sizeof(uint32_t) * SESSION_GAMES);
+    worker->games.games = calloc(SESSION_GAMES, sizeof(gamma_t *));
+    worker->arena = gamma_arena_new();
+    worker->io = NewSession(0);
+
+    if(worker->games.ids != NULL && worker->games.games != NULL
+       && worker->arena != NULL && worker->io != NULL) {
+        worker->io->same_file = same_file;
+        worker->io->output.lock = lock;
+        worker->io->errors.lock = lock;
+        pthread_mutex_init(&worker->queue.mutex, NULL);
+        pthread_cond_init(&worker->queue.not_empty, NULL);
+        pthread_cond_init(&worker->queue.not_full, NULL);
+        if(pthread_create(&worker->thread, NULL, WorkerLoop, worker) == 0) {
+            return true;
+        }
+        pthread_mutex_destroy(&worker->queue.mutex);
+        pthread_cond_destroy(&worker->queue.not_empty);
+        pthread_cond_destroy(&worker->queue.not_full);
+    }
+
+    free(worker->games.ids);
+    free(worker->games.games);
+    gamma_arena_delete(worker->arena);
+    free(worker->io);
+    return false;
+}
+
+/** @brief Kończy wejście wątku, czeka na obsłużenie jego komend i zwalnia
+ * jego stan.
+ * @param[in,out] worker  – wskaźnik na stan uruchomionego wątku.
+ */
+
+static void StopWorker(session_worker *worker) {
+    SendPending(worker);
+    pthread_mutex_lock(&worker->queue.mutex);
+    worker->queue.closed = true;
+    pthread_cond_signal(&worker->queue.not_empty);
+    pthread_mutex_unlock(&worker->queue.mutex);
+    pthread_join(worker->thread, NULL);
+
+    pthread_mutex_destroy(&worker->queue.mutex);
+    pthread_cond_destroy(&worker->queue.not_empty);
+    pthread_cond_destroy(&worker->queue.not_full);
+    free(worker->games.ids);
+    free(worker->games.games);
+    gamma_arena_delete(worker->arena);
+    EndSession(worker->io);
+}
+
+bool SessionMode(int line_number, uint32_t workers) {
+    static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    session_worker *worker = malloc(sizeof(session_worker) * workers);
+    batch_session *session = NewSession(0);
+    if(worker == NULL || session == NULL) {
+        free(worker);
+        free(session);
+        return false;
+    }
+    InitCharClasses();
+    session->output.lock = &lock;
+    session->errors.lock = &lock;
+
+    uint32_t started = 0;
+    while(started < workers
+          && StartWorker(&worker[started], session->same_file, &lock)) {
+        started++;
+    }
+    if(started == 0) {
+        free(worker);
+        free(session);
+        return false;
+    }
+
+    char *place = Reserve(&session->output, MAX_ANSWER);
+    memcpy(place, "OK ", 3);
+    int length = 3 + FormatNumber(line_number, place + 3);
+    place[length] = '\n';
+    session->output.size += length + 1;
+    Flush(&session->output);
+    line_number++;
+
+    batch_command command;
+    enum line_kind kind;
+    while(true) {
+        if(session->input.position == session->input.size) {
+            // przed czekaniem na wejście wątki muszą dostać wszystkie
+            // komendy, na które klient czeka z odpowiedzią
+            for(uint32_t k = 0; k < started; k++) {
+                SendPending(&worker[k]);
+            }
+            Flush(&session->errors);
+        }
+        kind = ReadLine(&session->input, &command, MAX_LINE);
+        if(kind == LINE_END) {
+            break;
+        }
+
+        session_task task;
+        task.line_number = line_number;
+        if(kind == LINE_COMMAND
+           && ParseNumber(command.words[0], command.lengths[0], &task.id)) {
+            ParseTask(&command, &task);
+            session_worker *owner = &worker[task.id % started];
+            owner->pending[owner->pending_count++] = task;
+            if(owner->pending_count == SESSION_BATCH) {
+                SendPending(owner);
+            }
+        } else if(kind != LINE_EMPTY) {
+            ReportError(session, line_number);
+        }
+        line_number++;
+    }
+
+    for(uint32_t k = 0; k < started; k++) {
+        StopWorker(&worker[k]);
+    }
+    free(worker);
+    EndSession(session);
+    return true;
+}
@@ -0,0 +1,41 @@
+/** @file
+ * Interfejs trybu wielu gier prowadzonych w jednym procesie.
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef GAMMA_SESSION_MODE_H
+#define GAMMA_SESSION_MODE_H
+
+/** @brief Największa liczba wątków obsługujących gry. */
+#define SESSION_MAX_WORKERS 64
+
+/** @brief Uruchamia tryb wielu gier.
+ * Każda linia wejścia zaczyna się numerem gry @p id, po którym następuje
+ * komenda:
+ * "id B w h p a" tworzy grę tak jak nagłówek "B" i odpowiada "id OK",
+ * "id D" usuwa grę i odpowiada "id OK",
+ * "id m p x y", "id g p x y", "id b p", "id f p" i "id q p" odpowiadają
+ * "id wynik" tak jak w trybie wsadowym,
+ * "id p" odpowiada linią "id", po której następuje plansza gry.
+ * Niepoprawne linie i komendy dla nieistniejących gier powodują wypisanie
+ * "ERROR numer linii" na stderr.
+ * Gry są rozdzielane między @p workers wątków według numeru gry, więc
+ * odpowiedzi dotyczące jednej gry wypisywane są w kolejności komend,
+ * a odpowiedzi dotyczące różnych gier mogą się przeplatać. Pamięć gier
+ * każdego wątku pochodzi z jego areny i jest używana ponownie po usunięciu
+ * gry. Odpowiedzi są wypisywane, gdy wątek obsłuży wszystkie czekające
+ * na niego komendy.
+ * @param[in] line_number - numer wiersza nagłówka, liczba dodatnia,
+ * @param[in] workers     - liczba wątków, liczba dodatnia niewiększa od
+ *                          @ref SESSION_MAX_WORKERS.
+ * @return Wartość @p false, gdy nie udało się uruchomić trybu (wtedy nic
+ * nie zostało wczytane ani wypisane), a @p true po zakończeniu wejścia.
+ */
+
+bool SessionMode(int line_number, uint32_t workers);
+
+#endif //GAMMA_SESSION_MODE_H
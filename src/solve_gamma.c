@@ -0,0 +1,506 @@
+/** @file
+ * Implementacja dokładnego rozwiązywania końcówek gry na małych planszach
+ *
+ * Pola gracza są zapisane w 64-bitowej masce (indeks pola y * width + x,
+ * tak jak w silniku), więc ruchy i obszary wyznaczane są operacjami na
+ * bitach. Przeszukiwanie to minimaks z odcięciami alfa-beta: gracz, którego
+ * wynik jest liczony, maksymalizuje liczbę swoich pól na koniec gry,
+ * a pozostali gracze ją minimalizują. Wyniki pozycji są zapamiętywane
+ * w tablicy transpozycji współdzielonej przez wątki bez blokad: wpis
+ * przechowuje dane i ich sumę XOR z kluczem, więc wpis zapisany naraz przez
+ * dwa wątki nie przejdzie sprawdzenia klucza. Wątki rozwiązują kolejne ruchy
+ * z korzenia, a z równie dobrych wybierany jest ruch o najmniejszym kodzie.
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "gamma.h"
+#include "gamma_structures.h"
+#include "arena_gamma.h"
+
+/** @brief Domyślna liczba bitów indeksu tablicy transpozycji. */
+#define SOLVE_TABLE_BITS 20
+
+/** @brief Największa liczba bitów indeksu tablicy transpozycji. */
+#define SOLVE_MAX_TABLE_BITS 30
+
+/** @brief Bit kodu ruchu oznaczający złoty ruch; niższe bity to indeks
+ * pola. */
+#define SOLVE_GOLDEN 64
+
+/** @brief Największa liczba ruchów w pozycji: każde pole zwykłym lub złotym
+ * ruchem. */
+#define SOLVE_MAX_MOVES (2 * GAMMA_SOLVE_MAX_FIELDS)
+
+/** @brief Co ile węzłów wątek dolicza swoje węzły do wspólnego licznika. */
+#define SOLVE_NODES_BATCH 4096
+
+/**
+ * @brief Rodzaje wyniku zapamiętanego w tablicy transpozycji.
+ */
+enum solve_bound {
+    BOUND_LOWER = 1,  /**< wynik jest co najmniej taki */
+    BOUND_UPPER = 2,  /**< wynik jest co najwyżej taki */
+    BOUND_EXACT = 3   /**< wynik dokładny */
+};
+
+/**
+ * @brief Pozycja: pola graczy, złote ruchy i gracz wykonujący ruch.
+ */
+typedef struct solve_state {
+    uint64_t owned[GAMMA_SOLVE_MAX_PLAYERS]; /**< pola graczy */
+    uint32_t gold;      /**< gracze, którzy mają złoty ruch, bit @p p dla
+                          *  gracza @p p + 1 */
+    uint32_t to_move;   /**< gracz wykonujący ruch, liczony od 0 */
+} solve_state;
+
+/**
+ * @brief Wpis tablicy transpozycji.
+ */
+typedef struct solve_entry {
+    atomic_uint_fast64_t check; /**< klucz XOR dane */
+    atomic_uint_fast64_t data;  /**< wynik, rodzaj wyniku i najlepszy
+                                  *  ruch */
+} solve_entry;
+
+/**
+ * @brief Wspólny stan rozwiązywania.
+ */
+typedef struct solver {
+    uint32_t width;             /**< szerokość planszy */
+    uint32_t height;            /**< wysokość planszy */
+    uint32_t players;           /**< liczba graczy */
+    uint32_t max_areas;         /**< maksymalna liczba obszarów */
+    uint32_t player;            /**< gracz, którego wynik jest liczony,
+                                  *  od 0 */
+    uint64_t board;             /**< pola planszy */
+    uint64_t not_left;          /**< pola poza pierwszą kolumną */
+    uint64_t not_right;         /**< pola poza ostatnią kolumną */
+    solve_entry *table;         /**< tablica transpozycji */
+    uint64_t table_mask;        /**< liczba wpisów tablicy minus 1 */
+    uint64_t max_nodes;         /**< limit węzłów, 0 bez limitu */
+    atomic_uint_fast64_t nodes; /**< liczba odwiedzonych węzłów */
+    atomic_bool aborted;        /**< czy przekroczono limit węzłów */
+    solve_state root;           /**< pozycja w korzeniu */
+    uint32_t root_mover;        /**< gracz wykonujący ruch w korzeniu */
+    uint8_t root_moves[SOLVE_MAX_MOVES]; /**< ruchy z korzenia */
+    uint32_t root_count;        /**< liczba ruchów z korzenia */
+    atomic_uint next_root;      /**< następny ruch z korzenia do
+                                  *  rozwiązania */
+    atomic_uint_fast64_t best;  /**< najlepszy wynik z korzenia
+                                  *  powiększony o 1, przesunięty o 8 bitów,
+                                  *  z kodem ruchu na niższych bitach */
+} solver;
+
+/**
+ * @brief Wątek rozwiązujący ruchy z korzenia.
+ */
+typedef struct solve_worker {
+    solver *s;          /**< wspólny stan */
+    uint64_t nodes;     /**< węzły niedoliczone do wspólnego licznika */
+    bool started;       /**< czy wątek został uruchomiony */
+    pthread_t thread;   /**< wątek */
+} solve_worker;
+
+/** @brief Podaje pola sąsiadujące z polami z maski.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in] fields  – maska pól.
+ * @return Maska sąsiadów, mogąca zawierać pola z @p fields.
+ */
+static inline uint64_t Around(const solver *s, uint64_t fields) {
+    uint64_t result = ((fields & s->not_right) << 1)
+                      | ((fields & s->not_left) >> 1);
+    if(s->height > 1) {
+        result |= (fields << s->width) | (fields >> s->width);
+    }
+    return result & s->board;
+}
+
+/** @brief Sprawdza, czy pola z maski tworzą co najwyżej @p most obszarów.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in] fields  – maska pól,
+ * @param[in] most    – największa dozwolona liczba obszarów.
+ * @return Wartość @p true, jeśli obszarów jest co najwyżej @p most.
+ */
+static bool AreasAtMost(const solver *s, uint64_t fields, uint32_t most) {
+    for(uint32_t areas = 0; fields != 0; areas++) {
+        if(areas == most) {
+            return false;
+        }
+        uint64_t area = fields & -fields;
+        uint64_t previous;
+        do {
+            previous = area;
+            area |= Around(s, area) & fields;
+        } while(area != previous);
+        fields &= ~area;
+    }
+    return true;
+}
+
+/** @brief Wyznacza ruchy gracza: najpierw zwykłe, potem złote.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in] state   – pozycja,
+ * @param[in] m       – gracz, od 0,
+ * @param[out] moves  – kody ruchów.
+ * @return Liczba ruchów.
+ */
+static uint32_t PlayerMoves(const solver *s, const solve_state *state,
+                            uint32_t m, uint8_t *moves) {
+    uint64_t busy = 0;
+    for(uint32_t p = 0; p < s->players; p++) {
+        busy |= state->owned[p];
+    }
+    uint64_t own = state->owned[m];
+    uint64_t free_fields = s->board & ~busy;
+    uint64_t regular = AreasAtMost(s, own, s->max_areas - 1)
+                       ? free_fields : Around(s, own) & free_fields;
+
+    uint32_t count = 0;
+    // najpierw pola przy własnych polach, które nie tworzą nowego obszaru
+    uint64_t near = regular & Around(s, own);
+    for(uint64_t rest = near; rest != 0; rest &= rest - 1) {
+        moves[count++] = __builtin_ctzll(rest);
+    }
+    for(uint64_t rest = regular & ~near; rest != 0; rest &= rest - 1) {
+        moves[count++] = __builtin_ctzll(rest);
+    }
+
+    if(state->gold & (1u << m)) {
+        for(uint64_t rest = busy & ~own; rest != 0; rest &= rest - 1) {
+            uint32_t field = __builtin_ctzll(rest);
+            uint64_t bit = (uint64_t)1 << field;
+            uint32_t victim = 0;
+            while(!(state->owned[victim] & bit)) {
+                victim++;
+            }
+            if(AreasAtMost(s, own | bit, s->max_areas)
+               && AreasAtMost(s, state->owned[victim] & ~bit, s->max_areas)) {
+                moves[count++] = field | SOLVE_GOLDEN;
+            }
+        }
+    }
+    return count;
+}
+
+/** @brief Wyznacza ruchy pierwszego gracza, zaczynając od gracza
+ * wykonującego ruch, który może wykonać jakikolwiek ruch.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in] state   – pozycja,
+ * @param[out] mover  – gracz wykonujący ruch, od 0,
+ * @param[out] moves  – kody ruchów.
+ * @return Liczba ruchów, 0 gdy gra się skończyła.
+ */
+static uint32_t Moves(const solver *s, const solve_state *state,
+                      uint32_t *mover, uint8_t *moves) {
+    for(uint32_t k = 0; k < s->players; k++) {
+        uint32_t m = (state->to_move + k) % s->players;
+        uint32_t count = PlayerMoves(s, state, m, moves);
+        if(count > 0) {
+            *mover = m;
+            return count;
+        }
+    }
+    return 0;
+}
+
+/** @brief Wykonuje ruch.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in,out] state – pozycja,
+ * @param[in] mover   – gracz wykonujący ruch, od 0,
+ * @param[in] move    – kod ruchu.
+ */
+static void Play(const solver *s, solve_state *state, uint32_t mover,
+                 uint8_t move) {
+    uint64_t bit = (uint64_t)1 << (move & ~SOLVE_GOLDEN);
+    if(move & SOLVE_GOLDEN) {
+        for(uint32_t p = 0; p < s->players; p++) {
+            state->owned[p] &= ~bit;
+        }
+        state->gold &= ~(1u << mover);
+    }
+    state->owned[mover] |= bit;
+    state->to_move = (mover + 1) % s->players;
+}
+
+/** @brief Miesza bity liczby (krok generatora splitmix64).
+ * @param[in] z       – liczba.
+ * @return Wymieszana liczba.
+ */
+static inline uint64_t Mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+/** @brief Wyznacza klucz pozycji.
+ * @param[in] s       – stan rozwiązywania,
+ * @param[in] state   – pozycja,
+ * @param[in] seed    – ziarno, różne dla różnych kluczy tej samej pozycji.
+ * @return Klucz.
+ */
+static uint64_t Key(const solver *s, const solve_state *state,
+                    uint64_t seed) {
+    uint64_t key = Mix(seed ^ state->gold ^ (uint64_t)state->to_move << 32);
+    for(uint32_t p = 0; p < s->players; p++) {
+        key = Mix(key + 0x9E3779B97F4A7C15ULL + state->owned[p]);
+    }
+    return key;
+}
+
+/** @brief Wynik pozycji dla liczonego gracza przy optymalnej grze,
+ * liczony z odcięciami alfa-beta.
+ * @param[in,out] s   – stan rozwiązywania,
+ * @param[in,out] w   – wątek,
+ * @param[in] state   – pozycja,
+ * @param[in] alpha   – wynik, który liczony gracz może już sobie zapewnić,
+ * @param[in] beta    – wynik, powyżej którego przeciwnicy nie dopuszczą.
+ * @return Dokładny wynik, gdy leży w (@p alpha, @p beta), a w przeciwnym
+ * przypadku ograniczenie wyniku z tej samej strony przedziału. Wartość
+ * nieokreślona, gdy przekroczono limit węzłów.
+ */
+static int Search(solver *s, solve_worker *w, const solve_state *state,
+                  int alpha, int beta) {
+    if(++w->nodes == SOLVE_NODES_BATCH) {
+        uint64_t nodes = atomic_fetch_add_explicit(&s->nodes, w->nodes,
+                                                   memory_order_relaxed);
+        w->nodes = 0;
+        if(s->max_nodes != 0 && nodes + SOLVE_NODES_BATCH > s->max_nodes) {
+            atomic_store(&s->aborted, true);
+        }
+    }
+    if(atomic_load_explicit(&s->aborted, memory_order_relaxed)) {
+        return 0;
+    }
+
+    uint8_t moves[SOLVE_MAX_MOVES];
+    uint32_t mover;
+    uint32_t count = Moves(s, state, &mover, moves);
+    if(count == 0) {
+        return __builtin_popcountll(state->owned[s->player]);
+    }
+
+    solve_state normal = *state;
+    normal.to_move = mover;
+    uint64_t index = Key(s, &normal, 0) & s->table_mask;
+    uint64_t check = Key(s, &normal, 0xD1B54A32D192ED03ULL);
+    solve_entry *entry = &s->table[index];
+    uint64_t data = atomic_load_explicit(&entry->data, memory_order_relaxed);
+    if((atomic_load_explicit(&entry->check, memory_order_relaxed) ^ data)
+       == check && data != 0) {
+        int value = data & 0x7F;
+        int bound = (data >> 7) & 3;
+        if(bound == BOUND_EXACT
+           || (bound == BOUND_LOWER && value >= beta)
+           || (bound == BOUND_UPPER && value <= alpha)) {
+            return value;
+        }
+        if(bound == BOUND_LOWER && value > alpha) {
+            alpha = value;
+        } else if(bound == BOUND_UPPER && value < beta) {
+            beta = value;
+        }
+        if(alpha >= beta) {
+            return value;
+        }
+        // najlepszy ruch z poprzedniego przeszukania sprawdzamy najpierw
+        uint8_t hint = (data >> 9) & 0xFF;
+        for(uint32_t k = 1; hint != 0 && k < count; k++) {
+            if(moves[k] == hint - 1) {
+                moves[k] = moves[0];
+                moves[0] = hint - 1;
+                break;
+            }
+        }
+    }
+
+    bool maximize = mover == s->player;
+    int best = maximize ? -1 : GAMMA_SOLVE_MAX_FIELDS + 1;
+    uint8_t best_move = moves[0];
+    int low = alpha, high = beta;
+    for(uint32_t k = 0; k < count && low < high; k++) {
+        solve_state child = *state;
+        Play(s, &child, mover, moves[k]);
+        int value = Search(s, w, &child, low, high);
+        if(maximize ? value > best : value < best) {
+            best = value;
+            best_move = moves[k];
+        }
+        if(maximize && best > low) {
+            low = best;
+        } else if(!maximize && best < high) {
+            high = best;
+        }
+    }
+    if(atomic_load_explicit(&s->aborted, memory_order_relaxed)) {
+        return 0;
+    }
+
+    int bound = best <= alpha ? BOUND_UPPER
+                : best >= beta ? BOUND_LOWER : BOUND_EXACT;
+    data = (uint64_t)best | (uint64_t)bound << 7
+           | (uint64_t)(best_move + 1) << 9;
+    atomic_store_explicit(&entry->data, data, memory_order_relaxed);
+    atomic_store_explicit(&entry->check, check ^ data, memory_order_relaxed);
+    return best;
+}
+
+/** @brief Sprawdza, czy ruch z korzenia jest lepszy od dotąd najlepszego.
+ * Z ruchów o równym wyniku lepszy jest ten o mniejszym kodzie, więc
+ * wybrany ruch nie zależy od kolejności rozwiązywania ruchów przez wątki.
+ * @param[in] maximize – czy ruch w korzeniu wykonuje liczony gracz,
+ * @param[in] packed  – wynik i ruch zapisane jak w @ref solver::best,
+ * @param[in] best    – dotąd najlepszy wynik i ruch.
+ * @return Wartość @p true, jeśli @p packed jest lepszy od @p best.
+ */
+static inline bool BetterRoot(bool maximize, uint64_t packed, uint64_t best) {
+    if(packed >> 8 != best >> 8) {
+        return maximize ? packed >> 8 > best >> 8 : packed >> 8 < best >> 8;
+    }
+    return (packed & 0xFF) < (best & 0xFF);
+}
+
+/** @brief Rozwiązuje kolejne ruchy z korzenia, dopóki są jakieś
+ * nierozwiązane. Każdy ruch jest przeszukiwany z oknem ograniczonym
+ * najlepszym dotąd wynikiem, a gdy ma mniejszy kod od dotąd najlepszego
+ * ruchu, z oknem poszerzonym o ten wynik, aby remis był wynikiem dokładnym.
+ * @param[in,out] arg – wątek, @ref solve_worker.
+ * @return NULL.
+ */
+static void *SolveRoot(void *arg) {
+    solve_worker *w = arg;
+    solver *s = w->s;
+    bool maximize = s->root_mover == s->player;
+    uint32_t k;
+    while((k = atomic_fetch_add(&s->next_root, 1)) < s->root_count
+          && !atomic_load(&s->aborted)) {
+        solve_state child = s->root;
+        uint8_t move = s->root_moves[k];
+        Play(s, &child, s->root_mover, move);
+        uint64_t best = atomic_load(&s->best);
+        int bound = (int)(best >> 8) - 1;
+        if(move < (best & 0xFF)) {
+            bound += maximize ? -1 : 1;
+        }
+        int value = maximize
+                    ? Search(s, w, &child, bound, GAMMA_SOLVE_MAX_FIELDS + 1)
+                    : Search(s, w, &child, -1, bound);
+        // wynik spoza okna przegrywa z dotąd najlepszym, a najlepszy wynik
+        // może się tylko poprawiać
+        uint64_t packed = (uint64_t)(value + 1) << 8 | move;
+        while(!atomic_load(&s->aborted) && BetterRoot(maximize, packed, best)
+              && !atomic_compare_exchange_weak(&s->best, &best, packed)) {
+        }
+    }
+    atomic_fetch_add(&s->nodes, w->nodes);
+    return NULL;
+}
+
+bool gamma_solve(gamma_t *g, uint32_t player, uint32_t to_move,
+                 const gamma_solve_options *options,
+                 gamma_solve_result *result) {
+    if(g == NULL || options == NULL || result == NULL
+       || player == 0 || player > g->number_of_players
+       || to_move == 0 || to_move > g->number_of_players
+       || g->number_of_players > GAMMA_SOLVE_MAX_PLAYERS
+       || (uint64_t)g->width * g->height > GAMMA_SOLVE_MAX_FIELDS
+       || options->threads == 0 || options->threads > GAMMA_SOLVE_MAX_THREADS
+       || options->table_bits > SOLVE_MAX_TABLE_BITS) {
+        return false;
+    }
+
+    solver *s = GammaCalloc(g->arena, 1, sizeof(solver));
+    uint32_t bits = options->table_bits == 0 ? SOLVE_TABLE_BITS
+                                             : options->table_bits;
+    solve_worker *workers = GammaCalloc(g->arena, options->threads,
+                                        sizeof(solve_worker));
+    if(s != NULL) {
+        s->table = GammaCalloc(g->arena, (size_t)1 << bits,
+                               sizeof(solve_entry));
+    }
+    if(s == NULL || s->table == NULL || workers == NULL) {
+        if(s != NULL) {
+            GammaFree(g->arena, s->table);
+        }
+        GammaFree(g->arena, s);
+        GammaFree(g->arena, workers);
+        return false;
+    }
+
+    uint32_t fields = g->width * g->height;
+    s->width = g->width;
+    s->height = g->height;
+    s->players = g->number_of_players;
+    s->max_areas = g->max_areas;
+    s->player = player - 1;
+    s->board = fields == 64 ? UINT64_MAX : ((uint64_t)1 << fields) - 1;
+    for(uint32_t i = 0; i < fields; i++) {
+        uint64_t bit = (uint64_t)1 << i;
+        if(i % g->width != 0) {
+            s->not_left |= bit;
+        }
+        if(i % g->width != g->width - 1) {
+            s->not_right |= bit;
+        }
+        uint32_t owner = Owner(g, i);
+        if(owner != 0) {
+            s->root.owned[owner - 1] |= bit;
+        }
+    }
+    for(uint32_t p = 0; p < s->players; p++) {
+        if(g->players[p].gold_possible) {
+            s->root.gold |= 1u << p;
+        }
+    }
+    s->root.to_move = to_move - 1;
+    s->table_mask = ((uint64_t)1 << bits) - 1;
+    s->max_nodes = options->max_nodes;
+    s->root_count = Moves(s, &s->root, &s->root_mover, s->root_moves);
+    atomic_init(&s->best, s->root_mover == s->player
+                          ? 0 : (uint64_t)(GAMMA_SOLVE_MAX_FIELDS + 2) << 8);
+
+    result->has_move = s->root_count > 0;
+    if(s->root_count == 0) {
+        result->busy = __builtin_popcountll(s->root.owned[s->player]);
+    } else {
+        uint32_t threads = options->threads < s->root_count
+                           ? options->threads : s->root_count;
+        for(uint32_t k = 0; k < threads; k++) {
+            workers[k].s = s;
+        }
+        for(uint32_t k = 1; k < threads; k++) {
+            workers[k].started = pthread_create(&workers[k].thread, NULL,
+                                                SolveRoot, &workers[k]) == 0;
+        }
+        SolveRoot(&workers[0]);
+        for(uint32_t k = 1; k < threads; k++) {
+            if(workers[k].started) {
+                pthread_join(workers[k].thread, NULL);
+            } else {
+                SolveRoot(&workers[k]);
+            }
+        }
+
+        uint64_t best = atomic_load(&s->best);
+        uint8_t move = best & 0xFF;
+        result->busy = (best >> 8) - 1;
+        result->player = s->root_mover + 1;
+        result->x = (move & ~SOLVE_GOLDEN) % g->width;
+        result->y = (move & ~SOLVE_GOLDEN) / g->width;
+        result->golden = (move & SOLVE_GOLDEN) != 0;
+    }
+    result->nodes = atomic_load(&s->nodes) + 1;
+    result->solved = !atomic_load(&s->aborted);
+
+    GammaFree(g->arena, s->table);
+    GammaFree(g->arena, s);
+    GammaFree(g->arena, workers);
+    return true;
+}
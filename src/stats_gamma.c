@@ -0,0 +1,162 @@
+/** @file
+ * Implementacja liczników i histogramów pracy silnika gry gamma
+ *
+ * @author Daniel Ciołek
+ */
+
+#define _GNU_SOURCE
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "gamma.h"
+#include "stats_gamma.h"
+
+#ifdef GAMMA_STATS
+
+/** @brief Liczba przedziałów histogramu: przedział 0 to wartość 0,
+ * a przedział k > 0 to wartości z [2^(k-1), 2^k). */
+#define STATS_BUCKETS 65
+
+/**
+ * @brief Histogram wartości.
+ */
+typedef struct stats_values {
+    atomic_uint_fast64_t count;                  /**< liczba wartości */
+    atomic_uint_fast64_t sum;                    /**< suma wartości */
+    atomic_uint_fast64_t max;                    /**< największa wartość */
+    atomic_uint_fast64_t buckets[STATS_BUCKETS]; /**< liczby wartości
+                                                   *  w przedziałach */
+} stats_values;
+
+/** @brief Liczniki; zwiększane bez synchronizacji kolejności, bo czytane
+ * są tylko przy wypisywaniu. */
+static atomic_uint_fast64_t counters[STATS_COUNTERS];
+
+/** @brief Histogramy. */
+static stats_values histograms[STATS_HISTOGRAMS];
+
+/** @brief Nazwy liczników w opisie. */
+static const char *counter_names[STATS_COUNTERS] = {
+    "union_calls", "flood_cells", "golden_sweeps", "golden_rows"
+};
+
+/** @brief Nazwy histogramów w opisie. */
+static const char *histogram_names[STATS_HISTOGRAMS] = {
+    "root_hops", "golden_flood_cells", "gamma_new_ns", "gamma_move_ns",
+    "gamma_golden_move_ns", "gamma_busy_fields_ns", "gamma_free_fields_ns",
+    "gamma_golden_possible_ns", "gamma_board_ns"
+};
+
+void StatsAdd(stats_counter counter, uint64_t value) {
+    atomic_fetch_add_explicit(&counters[counter], value,
+                              memory_order_relaxed);
+}
+
+void StatsRecord(stats_histogram histogram, uint64_t value) {
+    stats_values *h = &histograms[histogram];
+    int bucket = value == 0 ? 0 : 64 - __builtin_clzll(value);
+    atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->sum, value, memory_order_relaxed);
+    atomic_fetch_add_explicit(&h->buckets[bucket], 1, memory_order_relaxed);
+
+    uint_fast64_t max = atomic_load_explicit(&h->max, memory_order_relaxed);
+    while(value > max
+          && !atomic_compare_exchange_weak_explicit(&h->max, &max, value,
+                                                    memory_order_relaxed,
+                                                    memory_order_relaxed)) {
+    }
+}
+
+uint64_t StatsNow(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+void StatsStop(const stats_timer *timer) {
+    StatsRecord(timer->histogram, StatsNow() - timer->start);
+}
+
+/** @brief Przekazuje sformatowaną linię opisu.
+ * @param[in] write   – funkcja odbierająca fragmenty,
+ * @param[in] context – wskaźnik przekazywany funkcji @p write,
+ * @param[in] format  – format linii jak w printf,
+ * @param[in] ...     – wartości do formatu.
+ * @return Wynik funkcji @p write.
+ */
+__attribute__((format(printf, 3, 4)))
+static bool WriteLine(gamma_board_writer write, void *context,
+                      const char *format, ...) {
+    char line[128];
+    va_list arguments;
+    va_start(arguments, format);
+    int length = vsnprintf(line, sizeof(line), format, arguments);
+    va_end(arguments);
+    if(length < 0) {
+        return false;
+    }
+    if((size_t)length >= sizeof(line)) {
+        length = sizeof(line) - 1;
+    }
+    return write(line, length, context);
+}
+
+bool gamma_stats_stream(gamma_board_writer write, void *context) {
+    if(write == NULL) {
+        return false;
+    }
+    for(int c = 0; c < STATS_COUNTERS; c++) {
+        if(!WriteLine(write, context, "%s %lu\n", counter_names[c],
+                      (uint64_t)atomic_load(&counters[c]))) {
+            return false;
+        }
+    }
+    for(int k = 0; k < STATS_HISTOGRAMS; k++) {
+        stats_values *h = &histograms[k];
+        uint64_t count = atomic_load(&h->count);
+        uint64_t sum = atomic_load(&h->sum);
+        if(!WriteLine(write, context, "%s count %lu mean %.1f max %lu\n",
+                      histogram_names[k], count,
+                      count > 0 ? (double)sum / count : 0.0,
+                      (uint64_t)atomic_load(&h->max))) {
+            return false;
+        }
+        for(int b = 0; b < STATS_BUCKETS; b++) {
+            uint64_t in_bucket = atomic_load(&h->buckets[b]);
+            uint64_t low = b == 0 ? 0 : (uint64_t)1 << (b - 1);
+            if(in_bucket > 0
+               && !WriteLine(write, context, "  >= %lu: %lu\n", low,
+                             in_bucket)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+#else
+
+bool gamma_stats_stream(gamma_board_writer write, void *context) {
+    (void)write;
+    (void)context;
+    return false;
+}
+
+#endif /* GAMMA_STATS */
+
+/** @brief Dopisuje fragment opisu do pliku.
+ * @param[in] chunk   – fragment,
+ * @param[in] length  – długość fragmentu,
+ * @param[in] context – plik.
+ * @return Wartość @p true, jeśli udało się zapisać cały fragment.
+ */
+static bool WriteChunk(const char *chunk, size_t length, void *context) {
+    return fwrite(chunk, 1, length, context) == length;
+}
+
+bool gamma_stats_write(FILE *file) {
+    return file != NULL && gamma_stats_stream(WriteChunk, file);
+}
@@ -0,0 +1,101 @@
+/** @file
+ * Interfejs liczników i histogramów pracy silnika gry gamma
+ *
+ * Liczniki są kompilowane tylko z makrem GAMMA_STATS (opcja CMake
+ * GAMMA_STATS). Bez niego makra z tego pliku nie generują żadnego kodu.
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef STATSGAMMA_H
+#define STATSGAMMA_H
+
+#include <stdint.h>
+
+/**
+ * @brief Liczniki zdarzeń w silniku.
+ */
+typedef enum stats_counter {
+    STATS_UNION_CALLS,      /**< wywołania @ref Union */
+    STATS_FLOOD_CELLS,      /**< pola odwiedzone przez @ref FloodArea */
+    STATS_GOLDEN_SWEEPS,    /**< przeglądania planszy przy szukaniu pola
+                              *  złotego ruchu */
+    STATS_GOLDEN_ROWS,      /**< wiersze przejrzane przy szukaniu pola
+                              *  złotego ruchu */
+    STATS_COUNTERS          /**< liczba liczników */
+} stats_counter;
+
+/**
+ * @brief Histogramy wartości o przedziałach rosnących wykładniczo.
+ */
+typedef enum stats_histogram {
+    STATS_ROOT_HOPS,            /**< przeskoki do dziadka w @ref Root,
+                                  *  około połowy długości ścieżki */
+    STATS_GOLDEN_FLOOD,         /**< pola odwiedzone przy rozbijaniu obszaru
+                                  *  przez złoty ruch */
+    STATS_API_NEW,              /**< czas @ref gamma_new w ns */
+    STATS_API_MOVE,             /**< czas @ref gamma_move w ns */
+    STATS_API_GOLDEN_MOVE,      /**< czas @ref gamma_golden_move w ns */
+    STATS_API_BUSY_FIELDS,      /**< czas @ref gamma_busy_fields w ns */
+    STATS_API_FREE_FIELDS,      /**< czas @ref gamma_free_fields w ns */
+    STATS_API_GOLDEN_POSSIBLE,  /**< czas @ref gamma_golden_possible w ns */
+    STATS_API_BOARD,            /**< czas @ref gamma_board
+                                  *  i @ref gamma_board_stream w ns */
+    STATS_HISTOGRAMS            /**< liczba histogramów */
+} stats_histogram;
+
+#ifdef GAMMA_STATS
+
+/** @brief Zwiększa licznik.
+ * @param[in] counter – licznik,
+ * @param[in] value   – o ile zwiększyć licznik.
+ */
+void StatsAdd(stats_counter counter, uint64_t value);
+
+/** @brief Dopisuje wartość do histogramu.
+ * @param[in] histogram – histogram,
+ * @param[in] value     – wartość.
+ */
+void StatsRecord(stats_histogram histogram, uint64_t value);
+
+/**
+ * @brief Pomiar czasu wywołania funkcji, zapisywany do histogramu przy
+ * wyjściu z bloku, w którym go zadeklarowano.
+ */
+typedef struct stats_timer {
+    stats_histogram histogram;  /**< histogram czasu */
+    uint64_t start;             /**< czas rozpoczęcia w ns */
+} stats_timer;
+
+/** @brief Podaje czas zegara monotonicznego.
+ * @return Czas w nanosekundach.
+ */
+uint64_t StatsNow(void);
+
+/** @brief Zapisuje czas od rozpoczęcia pomiaru do jego histogramu.
+ * @param[in] timer   – pomiar.
+ */
+void StatsStop(const stats_timer *timer);
+
+/** @brief Zwiększa licznik @p counter o @p value. */
+#define STATS_ADD(counter, value) StatsAdd(counter, value)
+/** @brief Dopisuje @p value do histogramu @p histogram. */
+#define STATS_RECORD(histogram, value) StatsRecord(histogram, value)
+/** @brief Mierzy czas od tego miejsca do wyjścia z bloku i zapisuje go do
+ * histogramu @p histogram. */
+#define STATS_TIME(histogram) \
+    stats_timer stats_timer_ __attribute__((cleanup(StatsStop))) = \
+        {histogram, StatsNow()}
+
+#else
+
+/** @brief Bez GAMMA_STATS nic nie robi. */
+#define STATS_ADD(counter, value) ((void)0)
+/** @brief Bez GAMMA_STATS nic nie robi. */
+#define STATS_RECORD(histogram, value) ((void)0)
+/** @brief Bez GAMMA_STATS nic nie robi. */
+#define STATS_TIME(histogram) ((void)0)
+
+#endif /* GAMMA_STATS */
+
+#endif /* STATSGAMMA_H */
@@ -0,0 +1,220 @@
+/** @file
+ * Implementacja planszy podzielonej na kafelki współdzielone przez kopie gry
+ *
+ * @author Daniel Ciołek
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "tiles_gamma.h"
+#include "gamma_structures.h"
+#include "arena_gamma.h"
+#include "pool_gamma.h"
+
+/** @brief Podaje liczbę pól w kafelku o numerze @p t.
+ * Tylko ostatni kafelek może być niepełny.
+ * @param[in] fields  – liczba pól planszy,
+ * @param[in] t       – numer kafelka.
+ * @return Liczba pól kafelka.
+ */
+static uint32_t TileSize(uint64_t fields, uint32_t t) {
+    uint64_t rest = fields - ((uint64_t)t << TILE_BITS);
+    return rest < TILE_FIELDS ? rest : TILE_FIELDS;
+}
+
+/** @brief Alokuje kafelek używany przez jedną grę.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry.
+ * @return Wskaźnik na kafelek lub NULL, gdy nie udało się zaalokować pamięci.
+ */
+static board_tile *NewTile(const gamma_t *g) {
+    board_tile *tile = GammaAlloc(g->arena, TileBytes(g));
+    if(tile != NULL) {
+        atomic_init(&tile->references, 1);
+    }
+    return tile;
+}
+
+/** @brief Zwalnia jedno użycie kafelka, a gdy było ostatnie, jego pamięć.
+ * Kafelki leżące w odwzorowanym pliku lub w miejscu gry w puli zwalniane są
+ * razem z całym obszarem.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] t       – numer kafelka.
+ */
+static void ReleaseTile(const gamma_t *g, uint32_t t) {
+    if(atomic_fetch_sub_explicit(TileReferences(g, t), 1,
+                                 memory_order_acq_rel) != 1) {
+        return;
+    }
+    if(!InMapping(g, g->tiles[t])) {
+        GammaFree(g->arena, g->tiles[t]);
+    }
+}
+
+/** @brief Przywraca kafelek do stanu pustej planszy używanej przez jedną
+ * grę.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[out] tile   – wskiaźnik na kafelek,
+ * @param[in] first   – indeks pierwszego pola kafelka,
+ * @param[in] size    – liczba pól kafelka.
+ */
+static void ClearTile(const gamma_t *g, board_tile *tile, uint32_t first,
+                      uint32_t size) {
+    atomic_init(&tile->references, 1);
+    // zerujemy cały kafelek razem z wyrównaniem i nieużywanymi pozycjami,
+    // bo kafelki są zapisywane do plików
+    memset(tile->owners, 0, TileBytes(g) - offsetof(board_tile, owners));
+    board_element *elements =
+            (board_element *)((char *)tile + g->elements_offset);
+    for(uint32_t k = 0; k < size; k++) {
+        elements[k].parent = first + k;
+    }
+}
+
+void BoardShape(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t players = g->number_of_players;
+
+    g->owner_bytes = players <= UINT8_MAX ? 1 : players <= UINT16_MAX ? 2 : 4;
+    g->tile_capacity = fields < TILE_FIELDS ? fields : TILE_FIELDS;
+    size_t end = offsetof(board_tile, owners)
+                 + (size_t)g->owner_bytes * g->tile_capacity;
+    g->elements_offset = (end + _Alignof(board_element) - 1)
+                         / _Alignof(board_element) * _Alignof(board_element);
+}
+
+bool NewBoard(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t count = (fields + TILE_FIELDS - 1) >> TILE_BITS;
+
+    BoardShape(g);
+
+    g->tiles = GammaAlloc(g->arena, sizeof(board_tile *) * count);
+    g->tiles_count = 0;
+    g->shared_tiles = false;
+    g->mapping = NULL;
+    if(g->tiles == NULL) {
+        return false;
+    }
+
+    for(uint32_t t = 0; t < count; t++) {
+        board_tile *tile = NewTile(g);
+        if(tile == NULL) {
+            FreeBoard(g);
+            return false;
+        }
+        ClearTile(g, tile, t << TILE_BITS, TileSize(fields, t));
+        g->tiles[g->tiles_count++] = tile;
+    }
+    return true;
+}
+
+bool MapBoard(gamma_t *g, void *address, size_t length, size_t offset) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t count = (fields + TILE_FIELDS - 1) >> TILE_BITS;
+
+    BoardShape(g);
+    g->tiles = GammaAlloc(g->arena, sizeof(board_tile *) * count);
+    g->mapping = GammaAlloc(g->arena, sizeof(board_mapping));
+    atomic_uint_least32_t *references =
+            GammaAlloc(g->arena, sizeof(atomic_uint_least32_t) * count);
+    if(g->tiles == NULL || g->mapping == NULL || references == NULL) {
+        GammaFree(g->arena, g->tiles);
+        GammaFree(g->arena, g->mapping);
+        GammaFree(g->arena, references);
+        g->tiles = NULL;
+        g->mapping = NULL;
+        return false;
+    }
+
+    atomic_init(&g->mapping->references, 1);
+    g->mapping->address = address;
+    g->mapping->length = length;
+    g->mapping->pool = NULL;
+    g->mapping->tile_references = references;
+    // liczniki z nagłówków kafelków w pliku nie są czytane
+    for(uint32_t t = 0; t < count; t++) {
+        g->tiles[t] = (board_tile *)((char *)address + offset
+                                     + (size_t)t * TileBytes(g));
+        atomic_init(&references[t], 1);
+    }
+    g->tiles_count = count;
+    g->shared_tiles = false;
+    return true;
+}
+
+void PlaceBoard(gamma_t *g, board_tile **tiles, void *first) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    uint32_t count = (fields + TILE_FIELDS - 1) >> TILE_BITS;
+
+    BoardShape(g);
+    for(uint32_t t = 0; t < count; t++) {
+        tiles[t] = (board_tile *)((char *)first + (size_t)t * TileBytes(g));
+        ClearTile(g, tiles[t], t << TILE_BITS, TileSize(fields, t));
+    }
+    g->tiles = tiles;
+    g->tiles_count = count;
+    g->shared_tiles = false;
+}
+
+void FreeBoard(gamma_t *g) {
+    if(g->tiles != NULL) {
+        for(uint32_t t = 0; t < g->tiles_count; t++) {
+            ReleaseTile(g,t);
+        }
+        if(!InMapping(g, g->tiles)) {
+            GammaFree(g->arena, g->tiles);
+        }
+    }
+    g->tiles = NULL;
+    g->tiles_count = 0;
+
+    // gra może leżeć w zwalnianym obszarze, więc nie zmieniamy jej potem
+    board_mapping *mapping = g->mapping;
+    g->mapping = NULL;
+    if(mapping != NULL
+       && atomic_fetch_sub_explicit(&mapping->references, 1,
+                                    memory_order_acq_rel) == 1) {
+        if(mapping->pool != NULL) {
+            ReturnSlot(mapping->pool, mapping->address);
+        } else {
+            munmap(mapping->address, mapping->length);
+            GammaFree(g->arena, mapping->tile_references);
+            GammaFree(g->arena, mapping);
+        }
+    }
+}
+
+bool ShareBoard(gamma_t *copy, gamma_t *g) {
+    copy->tiles = GammaAlloc(g->arena, sizeof(board_tile *) * g->tiles_count);
+    if(copy->tiles == NULL) {
+        return false;
+    }
+    for(uint32_t t = 0; t < g->tiles_count; t++) {
+        atomic_fetch_add_explicit(TileReferences(g, t), 1,
+                                  memory_order_relaxed);
+        copy->tiles[t] = g->tiles[t];
+    }
+    copy->tiles_count = g->tiles_count;
+    copy->shared_tiles = true;
+    copy->mapping = g->mapping;
+    if(g->mapping != NULL) {
+        atomic_fetch_add_explicit(&g->mapping->references, 1,
+                                  memory_order_relaxed);
+    }
+    g->shared_tiles = true;
+    return true;
+}
+
+bool UnshareTile(gamma_t *g, uint32_t t) {
+    board_tile *tile = NewTile(g);
+    if(tile == NULL) {
+        return false;
+    }
+    memcpy(tile->owners, g->tiles[t]->owners,
+           TileBytes(g) - offsetof(board_tile, owners));
+    ReleaseTile(g,t);
+    g->tiles[t] = tile;
+    return true;
+}
@@ -0,0 +1,213 @@
+/** @file
+ * Interfejs planszy podzielonej na kafelki współdzielone przez kopie gry
+ *
+ * @author Daniel Ciołek
+ */
+
+#ifndef TILESGAMMA_H
+#define TILESGAMMA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include "gamma_structures.h"
+
+/**
+ * @brief Struktura opisująca obszar pamięci, w którym leżą kafelki planszy:
+ * plik odwzorowany w pamięci przez @ref gamma_load lub miejsce gry w puli
+ * @ref gamma_pool. Kafelki z obszaru nie są zwalniane pojedynczo.
+ * Odwzorowanie jest usuwane, a miejsce wraca do puli, gdy nie używa go już
+ * żadna kopia gry.
+ */
+typedef struct board_mapping {
+    atomic_uint_least32_t references; /**< liczba gier używających obszaru */
+    void *address;                    /**< początek obszaru */
+    size_t length;                    /**< długość obszaru w bajtach */
+    struct gamma_pool *pool;          /**< pula, do której należy obszar,
+                                        *  NULL dla odwzorowanego pliku */
+    atomic_uint_least32_t *tile_references; /**< liczby gier używających
+                                        *  kolejnych kafelków odwzorowanego
+                                        *  pliku, trzymane poza plikiem, aby
+                                        *  wczytanie nie zmieniało jego stron;
+                                        *  NULL dla miejsca w puli */
+} board_mapping;
+
+/** @brief Wyznacza układ kafelków planszy gry @p g: szerokość numerów
+ * graczy w tablicy właścicieli, najmniejszą wystarczającą dla liczby graczy,
+ * liczbę pozycji w kafelku i położenie tablicy pól Union-Find.
+ * Wszystkie kafelki planszy mają ten sam układ.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ *                      z ustawionymi wymiarami planszy i liczbą graczy.
+ */
+void BoardShape(gamma_t *g);
+
+/** @brief Podaje liczbę bajtów zajmowanych przez kafelek planszy gry @p g,
+ * będącą też odległością między kafelkami zapisanymi jeden za drugim.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ *                      z układem wyznaczonym przez @ref BoardShape.
+ * @return Rozmiar kafelka w bajtach.
+ */
+static inline size_t TileBytes(const gamma_t *g) {
+    return g->elements_offset + sizeof(board_element) * g->tile_capacity;
+}
+
+/** @brief Alokuje i inicjalizuje pustą planszę.
+ * Każde pole jest osobnym obszarem Union-Find.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ *                      z ustawionymi wymiarami planszy i liczbą graczy.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool NewBoard(gamma_t *g);
+
+/** @brief Ustawia planszę gry na kafelki leżące jeden za drugim
+ * w odwzorowanym w pamięci pliku, bez kopiowania pól i bez zapisywania
+ * do odwzorowania. Po udanym wywołaniu odwzorowanie należy do gry.
+ * @param[in,out] g    – wskiaźnik na strukturę przechowującą stan gry,
+ *                       z ustawionymi wymiarami planszy i liczbą graczy,
+ * @param[in] address  – początek odwzorowania,
+ * @param[in] length   – długość odwzorowania w bajtach,
+ * @param[in] offset   – położenie pierwszego kafelka w odwzorowaniu.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool MapBoard(gamma_t *g, void *address, size_t length, size_t offset);
+
+/** @brief Podaje liczbę bajtów zajmowanych przez kafelki planszy gry @p g
+ * leżące jeden za drugim.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ *                      z układem wyznaczonym przez @ref BoardShape.
+ * @return Rozmiar kafelków w bajtach.
+ */
+static inline uint64_t BoardBytes(const gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
+    return ((fields + TILE_FIELDS - 1) >> TILE_BITS) * TileBytes(g);
+}
+
+/** @brief Ustawia planszę gry na kafelki leżące jeden za drugim od adresu
+ * @p first i przywraca je do stanu pustej planszy, bez alokowania pamięci.
+ * Obszar pamięci z kafelkami musi być opisany przez @p g->mapping.
+ * @param[in,out] g    – wskiaźnik na strukturę przechowującą stan gry,
+ *                       z ustawionymi wymiarami planszy i liczbą graczy,
+ * @param[out] tiles   – tablica na wskaźniki kafelków,
+ * @param[out] first   – miejsce na kafelki, o rozmiarze
+ *                       @ref BoardBytes, wyrównane tak jak kafelek.
+ */
+void PlaceBoard(gamma_t *g, board_tile **tiles, void *first);
+
+/** @brief Zwalnia kafelki planszy, których nie używa już żadna kopia gry.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ */
+void FreeBoard(gamma_t *g);
+
+/** @brief Ustawia planszę gry @p copy na planszę gry @p g bez kopiowania
+ * pól. Kafelki są kopiowane dopiero przy pierwszej zmianie.
+ * @param[in,out] copy – wskiaźnik na strukturę nowej gry,
+ * @param[in,out] g    – wskiaźnik na strukturę kopiowanej gry.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool ShareBoard(gamma_t *copy, gamma_t *g);
+
+/** @brief Zastępuje współdzielony kafelek o numerze @p t własną kopią gry.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] t       – numer kafelka.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+bool UnshareTile(gamma_t *g, uint32_t t);
+
+/** @brief Sprawdza czy @p address leży w obszarze @p g->mapping.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] address – sprawdzany adres.
+ * @return Wartość @p true, jeśli pamięć należy do obszaru.
+ */
+static inline bool InMapping(const gamma_t *g, const void *address) {
+    if(g->mapping == NULL) {
+        return false;
+    }
+    const char *begin = g->mapping->address;
+    return (const char *)address >= begin
+           && (const char *)address < begin + g->mapping->length;
+}
+
+/** @brief Podaje licznik gier używających kafelka o numerze @p t.
+ * Kafelki odwzorowanego pliku mają liczniki w tablicy
+ * @ref board_mapping::tile_references, pozostałe w nagłówku kafelka.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] t       – numer kafelka.
+ * @return Wskaźnik na licznik.
+ */
+static inline atomic_uint_least32_t *TileReferences(const gamma_t *g,
+                                                    uint32_t t) {
+    board_tile *tile = g->tiles[t];
+    if(g->mapping != NULL && g->mapping->tile_references != NULL
+       && InMapping(g, tile)) {
+        return &g->mapping->tile_references[t];
+    }
+    return &tile->references;
+}
+
+/** @brief Sprawdza czy pole o indeksie @p i leży w kafelku używanym też
+ * przez inną kopię gry.
+ * @param[in] g       – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * @return Wartość @p true, jeśli pola nie można zmienić bez kopiowania.
+ */
+static inline bool IsFieldShared(const gamma_t *g, uint32_t i) {
+    return g->shared_tiles
+           && atomic_load_explicit(TileReferences(g, i >> TILE_BITS),
+                                   memory_order_acquire) > 1;
+}
+
+/** @brief Zapewnia, że pole o indeksie @p i można zmienić.
+ * Zmiany, które muszą się udać w całości, przygotowują wszystkie pola
+ * przed pierwszym zapisem.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * @return Wartość @p true, jeśli udało się zaalokować pamięć.
+ */
+static inline bool UnshareField(gamma_t *g, uint32_t i) {
+    return !IsFieldShared(g, i) || UnshareTile(g, i >> TILE_BITS);
+}
+
+/** @brief Podaje pole Union-Find o indeksie @p i do zapisu.
+ * Pole powinno być wcześniej przygotowane przez @ref UnshareField.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola.
+ * @return Wskaźnik na pole lub NULL, gdy nie udało się skopiować kafelka.
+ */
+static inline board_element *WritableElement(gamma_t *g, uint32_t i) {
+    if(!UnshareField(g, i)) {
+        return NULL;
+    }
+    char *tile = (char *)g->tiles[i >> TILE_BITS];
+    return (board_element *)(tile + g->elements_offset)
+           + (i & (TILE_FIELDS - 1));
+}
+
+/** @brief Ustawia numer gracza zajmującego pole o indeksie @p i.
+ * Pole powinno być wcześniej przygotowane przez @ref UnshareField.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
+ * @param[in] i       – indeks pola,
+ * @param[in] player  – numer gracza niewiększy od liczby graczy lub 0 dla
+ *                      wolnego pola.
+ */
+static inline void SetOwner(gamma_t *g, uint32_t i, uint32_t player) {
+    if(!UnshareField(g, i)) {
+        return;
+    }
+    unsigned char *owners = g->tiles[i >> TILE_BITS]->owners;
+    uint32_t k = i & (TILE_FIELDS - 1);
+
+    switch(g->owner_bytes) {
+        case 1:
+            owners[k] = (uint8_t)player;
+            break;
+        case 2:
+            ((uint16_t *)owners)[k] = (uint16_t)player;
+            break;
+        default:
+            ((uint32_t *)owners)[k] = player;
+            break;
+    }
+}
+
+#endif /* TILESGAMMA_H */
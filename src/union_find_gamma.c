@@ -5,218 +5,190 @@
  */
 
 #include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
 #include "union_find_gamma.h"
+#include "journal_gamma.h"
+#include "tiles_gamma.h"
+#include "arena_gamma.h"
 #include "gamma_structures.h"
-
-void Root(gamma_t *g, uint32_t *x, uint32_t *y) {
-
-    if(g->board[*x][*y].parent_x != *x || g->board[*x][*y].parent_y != *y) {
-
-        uint32_t temp_x = g->board[*x][*y].parent_x;
-        uint32_t temp_y = g->board[*x][*y].parent_y;
-        Root(g,&temp_x,&temp_y);
-        g->board[*x][*y].parent_x = temp_x;
-        g->board[*x][*y].parent_y = temp_y;
-        *x = temp_x;
-        *y = temp_y;
-    } else {
-        *x = g->board[*x][*y].parent_x;
-        *y = g->board[*x][*y].parent_y;
-    }
+#include "stats_gamma.h"
+
+uint32_t Root(gamma_t *g, uint32_t i) {
+#ifdef GAMMA_STATS
+    uint64_t hops = 0;
+#endif
+
+    // ojcowie spoza planszy i cykle mogą pochodzić tylko z uszkodzonego
+    // wczytanego pliku; wtedy kończymy na ostatnim poprawnym polu
+    uint32_t fields = g->width * g->height;
+    for(uint32_t steps = 0; steps < fields; steps++) {
+        uint32_t parent = Element(g,i)->parent;
+        if(parent == i || parent >= fields) {
+            break;
+        }
+#ifdef GAMMA_STATS
+        hops++;
+#endif
+        uint32_t grandparent = Element(g,parent)->parent;
+        if(grandparent >= fields) {
+            i = parent;
+            break;
+        }
+        // połowienie ścieżki: każde odwiedzone pole przepinamy na swojego
+        // dziadka; skracanie ścieżki nie jest konieczne, więc nie kopiujemy
+        // dla niego współdzielonych kafelków
+        if(!IsFieldShared(g,i)) {
+            JournalField(g,i);
+            WritableElement(g,i)->parent = grandparent;
+        }
+        i = grandparent;
+    }
+#ifdef GAMMA_STATS
+    StatsRecord(STATS_ROOT_HOPS, hops);
+#endif
+    return i;
 }
 
-void Union(gamma_t *g, uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2) {
-
-    Root(g,&x1,&y1);
-    Root(g,&x2,&y2);
-    if(g->board[x1][y1].size < g->board[x2][y2].size) {
-        g->board[x1][y1].parent_x = x2;
-        g->board[x1][y1].parent_y = y2;
+void Union(gamma_t *g, uint32_t i, uint32_t j) {
+    STATS_ADD(STATS_UNION_CALLS, 1);
 
-    } else {
-        g->board[x2][y2].parent_x = x1;
-        g->board[x2][y2].parent_y = y1;
+    i = Root(g,i);
+    j = Root(g,j);
+    if(i == j) {
+        return;
     }
-    if(g->board[x1][y1].size == g->board[x2][y2].size) {
-        g->board[x1][y1].size++;
+    if(Element(g,i)->rank < Element(g,j)->rank) {
+        JournalField(g,i);
+        WritableElement(g,i)->parent = j;
+    } else if(Element(g,i)->rank > Element(g,j)->rank) {
+        JournalField(g,j);
+        WritableElement(g,j)->parent = i;
+    } else {
+        JournalField(g,j);
+        WritableElement(g,j)->parent = i;
+        JournalField(g,i);
+        WritableElement(g,i)->rank++;
     }
 
 }
 
 void UnionAdjacent(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    uint32_t i = x;
-    uint32_t j = y;
 
     if(!(x < g->width && y < g->height)) {
         return;
     }
 
-    if(i > 0 && i - 1 < g->width) {
-        if(g->board[i - 1][y].player_number == player) {
-            Union(g,x,y,i - 1,j);
-        }
+    uint32_t i = BoardIndex(g,x,y);
+
+    if(x > 0 && Owner(g,i - 1) == player) {
+        Union(g,i,i - 1);
     }
-    i ++;
-    if(i < g->width) {
-        if(g->board[i][j].player_number == player) {
-            Union(g,x,y,i,j);
-        }
+    if(x + 1 < g->width && Owner(g,i + 1) == player) {
+        Union(g,i,i + 1);
     }
-    i = x;
-    if(j > 0 && j - 1 < g->height) {
-        if(g->board[i][j - 1].player_number == player) {
-            Union(g,x,y,i,j - 1);
-        }
+    if(y > 0 && Owner(g,i - g->width) == player) {
+        Union(g,i,i - g->width);
     }
-    j ++;
-    if(j < g->height) {
-        if(g->board[i][j].player_number == player) {
-            Union(g,x,y,i,j);
-        }
+    if(y + 1 < g->height && Owner(g,i + g->width) == player) {
+        Union(g,i,i + g->width);
     }
 
 }
 
-void RemoveUnionOnAdjacent(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    if(!(x <g->width && y < g->height)) {
-        return;
-    }
-
-    uint32_t i = x;
-    uint32_t j = y;
-
-    if(g->board[x][y].visited == true || g->board[x][y].player_number != player) {
-        return;
-    }
-
-    g->board[x][y].parent_x = x;
-    g->board[x][y].parent_y = y;
-    g->board[x][y].visited = true;
-    g->board[x][y].size = 1;
+bool NewVisitGeneration(gamma_t *g) {
+    uint64_t fields = (uint64_t)g->width * g->height;
 
-    if(i > 0 && i - 1 < g->width) {
-        if(g->board[i - 1][j].player_number == player) {
-            RemoveUnionOnAdjacent(g,player,i - 1,j);
+    if(g->visited == NULL) {
+        g->visited = GammaCalloc(g->arena, fields, sizeof(uint32_t));
+        if(g->visited == NULL) {
+            return false;
         }
+        g->generation = 0;
     }
-    i++;
-    if(i < g->width) {
-        if(g->board[i][j].player_number == player) {
-            RemoveUnionOnAdjacent(g,player,i,j);
-        }
-    }
-    i = x;
-    if(j > 0 && j - 1 < g->height) {
-        if(g->board[i][j - 1].player_number == player) {
-            RemoveUnionOnAdjacent(g,player,i,j - 1);
-        }
-    }
-    j++;
-    if(j < g->height) {
-        if(g->board[i][j].player_number == player) {
-            RemoveUnionOnAdjacent(g,player,i,j);
+    if(g->queue == NULL) {
+        g->queue = GammaAlloc(g->arena, sizeof(uint32_t) * fields);
+        if(g->queue == NULL) {
+            return false;
         }
     }
 
+    g->generation++;
+    if(g->generation == 0) {
+        // licznik się przekręcił, stare znaczniki mogłyby się pokryć z nowymi
+        memset(g->visited, 0, sizeof(uint32_t) * fields);
+        g->generation = 1;
+    }
+    return true;
 }
 
-void UnionAllAdjacent(gamma_t *g, uint32_t player,
-                      uint32_t x, uint32_t y,uint32_t xp, uint32_t yp) {
+uint32_t FloodArea(gamma_t *g, uint32_t player, uint32_t start) {
+    uint32_t *queue = g->queue;
+    uint32_t head = 0;
+    uint32_t tail = 0;
 
-    if(!(x <g->width && y < g->height)) {
-        return;
-    }
-
-    if(g->board[x][y].player_number == player
-       && !(g->board[x][y].visited)) {
+    SetVisited(g,start);
+    queue[tail++] = start;
 
-        g->board[x][y].visited = true;
-        Union(g,x,y,xp,yp);
+    while(head < tail) {
+        uint32_t i = queue[head++];
+        uint32_t x = i % g->width;
 
-        if(x > 0) {
-            UnionAllAdjacent(g, player, x - 1, y, xp, yp);
+        if(x > 0 && Owner(g,i - 1) == player
+           && !IsVisited(g,i - 1)) {
+            SetVisited(g,i - 1);
+            queue[tail++] = i - 1;
         }
-        if(x < g->width) {
-            UnionAllAdjacent(g, player, x + 1, y, xp, yp);
+        if(x + 1 < g->width && Owner(g,i + 1) == player
+           && !IsVisited(g,i + 1)) {
+            SetVisited(g,i + 1);
+            queue[tail++] = i + 1;
         }
-        if(y > 0) {
-            UnionAllAdjacent(g, player, x, y - 1, xp, yp);
+        if(i >= g->width && Owner(g,i - g->width) == player
+           && !IsVisited(g,i - g->width)) {
+            SetVisited(g,i - g->width);
+            queue[tail++] = i - g->width;
         }
-        if(y < g->width) {
-            UnionAllAdjacent(g, player, x, y + 1, xp, yp);
+        if(i < g->width * (g->height - 1)
+           && Owner(g,i + g->width) == player
+           && !IsVisited(g,i + g->width)) {
+            SetVisited(g,i + g->width);
+            queue[tail++] = i + g->width;
         }
     }
+
+    STATS_ADD(STATS_FLOOD_CELLS, tail);
+    return tail;
 }
 
 int NumOfUniqueAreas(gamma_t *g, uint32_t player, uint32_t x, uint32_t y) {
-    uint32_t i = x;
-    uint32_t j = y;
-    long possible_areas[4][2];
-
-    for(int z = 0; z < 4; z++) {
-        for(int k = 0; k < 2; k++) {
-            possible_areas[z][k] = -1;
-        }
-    }
-
-    if(i > 0 && i - 1 < g->width) {
-        if(g->board[i - 1][j].player_number == player) {
-            uint32_t temp_x = i - 1;
-            uint32_t temp_y = j;
-            Root(g,&temp_x,&temp_y);
+    uint32_t i = BoardIndex(g,x,y);
+    uint32_t possible_areas[4];
+    int found = 0;
 
-            possible_areas[0][0] = (long)temp_x;
-            possible_areas[0][1] = (long)temp_y;
-        }
+    if(x > 0 && Owner(g,i - 1) == player) {
+        possible_areas[found++] = Root(g,i - 1);
     }
-    i++;
-    if(i < g->width) {
-        if(g->board[i][j].player_number == player) {
-            uint32_t temp_x = i;
-            uint32_t temp_y = j;
-            Root(g,&temp_x,&temp_y);
-
-            possible_areas[1][0] = (long)temp_x;
-            possible_areas[1][1] = (long)temp_y;
-        }
+    if(x + 1 < g->width && Owner(g,i + 1) == player) {
+        possible_areas[found++] = Root(g,i + 1);
     }
-    i = x;
-    if(j > 0 && j - 1 < g->height) {
-        if(g->board[i][j - 1].player_number == player) {
-            uint32_t temp_x = i;
-            uint32_t temp_y = j - 1;
-            Root(g,&temp_x,&temp_y);
-
-            possible_areas[2][0] = (long)temp_x;
-            possible_areas[2][1] = (long)temp_y;
-        }
+    if(y > 0 && Owner(g,i - g->width) == player) {
+        possible_areas[found++] = Root(g,i - g->width);
     }
-    j++;
-    if(j < g->height) {
-        if(g->board[i][j].player_number == player) {
-            uint32_t temp_x = i;
-            uint32_t temp_y = j;
-            Root(g,&temp_x,&temp_y);
-
-            possible_areas[3][0] = (long)temp_x;
-            possible_areas[3][1] = (long)temp_y;
-        }
+    if(y + 1 < g->height && Owner(g,i + g->width) == player) {
+        possible_areas[found++] = Root(g,i + g->width);
     }
 
     int res = 0;
 
-    for (int k = 0; k < 4; k++) {
-        int z = 0;
-        if(possible_areas[k][0] != -1) {
-            for (z = 0; z < k; z++) {
-                if (possible_areas[z][0] != -1
-                    && possible_areas[k][0] == possible_areas[z][0]
-                    && possible_areas[k][1] == possible_areas[z][1])
-                    break;
-            }
-            if (z == k)
-                res++;
+    for (int k = 0; k < found; k++) {
+        int z;
+        for (z = 0; z < k; z++) {
+            if (possible_areas[k] == possible_areas[z])
+                break;
         }
+        if (z == k)
+            res++;
     }
 
     return res;
@@ -11,29 +11,25 @@
 #include <stdint.h>
 #include "gamma_structures.h"
 
-/** @brief Znajduje ojca (@p x,@p y) i zapisuje jego współrzędne w @p x i @p y
+/** @brief Znajduje korzeń obszaru zawierającego pole o indeksie @p i.
+ * Działa iteracyjnie i po drodze skraca ścieżkę do korzenia
+ * (połowienie ścieżki).
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- * @param[in,out] x   – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in,out] y   – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+ * @param[in] i       – indeks pola, liczba nieujemna mniejsza od
+ *                      @p width * @p height z funkcji @ref gamma_new.
+ * @return Indeks korzenia obszaru zawierającego pole @p i.
  */
-void Root(gamma_t *g, uint32_t *x, uint32_t *y);
+uint32_t Root(gamma_t *g, uint32_t i);
 
-/** @brief Łączy obszar zawierający (@p x1,@p y1) z
- * obszarem zawierającym (@p x2,@p y2)
+/** @brief Łączy obszar zawierający pole o indeksie @p i z
+ * obszarem zawierającym pole o indeksie @p j.
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- *                      @p players z funkcji @ref gamma_new,
- * @param[in] x1       – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y1       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] x2      – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y2     – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+ * @param[in] i       – indeks pola, liczba nieujemna mniejsza od
+ *                      @p width * @p height z funkcji @ref gamma_new,
+ * @param[in] j       – indeks pola, liczba nieujemna mniejsza od
+ *                      @p width * @p height z funkcji @ref gamma_new.
  */
-void Union(gamma_t *g, uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2);
+void Union(gamma_t *g, uint32_t i, uint32_t j);
 
 /** @brief Łączy element (@p x,@p y) w obszar z elementami sąsiadującymi
  * za pomocą Union-Find.
@@ -48,37 +44,25 @@ void Union(gamma_t *g, uint32_t x1, uint32_t y1, uint32_t x2, uint32_t y2);
  */
 void UnionAdjacent(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
 
-/** @brief Rozbija obszar zawierający w sobie element (@p x,@p y) i należący do
- * gracza player na jednoelementowe obszary (czyli usuwa unie w Union-Find).
- * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza którego pola połączymy w obszar,
- *                      liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new,
- * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+/** @brief Rozpoczyna nowe przechodzenie obszarów.
+ * Przy pierwszym wywołaniu alokuje bufory @p g->visited i @p g->queue,
+ * po czym wszystkie pola planszy stają się nieodwiedzone.
+ * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry.
+ * @return Wartość @p false, gdy nie udało się zaalokować pamięci,
+ * a @p true w przeciwnym przypadku.
  */
-void RemoveUnionOnAdjacent(gamma_t *g, uint32_t player, uint32_t x, uint32_t y);
+bool NewVisitGeneration(gamma_t *g);
 
-/** @brief Łączy element (@p x,@p y) i elementy z nim sąsiadujące
- * w jeden obszar z obszarem który zawiera elementem (xp,yp)
- * przy pomocy Union-Find.
+/** @brief Przechodzi obszar gracza @p player zawierający pole @p start.
+ * Oznacza pola obszaru jako odwiedzone i zapisuje ich indeksy na początku
+ * bufora @p g->queue. Pola odwiedzone wcześniej w tym samym przechodzeniu
+ * (patrz @ref NewVisitGeneration) są pomijane.
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
- * @param[in] player  – numer gracza którego pola połączymy w obszar,
- *                      liczba dodatnia niewiększa od wartości
- *                      @p players z funkcji @ref gamma_new,
- * @param[in] x       – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] y       – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] xp      – numer kolumny, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
- * @param[in] yp      – numer wiersza, liczba nieujemna mniejsza od wartości
- *                      @p width z funkcji @ref gamma_new,
+ * @param[in] player  – numer gracza, do którego należy pole @p start,
+ * @param[in] start   – indeks nieodwiedzonego pola, od którego zaczynamy.
+ * @return Liczba pól zapisanych w @p g->queue.
  */
-void UnionAllAdjacent(gamma_t *g, uint32_t player,
-                      uint32_t x, uint32_t y,uint32_t xp, uint32_t yp);
+uint32_t FloodArea(gamma_t *g, uint32_t player, uint32_t start);
 
 /** @brief Oblicza ilośc unikalnych obszarów sąsiadujących z (@p x,@p y).
  * @param[in,out] g   – wskiaźnik na strukturę przechowującą stan gry,
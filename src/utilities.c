@@ -4,11 +4,15 @@
  * @author Daniel Ciołek
  */
 
+#define _GNU_SOURCE
+
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <unistd.h>
+#include <errno.h>
 
 int min(int a,int b) {
     if(a > b) {
@@ -48,21 +52,31 @@ bool isWhiteChar(int c) {
     return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\r';
 }
 
-void IntToString(int x, char *board, int num, int iter) {
-    char *temp = malloc(sizeof(char) * num + 1);
-    int k = 0;
-    while(x > 0) {
-        temp[k] = (char)((x - (x/10)*10) + '0');
-        x = x/10;
-        k++;
-    }
+/** @brief Zapisy dziesiętne liczb od 00 do 99. */
+static const char DIGIT_PAIRS[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "6869707172737475767778798081828384858687888990919293949596979899";
 
-    temp[k] = '\0';
+int FormatNumber(uint64_t x, char *out) {
+    char digits[20];
+    int k = sizeof(digits);
 
-    for(int l = 0; l < num; l++) {
-        board[iter + l] = temp[num - 1 - l];
+    while(x >= 100) {
+        k -= 2;
+        memcpy(digits + k, DIGIT_PAIRS + 2 * (x % 100), 2);
+        x /= 100;
     }
-    free(temp);
+    if(x >= 10) {
+        k -= 2;
+        memcpy(digits + k, DIGIT_PAIRS + 2 * x, 2);
+    } else {
+        digits[--k] = (char)('0' + x);
+    }
+
+    int length = sizeof(digits) - k;
+    memcpy(out, digits + k, length);
+    return length;
 }
 
 uint64_t NumberOfDigits(uint32_t x) {
@@ -75,11 +89,6 @@ uint64_t NumberOfDigits(uint32_t x) {
     return result;
 }
 
-/** @brief Sprawdza czy @p c jest numerem w kodzie ASCII.
- * @param[in] c - liczba całkowita.
- * @return true - c to liczba w kodzie ASCII.
- *         false - c nie jest liczbą w kodzie ASCII.
- */
 bool isNumber(int c) {
     if((int)c < (int)'0' || (int)c > '9') {
         return false;
@@ -88,12 +97,6 @@ bool isNumber(int c) {
     }
 }
 
-/** @brief Sprawdza czy @p c jest znakiem z zakresu od 'A' do 'z'
- *  w kodzie ASCII.
- * @param[in] c - liczba całkowita.
- * @return true - c jest znakiem z zakresu od 'A' do 'z' w kodzie ASCII.
- *         false - c nie jest znakiem z zakresu od 'A' do 'z' w kodzie ASCII.
- */
 bool isAcceptable(int c) {
     if((int)c >= (int)'A' && (int)c <= (int)'z') {
         return true;
@@ -102,17 +105,34 @@ bool isAcceptable(int c) {
     }
 }
 
+bool isPathChar(int c) {
+    return c == '.' || c == '/' || c == '-';
+}
+
+/** @brief Wczytuje jeden znak bezpośrednio z deskryptora stdin, bez
+ * buforowania przez stdio.
+ * @return Wczytany znak lub EOF, gdy wejście się skończyło.
+ */
+static int ReadChar(void) {
+    unsigned char c;
+    ssize_t size;
+    do {
+        size = read(STDIN_FILENO, &c, 1);
+    } while(size < 0 && errno == EINTR);
+    return size == 1 ? c : EOF;
+}
+
 bool getline2(char **newline) {
-    int c = getchar();
+    int c = ReadChar();
     if(c == (int)'\n') {
         (*newline)[0] = '\n';
         (*newline)[1] = '\0';
         return true;
     }
     if(c == (int)'#') {
-        c = getchar();
+        c = ReadChar();
         while(c != '\n' && c != EOF) {
-            c = getchar();
+            c = ReadChar();
         }
         (*newline)[0] = '#';
         (*newline)[1] = '\n';
@@ -128,7 +148,7 @@ bool getline2(char **newline) {
             if(numberOfWhite == 0) {
                 if (iter > 46) {
                     while(c != '\n' && c != EOF) {
-                        c = getchar();
+                        c = ReadChar();
                     }
                     (*newline)[0] = '\0';
                     return true;
@@ -137,13 +157,13 @@ bool getline2(char **newline) {
                 (*newline)[iter] = c;
                 iter++;
             }
-            c = getchar();
+            c = ReadChar();
         }
 
         if(isNumber(c) || isAcceptable(c)) {
             if(iter > 46) {
                 while(c != '\n' && c != EOF) {
-                    c = getchar();
+                    c = ReadChar();
                 }
                 (*newline)[0] = '\0';
                 return true;
@@ -155,7 +175,7 @@ bool getline2(char **newline) {
             if(c == '\n') {
                 if(iter > 46) {
                     while(c != '\n' && c != EOF) {
-                        c = getchar();
+                        c = ReadChar();
                     }
                     (*newline)[0] = '\0';
                     return true;
@@ -165,7 +185,7 @@ bool getline2(char **newline) {
                 break;
             } else {
                 while(c != '\n' && c != EOF) {
-                    c = getchar();
+                    c = ReadChar();
                 }
                 (*newline)[0] = '\0';
                 return true;
@@ -173,11 +193,11 @@ bool getline2(char **newline) {
 
         }
 
-        c = getchar();
+        c = ReadChar();
         if(c == '\n') {
             if(iter > 46) {
                 while(c != '\n' && c != EOF) {
-                    c = getchar();
+                    c = ReadChar();
                 }
                 (*newline)[0] = '\0';
                 return true;
@@ -198,4 +218,12 @@ bool getline2(char **newline) {
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+uint32_t Processors(uint32_t most) {
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    if(processors < 1) {
+        return 1;
+    }
+    return (unsigned long)processors < most ? (uint32_t)processors : most;
+}
@@ -17,6 +17,29 @@
  */
 bool isWhiteChar(char c);
 
+/** @brief Sprawdza czy @p c jest numerem w kodzie ASCII.
+ * @param[in] c - liczba całkowita.
+ * @return true - c to liczba w kodzie ASCII.
+ *         false - c nie jest liczbą w kodzie ASCII.
+ */
+bool isNumber(int c);
+
+/** @brief Sprawdza czy @p c jest znakiem z zakresu od 'A' do 'z'
+ *  w kodzie ASCII.
+ * @param[in] c - liczba całkowita.
+ * @return true - c jest znakiem z zakresu od 'A' do 'z' w kodzie ASCII.
+ *         false - c nie jest znakiem z zakresu od 'A' do 'z' w kodzie ASCII.
+ */
+bool isAcceptable(int c);
+
+/** @brief Sprawdza czy @p c jest jednym ze znaków '.', '/', '-', które
+ *  poza literami i cyframi mogą wystąpić w nazwie pliku.
+ * @param[in] c - liczba całkowita.
+ * @return true - c jest znakiem nazwy pliku.
+ *         false - c nie jest znakiem nazwy pliku.
+ */
+bool isPathChar(int c);
+
 /** @brief Kopiuje string @p s.
  * @param[in] s   – string.
  * @return nowy string o tej samej zawartości co @p s.
@@ -24,14 +47,13 @@ bool isWhiteChar(char c);
  */
 char* strcopy(char *s);
 
-/** @brief Wpisuje @p x do @p board cyfra po cyfrze.
- * @param[in] x         – szerokość planszy, liczba dodatnia,
- * @param[in,out] board – wysokość planszy, liczba dodatnia,
- * @param[in] num       – liczba cyfr @p x, liczba dodatnia,
- * @param[in] iter      – aktualny indeks od którego bedziemy
- *                        wpisywać @p x do @p board, liczba nieujemna
+/** @brief Wpisuje zapis dziesiętny liczby @p x do @p out, bez kończącego
+ * znaku '\0'. Cyfry wyznaczane są parami z tablicy.
+ * @param[in] x         – wpisywana liczba,
+ * @param[out] out      – bufor o rozmiarze co najmniej 20.
+ * @return Liczba wpisanych cyfr.
  */
-void IntToString(int x, char *board, int num, int iter);
+int FormatNumber(uint64_t x, char *out);
 
 /** @brief Liczy liczbe cyfr liczby.
  * @param[in] x   – liczba dodatnia,
@@ -42,6 +64,9 @@ int NumberOfDigits(uint32_t x);
 /** @brief Wczytuje dane do @p newline. Jeśli posiadają niedozwolone znaki
  * funkcja zapisuje pusty String do newline. Pamięć zarezerwowana na newline
  * powinna być większa lub równa 50. Jeśli wejśćie się skończy zwraca false.
+ * Znaki są czytane pojedynczo z deskryptora stdin z pominięciem stdio, więc
+ * dalszą część wejścia można czytać zarówno przez stdio, jak i bezpośrednio
+ * z deskryptora.
  *  @param[in,out] newline - String na którego jest zarezerwowane więcej lub
  *                          równo 50 bitów pamięci.
  *  @return true - Jeśli jest więcej wejścia do wczytania.
@@ -55,4 +80,10 @@ bool getline2(char **newline);
  * @return Minimum z liczb @p a i @p b.
  */
 int min(int a,int b);
+
+/** @brief Podaje liczbę procesorów, ale nie większą od @p most.
+ * @param[in] most  – największa zwracana liczba, liczba dodatnia.
+ * @return Liczba procesorów, liczba dodatnia.
+ */
+uint32_t Processors(uint32_t most);
 #endif //GAMMA_UTILITIES_H